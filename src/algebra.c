@@ -1,6 +1,7 @@
 #include <math.h>
 #include <stdio.h>
 #include "constants.h"
+#include "algebra.h"
 
 /**
  * Normalizes a 2D vector to have a unit length (magnitude of 1).
@@ -57,91 +58,126 @@ void normalize_angle(double* angle) {
     }
 }
 
+/**
+ * Prepares a ray for intersection_lines, computing its slopes once.
+ * 
+ * @param ray The prepared ray (output).
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param direction The unit direction of the ray.
+ */
+void ray_setup_init(struct ray_setup* ray, double x, double y, const double direction[2]) {
+    ray->x = x;
+    ray->y = y;
+    ray->dx = direction[0];
+    ray->dy = direction[1];
+    ray->x_per_y = direction[1] != 0 ? direction[0] / direction[1] : INFINITY;
+    ray->y_per_x = direction[0] != 0 ? direction[1] / direction[0] : INFINITY;
+}
+
 /**
  * Determines the intersection point of a ray with a line segment.
- * This function calculates where a ray, defined by an angle and starting point, intersects a line segment,
- * if at all, and checks if the intersection is within the bounds of the segment.
+ * This function calculates where a prepared ray intersects a line segment, if at all,
+ * and checks if the intersection is within the bounds of the segment.
+ * It keeps no state between calls, so any thread may call it.
  * 
- * @param angle The angle of the ray (in radians).
- * @param xi The starting x-coordinate of the ray.
- * @param yi The starting y-coordinate of the ray.
+ * @param ray The ray, prepared by ray_setup_init.
  * @param line An array representing the coordinates of the line segment (x1, y1, x2, y2).
  * @param intersection An array to store the coordinates of the intersection point (output).
  * @return 1 if the intersection is valid and within the bounds of the line segment, 0 otherwise.
  */
-int intersection_lines(double angle, double xi, double yi, double line[4], double intersection[2]) {
-    // a lot of variables are declared as static to avoid a lot of allocations,
-    // because this function is one of the most called functions in the application
-    static double ao;
-    static double co;
-    static double at;
-    static double bt;
-    static double ct;
-
-    ao = tan(angle); // Slope of the ray
-
-    static double bo = -1; // Y-intercept of the ray
-    co = yi - xi * ao;
-
-    at = line[1] - line[3]; // Slope of the line segment
-    bt = line[2] - line[0]; // X-component of the line segment direction
-    ct = line[3] * line[0] - line[1] * line[2]; // Y-intercept of the line segment
-    
-    // Check if the lines are parallel
-    if(ao * bt - at * bo == 0) return 0;
-
-    // check if the line is horizontal
-    if(at == 0) {
-        // Check if the horizontal line is parallel to the Y-axis (same height)
-        if (yi == line[1]) return 0; // The ray is parallel and does not intersect with the line
-
-        // Calculate the intersection
-        intersection[1] = line[1]; // The intersection occurs at the height of the line
-        intersection[0] = xi + (intersection[1] - yi) / ao; // Calculate the X coordinate of the intersection
+int intersection_lines(const struct ray_setup* ray, const double line[4], double intersection[2]) {
+    double ex = line[2] - line[0]; // Direction of the line segment
+    double ey = line[3] - line[1];
 
-        // Check if the intersection is within the bounds of the line
-        if (intersection[0] < fmin(line[0], line[2]) || intersection[0] > fmax(line[0], line[2]))
-            return 0; 
+    // Check if the lines are parallel (or the segment is a point)
+    double denominator = ray->dx * ey - ray->dy * ex;
+    if(denominator == 0) return 0;
 
-        // Check if the intersection is behind player's eyes
-        if((angle < 0 && line[1] > yi) || (angle > 0 && line[1] < yi)) 
+    // Check if the line is horizontal: the intersection lies exactly at its height
+    if(ey == 0) {
+        intersection[1] = line[1];
+        intersection[0] = ray->x + (line[1] - ray->y) * ray->x_per_y;
+
+        // Check if the intersection is within the bounds of the line
+        if(intersection[0] < fmin(line[0], line[2]) || intersection[0] > fmax(line[0], line[2]))
             return 0;
 
-        return 1;
+        // Check if the intersection is in front of the ray origin
+        return (line[1] - ray->y) * ray->dy > 0;
     }
 
-    // Calculate intersection point
-    intersection[0] = (bo * ct - bt * co) / (ao * bt - at * bo);
-    intersection[1] = (at * co - ao * ct) / (ao * bt - at * bo);
+    // Check if the line is vertical: the intersection lies exactly at its x-coordinate
+    if(ex == 0) {
+        intersection[0] = line[0];
+        intersection[1] = ray->y + (line[0] - ray->x) * ray->y_per_x;
 
-    // Check if the intersection point is within the line segment bounds
-    double maxy = line[1] > line[3] ? line[1] : line[3];
-    double miny = line[1] < line[3] ? line[1] : line[3];
-    double maxx = line[0] > line[2] ? line[0] : line[2];
-    double minx = line[0] < line[2] ? line[0] : line[2];
+        // Check if the intersection is within the bounds of the line
+        if(intersection[1] < fmin(line[1], line[3]) || intersection[1] > fmax(line[1], line[3]))
+            return 0;
 
-    if(intersection[1] > maxy || intersection[1] < miny || intersection[0] < minx || intersection[0] > maxx) {
-        return 0; // Intersection is outside the line segment
+        // Check if the intersection is in front of the ray origin
+        return (line[0] - ray->x) * ray->dx > 0;
     }
-    
-    // Determine if the intersection point is in front of the ray origin based on the angle
-    if(angle < 0) {
-        if(angle > -(PI / 2) && xi < intersection[0] && yi > intersection[1]) {
-            return 1; // Valid intersection
-        } else if(angle < -(PI / 2) && xi > intersection[0] && yi > intersection[1]) {
-            return 1; // Valid intersection
-        } else {
-            return 0; // Invalid intersection
-        }
-    } else {
-        if(angle < (PI / 2) && xi < intersection[0] && yi < intersection[1]) {
-            return 1; // Valid intersection
-        } else if(angle > (PI / 2) && xi > intersection[0] && yi < intersection[1]) {
-            return 1; // Valid intersection
-        } else {
-            return 0; // Invalid intersection
-        }
+
+    // Position of the intersection along the segment, from 0 at its start to 1 at its end
+    double wx = line[0] - ray->x, wy = line[1] - ray->y;
+    double u = (wx * ray->dy - wy * ray->dx) / denominator;
+    intersection[0] = line[0] + u * ex;
+    intersection[1] = line[1] + u * ey;
+
+    // Check if the intersection point is within the line segment bounds, along the segment's longer extent:
+    // the point is on the line, and rounding could push its other coordinate out of a nearly flat range
+    int axis = fabs(ex) >= fabs(ey) ? 0 : 1;
+    double low = fmin(line[axis], line[axis + 2]);
+    double high = fmax(line[axis], line[axis + 2]);
+    if(intersection[axis] < low || intersection[axis] > high) {
+        return 0; // Intersection is outside the line segment
     }
 
-    return 1; // Default return value (should not be reached)
+    // Check if the intersection point is in front of the ray origin. Comparing with the ray's
+    // direction rather than by quadrant keeps the rays along an axis, for which the
+    // intersection is level with the origin.
+    return (intersection[0] - ray->x) * ray->dx + (intersection[1] - ray->y) * ray->dy > 0;
+}
+
+/**
+ * Returns which side of the directed line from a to b a point lies on.
+ * 
+ * @param a The start of the line.
+ * @param b A second point of the line.
+ * @param p The point to classify.
+ * @return The cross product (b - a) x (p - a): positive on the left, negative on the right, 0 on the line.
+ */
+double side_of_line(struct point a, struct point b, struct point p) {
+    return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+/**
+ * Checks whether two line segments intersect, endpoints included.
+ * 
+ * @param a The first segment.
+ * @param b The second segment.
+ * @return 1 if the segments share at least one point, 0 otherwise.
+ */
+int segments_intersect(struct line a, struct line b) {
+    struct point a0 = { a.x0, a.y0 }, af = { a.xf, a.yf };
+    struct point b0 = { b.x0, b.y0 }, bf = { b.xf, b.yf };
+
+    double d1 = side_of_line(a0, af, b0);
+    double d2 = side_of_line(a0, af, bf);
+    double d3 = side_of_line(b0, bf, a0);
+    double d4 = side_of_line(b0, bf, af);
+
+    // Proper crossing: each segment's endpoints straddle the other segment
+    if(((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0)))
+        return 1;
+
+    // Touching or colinear: an endpoint lies on the other segment
+    if(d1 == 0 && fmin(a.x0, a.xf) <= b.x0 && b.x0 <= fmax(a.x0, a.xf) && fmin(a.y0, a.yf) <= b.y0 && b.y0 <= fmax(a.y0, a.yf)) return 1;
+    if(d2 == 0 && fmin(a.x0, a.xf) <= b.xf && b.xf <= fmax(a.x0, a.xf) && fmin(a.y0, a.yf) <= b.yf && b.yf <= fmax(a.y0, a.yf)) return 1;
+    if(d3 == 0 && fmin(b.x0, b.xf) <= a.x0 && a.x0 <= fmax(b.x0, b.xf) && fmin(b.y0, b.yf) <= a.y0 && a.y0 <= fmax(b.y0, b.yf)) return 1;
+    if(d4 == 0 && fmin(b.x0, b.xf) <= a.xf && a.xf <= fmax(b.x0, b.xf) && fmin(b.y0, b.yf) <= a.yf && a.yf <= fmax(b.y0, b.yf)) return 1;
+
+    return 0;
 }
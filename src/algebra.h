@@ -37,19 +37,36 @@ double abs_vector2(double vector[2]);
  */
 double distance_from_line(double plane_vector[2], double x, double y);
 
+// Ray prepared once for testing it against many walls: its origin, direction and slopes
+struct ray_setup {
+    double x, y;        // Origin of the ray
+    double dx, dy;      // Unit direction of the ray
+    double x_per_y;     // dx / dy: change in x per unit of y (infinite for a horizontal ray)
+    double y_per_x;     // dy / dx: change in y per unit of x (infinite for a vertical ray)
+};
+
+/**
+ * Prepares a ray for intersection_lines, computing its slopes once.
+ * 
+ * @param ray The prepared ray (output).
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param direction The unit direction of the ray.
+ */
+void ray_setup_init(struct ray_setup* ray, double x, double y, const double direction[2]);
+
 /**
  * Determines the intersection point of a ray with a line segment.
- * This function calculates where a ray, defined by an angle and starting point, intersects a line segment,
- * if at all, and checks if the intersection is within the bounds of the segment.
+ * This function calculates where a prepared ray intersects a line segment, if at all,
+ * and checks if the intersection is within the bounds of the segment.
+ * It keeps no state between calls, so any thread may call it.
  * 
- * @param angle The angle of the ray (in radians).
- * @param xi The starting x-coordinate of the ray.
- * @param yi The starting y-coordinate of the ray.
+ * @param ray The ray, prepared by ray_setup_init.
  * @param line An array representing the coordinates of the line segment (x1, y1, x2, y2).
  * @param intersection An array to store the coordinates of the intersection point (output).
  * @return 1 if the intersection is valid and within the bounds of the line segment, 0 otherwise.
  */
-int intersection_lines(double angle, double xi, double yi, double line[4], double intersection[2]);
+int intersection_lines(const struct ray_setup* ray, const double line[4], double intersection[2]);
 
 /**
  * Normalizes an angle to fall within the range [-PI, PI].
@@ -69,4 +86,23 @@ void normalize_angle(double* angle);
  */
 double project_vector2(double u[2], double v[2]);
 
+/**
+ * Returns which side of the directed line from a to b a point lies on.
+ * 
+ * @param a The start of the line.
+ * @param b A second point of the line.
+ * @param p The point to classify.
+ * @return The cross product (b - a) x (p - a): positive on the left, negative on the right, 0 on the line.
+ */
+double side_of_line(struct point a, struct point b, struct point p);
+
+/**
+ * Checks whether two line segments intersect, endpoints included.
+ * 
+ * @param a The first segment.
+ * @param b The second segment.
+ * @return 1 if the segments share at least one point, 0 otherwise.
+ */
+int segments_intersect(struct line a, struct line b);
+
 #endif
\ No newline at end of file
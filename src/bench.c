@@ -0,0 +1,572 @@
+// Microbenchmarks of the engine's batched kernels, run outside the game
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL2/SDL.h>
+
+#include "constants.h"
+#include "doors.h"
+#include "entity.h"
+#include "grid.h"
+#include "jobs.h"
+#include "levels.h"
+#include "los.h"
+#include "map.h"
+#include "pvs.h"
+#include "quantized.h"
+#include "raycast.h"
+#include "trig.h"
+#include "visibility.h"
+
+/**
+ * Returns the time elapsed since `start` in seconds.
+ *
+ * @param start A value of SDL_GetPerformanceCounter.
+ * @return double The elapsed time in seconds.
+ */
+static double seconds_since(Uint64 start) {
+    return (double) (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
+/**
+ * Times entity_update on `count` wandering entities, on the calling thread and on the pool,
+ * and measures how far their headings drift from the angles their turn speeds lead to.
+ *
+ * @param pool The worker pool.
+ * @param count The number of entities.
+ * @return int 0 if the benchmark ran, or 1 if an error occurred.
+ */
+static int bench_entities(struct job_pool* pool, int count) {
+    struct entity_store store;
+    double* angles = malloc(sizeof(double) * count); // Starting angle of each entity
+    if(angles == NULL) return 1;
+    if(entity_store_init(&store, count)) {
+        free(angles);
+        return 1;
+    }
+
+    srand(count);
+    for(int i = 0; i < count; i++) {
+        angles[i] = (double) rand() / RAND_MAX * 2 * PI;
+        int index = entity_spawn(&store, rand() % 1000, rand() % 1000, angles[i]);
+        store.turn[index] = ((double) rand() / RAND_MAX - 0.5) * PLAYER_ROTATION_SPEED;
+        store.moves[index] = rand() % 16;
+    }
+
+    // Enough updates to run for a noticeable time at every size
+    int updates = 100000000 / count;
+    double delta_time = 1.0 / SIM_TICK_RATE;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < updates; i++) entity_update(&store, NULL, delta_time);
+    double single = seconds_since(start);
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < updates; i++) entity_update(&store, pool, delta_time);
+    double parallel = seconds_since(start);
+
+    // Both runs turned every entity by turn * delta_time per update
+    double worst = 0;
+    for(int i = 0; i < count; i++) {
+        double expected = angles[i] + store.turn[i] * delta_time * 2 * updates;
+        // Distance between unit headings, the angle between them for small errors (no PI, which is rounded)
+        worst = fmax(worst, hypot(cos(expected) - store.heading_x[i], sin(expected) - store.heading_y[i]));
+    }
+
+    double total = (double) count * updates;
+    printf("%8d entities: %6.2f ns/entity single, %6.2f ns/entity on %d threads (%.1fx), heading error %.1e rad\n",
+        count, single * 1e9 / total, parallel * 1e9 / total, pool->thread_count + 1, single / parallel, worst);
+
+    free(angles);
+    entity_store_destroy(&store);
+    return 0;
+}
+
+/**
+ * Times batches of random line-of-sight queries across the map, on the calling thread
+ * and on the pool, and checks every answer against los_reference.
+ *
+ * @param pool The worker pool.
+ * @param count The number of queries per batch.
+ * @return int 0 if the benchmark ran, or 1 if an error occurred.
+ */
+static int bench_line_of_sight(struct job_pool* pool, int count) {
+    int wall_ids[MAP_MAX_LINES];
+    struct wall_grid grid;
+    double min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+
+    for(int i = 0; i < map_lines; i++) {
+        wall_ids[i] = i;
+        min_x = fmin(min_x, fmin(map[i][0], map[i][2]));
+        max_x = fmax(max_x, fmax(map[i][0], map[i][2]));
+        min_y = fmin(min_y, fmin(map[i][1], map[i][3]));
+        max_y = fmax(max_y, fmax(map[i][1], map[i][3]));
+    }
+    if(grid_build(&grid, wall_ids, map_lines, GRID_CELL_SIZE)) return 1;
+
+    struct los_query* queries = malloc(sizeof(struct los_query) * count);
+    unsigned int* visible = malloc(sizeof(unsigned int) * los_mask_words(count));
+    if(queries == NULL || visible == NULL) {
+        free(queries);
+        free(visible);
+        grid_destroy(&grid);
+        return 1;
+    }
+
+    srand(count);
+    for(int i = 0; i < count; i++) {
+        queries[i].from.x = min_x + (max_x - min_x) * rand() / RAND_MAX;
+        queries[i].from.y = min_y + (max_y - min_y) * rand() / RAND_MAX;
+        queries[i].to.x = min_x + (max_x - min_x) * rand() / RAND_MAX;
+        queries[i].to.y = min_y + (max_y - min_y) * rand() / RAND_MAX;
+    }
+
+    int batches = 20000000 / count;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < batches; i++) los_batch(&grid, NULL, queries, count, visible);
+    double single = seconds_since(start);
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < batches; i++) los_batch(&grid, pool, queries, count, visible);
+    double parallel = seconds_since(start);
+
+    int mismatches = 0, seen = 0;
+    for(int i = 0; i < count; i++) {
+        int bit = (visible[i / LOS_WORD_BITS] >> (i % LOS_WORD_BITS)) & 1;
+        mismatches += bit != los_reference(NULL, map_lines, queries[i].from, queries[i].to);
+        seen += bit;
+    }
+
+    double total = (double) count * batches;
+    printf("%8d queries: %6.2f Mq/s single, %6.2f Mq/s on %d threads, %d%% visible, %d mismatches\n",
+        count, total / single / 1e6, total / parallel / 1e6, pool->thread_count + 1, seen * 100 / count, mismatches);
+
+    free(queries);
+    free(visible);
+    grid_destroy(&grid);
+    return mismatches > 0;
+}
+
+/**
+ * Times the camera ray kernels that walk the grid, from one viewpoint of level 1 turning
+ * a full circle, and checks that the packet kernel finds the walls the grid kernel finds.
+ *
+ * @param frames The number of camera angles.
+ * @return int 0 if both kernels agree, or 1 otherwise (or if an error occurred).
+ */
+static int bench_camera(int frames) {
+    static struct ray_hit grid_hits[RAYS_NUMBER], packet_hits[RAYS_NUMBER];
+    static double directions[RAYS_NUMBER][2];
+    double x = 120, y = 180, grid_time = 0, packet_time = 0;
+    int mismatches = 0;
+    struct level level;
+
+    struct section* start = create_level_1();
+    if(start == NULL || level_index(&level, start) || pvs_build_visible_walls(&level) || level_build_grids(&level))
+        return 1;
+    const struct wall_grid* grid = level.start->grid;
+
+    for(int frame = 0; frame < frames; frame++) {
+        double angle = 2 * PI * frame / frames - PI;
+        double plane_vector[2] = { cos(angle + PI/2), sin(angle + PI/2) };
+        trig_direction_fan(angle + FOV/2, -FOV / RAYS_NUMBER, RAYS_NUMBER, directions);
+
+        Uint64 start_time = SDL_GetPerformanceCounter();
+        for(int i = 0; i < RAYS_NUMBER; i++) raycast_grid(grid, directions[i], x, y, plane_vector, &grid_hits[i]);
+        grid_time += seconds_since(start_time);
+
+        start_time = SDL_GetPerformanceCounter();
+        for(int i = 0; i < RAYS_NUMBER; i += RAY_PACKET_SIZE) {
+            int count = RAYS_NUMBER - i < RAY_PACKET_SIZE ? RAYS_NUMBER - i : RAY_PACKET_SIZE;
+            raycast_packet(grid, &directions[i], count, x, y, plane_vector, &packet_hits[i]);
+        }
+        packet_time += seconds_since(start_time);
+
+        for(int i = 0; i < RAYS_NUMBER; i++)
+            mismatches += packet_hits[i].wall != grid_hits[i].wall && fabs(packet_hits[i].distance - grid_hits[i].distance) > 1e-9;
+    }
+
+    double rays = (double) frames * RAYS_NUMBER;
+    printf("%8d frames: %6.1f ns/ray grid, %6.1f ns/ray packets of %d (%.2fx), %d mismatches\n",
+        frames, grid_time * 1e9 / rays, packet_time * 1e9 / rays, RAY_PACKET_SIZE, grid_time / packet_time, mismatches);
+
+    level_destroy(&level);
+    return mismatches != 0;
+}
+
+/**
+ * Times the visibility polygon of a field of view against one reference ray per column,
+ * from random viewpoints inside the map.
+ *
+ * @param frames The number of viewpoints.
+ */
+static void bench_visibility(int frames) {
+    static struct visibility_polygon polygon;
+    static struct ray_hit hits[RAYS_NUMBER];
+    static double directions[RAYS_NUMBER][2];
+    double sweep_time = 0, ray_time = 0;
+    int vertices = 0;
+
+    srand(frames);
+    for(int frame = 0; frame < frames; frame++) {
+        double x = 20 + 270.0 * rand() / RAND_MAX, y = 20 + 270.0 * rand() / RAND_MAX;
+        double angle = 2 * PI * rand() / RAND_MAX - PI;
+        double plane_vector[2] = { cos(angle + PI/2), sin(angle + PI/2) };
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        visibility_compute(NULL, map_lines, x, y, angle - FOV/2, FOV, VISIBILITY_RADIUS, &polygon);
+        sweep_time += seconds_since(start);
+        vertices += polygon.count;
+
+        start = SDL_GetPerformanceCounter();
+        trig_direction_fan(angle + FOV/2, -FOV / RAYS_NUMBER, RAYS_NUMBER, directions);
+        for(int i = 0; i < RAYS_NUMBER; i++)
+            raycast_reference(NULL, map_lines, directions[i], x, y, plane_vector, &hits[i]);
+        ray_time += seconds_since(start);
+    }
+
+    printf("%8d frames: %6.2f us/frame sweep (%.1f vertices), %6.2f us/frame with %d rays (%.1fx)\n",
+        frames, sweep_time * 1e6 / frames, (double) vertices / frames, ray_time * 1e6 / frames, RAYS_NUMBER, ray_time / sweep_time);
+}
+
+/**
+ * Returns the distance from a point to a map wall.
+ *
+ * @param wall The map table row of the wall.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @return double The distance.
+ */
+static double distance_to_wall(int wall, double x, double y) {
+    double dx = map[wall][2] - map[wall][0], dy = map[wall][3] - map[wall][1];
+    double t = ((x - map[wall][0]) * dx + (y - map[wall][1]) * dy) / (dx * dx + dy * dy);
+    t = fmax(0, fmin(1, t));
+    return hypot(map[wall][0] + t * dx - x, map[wall][1] + t * dy - y);
+}
+
+/**
+ * Times the quantized ray kernel against the double reference, and checks that every
+ * quantized hit lies within the error bound of the original wall it reports.
+ *
+ * @param rays The number of random rays.
+ * @return int 0 if every hit is within the bound, or 1 otherwise.
+ */
+static int bench_quantized(int rays) {
+    struct quantized_walls set;
+    struct ray_hit reference, quantized;
+    double reference_time = 0, quantized_time = 0, worst = 0;
+    int other_wall = 0;
+
+    if(quantized_build(&set, NULL, map_lines)) return 1;
+
+    srand(rays);
+    for(int i = 0; i < rays; i++) {
+        double x = 20 + 270.0 * rand() / RAND_MAX, y = 20 + 270.0 * rand() / RAND_MAX;
+        double angle = 2 * PI * rand() / RAND_MAX - PI;
+        double plane_vector[2] = { cos(angle + PI/2), sin(angle + PI/2) };
+        double direction[2] = { cos(angle), sin(angle) };
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        raycast_reference(NULL, map_lines, direction, x, y, plane_vector, &reference);
+        reference_time += seconds_since(start);
+
+        start = SDL_GetPerformanceCounter();
+        raycast_quantized(&set, direction, x, y, plane_vector, &quantized);
+        quantized_time += seconds_since(start);
+
+        if(quantized.wall < 0) continue;
+        other_wall += quantized.wall != reference.wall; // Near corners the rounding may pick a neighbour
+        worst = fmax(worst, distance_to_wall(quantized.wall, quantized.x, quantized.y));
+    }
+
+    double bound = quantized_error_bound(&set);
+    printf("%8d rays: %zu bytes/wall (was %zu), %6.1f ns/ray quantized, %6.1f ns/ray double, "
+        "worst error %.4f (bound %.4f), %d other walls\n",
+        rays, sizeof(struct quantized_wall), sizeof(map[0]), quantized_time * 1e9 / rays, reference_time * 1e9 / rays,
+        worst, bound, other_wall);
+
+    quantized_destroy(&set);
+    return worst > bound;
+}
+
+/**
+ * Runs the quantized walls benchmark on random walls with non-integer endpoints, which the
+ * quantization has to round (level 1's integer endpoints mostly fall on steps). The map
+ * table is swapped for the random walls and restored afterwards.
+ *
+ * @param walls The number of random walls, at most MAP_MAX_LINES.
+ * @param rays The number of random rays.
+ * @return int 0 if every hit is within the bound, or 1 otherwise.
+ */
+static int bench_quantized_random(int walls, int rays) {
+    static double saved[MAP_MAX_LINES][7];
+    int saved_lines = map_lines;
+    for(int i = 0; i < saved_lines; i++)
+        for(int k = 0; k < 7; k++) saved[i][k] = map[i][k];
+
+    srand(walls);
+    for(int i = 0; i < walls; i++) {
+        map[i][0] = 300.0 * rand() / RAND_MAX;
+        map[i][1] = 300.0 * rand() / RAND_MAX;
+        map[i][2] = fmin(300, fmax(0, map[i][0] + 120.0 * rand() / RAND_MAX - 60));
+        map[i][3] = fmin(300, fmax(0, map[i][1] + 120.0 * rand() / RAND_MAX - 60));
+        map[i][4] = map[i][5] = map[i][6] = 255;
+    }
+    map_lines = walls;
+
+    int error = bench_quantized(rays);
+
+    map_lines = saved_lines;
+    for(int i = 0; i < saved_lines; i++)
+        for(int k = 0; k < 7; k++) map[i][k] = saved[i][k];
+    return error;
+}
+
+/**
+ * Checks whether a map wall crosses a box (Liang-Barsky clip).
+ * 
+ * @param wall The map table row of the wall.
+ * @param min_x The left edge of the box.
+ * @param min_y The top edge of the box.
+ * @param max_x The right edge of the box.
+ * @param max_y The bottom edge of the box.
+ * @return int 1 if the wall crosses the box, 0 otherwise.
+ */
+static int wall_crosses_box(int wall, double min_x, double min_y, double max_x, double max_y) {
+    double x0 = map[wall][0], y0 = map[wall][1], dx = map[wall][2] - x0, dy = map[wall][3] - y0;
+    double p[4] = { -dx, dx, -dy, dy }, q[4] = { x0 - min_x, max_x - x0, y0 - min_y, max_y - y0 };
+    double t0 = 0, t1 = 1;
+
+    for(int i = 0; i < 4; i++) {
+        if(p[i] == 0) {
+            if(q[i] < 0) return FALSE;
+            continue;
+        }
+        double t = q[i] / p[i];
+        if(p[i] < 0) t0 = fmax(t0, t);
+        else t1 = fmin(t1, t);
+        if(t0 > t1) return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * Counts, over random boxes, the walls of a section that cross a box but that its
+ * grid does not report, or that it reports under a row that no longer exists.
+ * 
+ * @param section The section whose grid was updated in place.
+ * @param boxes The number of random boxes.
+ * @return int The number of wrong answers.
+ */
+static int grid_errors(const struct section* section, int boxes) {
+    int found[MAP_MAX_LINES], errors = 0;
+
+    srand(boxes);
+    for(int i = 0; i < boxes; i++) {
+        double x = 300.0 * rand() / RAND_MAX, y = 300.0 * rand() / RAND_MAX, size = 60.0 * rand() / RAND_MAX;
+        int count = grid_query_box(section->grid, x, y, x + size, y + size, found, MAP_MAX_LINES);
+
+        for(int j = 0; j < count; j++) errors += found[j] >= map_lines;
+        for(int k = 0; k < section->visible_wall_count; k++) {
+            int wall = section->visible_walls[k];
+            if(!wall_crosses_box(wall, x, y, x + size, y + size)) continue;
+
+            int reported = FALSE;
+            for(int j = 0; j < count && !reported; j++) reported = found[j] == wall;
+            errors += !reported;
+        }
+    }
+
+    return errors;
+}
+
+/**
+ * Times moving a sliding door panel through level_move_wall against rebuilding every
+ * section's indexes, and checks that the updated grid still reports every wall.
+ * Adds the door's panel to the map table.
+ * 
+ * @param moves The number of panel moves.
+ * @return int 0 if the updated grid is correct, or 1 otherwise.
+ */
+static int bench_doors(int moves) {
+    struct level level;
+    struct sliding_doors doors;
+    double openness[SLIDING_DOOR_MAX] = { 0 };
+
+    struct section* start = create_level_1();
+    if(start == NULL || level_index(&level, start) || pvs_build_visible_walls(&level) || level_build_grids(&level)
+        || create_level_1_doors(&level, &doors))
+        return 1;
+
+    Uint64 start_time = SDL_GetPerformanceCounter();
+    for(int i = 0; i < moves; i++) {
+        openness[0] = (double) (i % 100) / 99; // Open the door step by step, then snap it shut
+        sliding_doors_apply(&doors, &level, openness);
+    }
+    double move_time = seconds_since(start_time);
+
+    int rebuilds = moves / 100;
+    start_time = SDL_GetPerformanceCounter();
+    for(int i = 0; i < rebuilds; i++) level_build_grids(&level);
+    double rebuild_time = seconds_since(start_time);
+
+    openness[0] = 0.37;
+    sliding_doors_apply(&doors, &level, openness);
+    int errors = grid_errors(level.start, 100000);
+
+    printf("%8d moves: %6.2f us/move incremental, %6.2f us/move with a full rebuild (%.0fx), %d grid errors\n",
+        moves, move_time * 1e6 / moves, rebuild_time * 1e6 / rebuilds, rebuild_time / rebuilds / (move_time / moves), errors);
+
+    level_destroy(&level);
+    return errors != 0;
+}
+
+/**
+ * Times libm's sin, cos and atan2 against the table, the batch and the polynomial versions
+ * on random angles, and measures the largest error of each.
+ * 
+ * @param count The number of angles.
+ * @return int 0 if every error is within its documented bound, 1 otherwise.
+ */
+static int bench_trig(int count) {
+    double* angles = malloc(sizeof(double) * count);
+    double* sines = malloc(sizeof(double) * count);     // libm results, the reference
+    double* cosines = malloc(sizeof(double) * count);
+    double* fast_sines = malloc(sizeof(double) * count);
+    double* fast_cosines = malloc(sizeof(double) * count);
+    if(angles == NULL || sines == NULL || cosines == NULL || fast_sines == NULL || fast_cosines == NULL) {
+        free(angles);
+        free(sines);
+        free(cosines);
+        free(fast_sines);
+        free(fast_cosines);
+        return 1;
+    }
+
+    srand(count);
+    for(int i = 0; i < count; i++) angles[i] = ((double) rand() / RAND_MAX - 0.5) * 8 * PI;
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < count; i++) {
+        sines[i] = sin(angles[i]);
+        cosines[i] = cos(angles[i]);
+    }
+    double libm_time = seconds_since(start);
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < count; i++) trig_sincos(angles[i], &fast_sines[i], &fast_cosines[i]);
+    double table_time = seconds_since(start);
+
+    double table_error = 0;
+    for(int i = 0; i < count; i++)
+        table_error = fmax(table_error, fmax(fabs(fast_sines[i] - sines[i]), fabs(fast_cosines[i] - cosines[i])));
+
+    start = SDL_GetPerformanceCounter();
+    trig_sincos_batch(angles, fast_sines, fast_cosines, count);
+    double batch_time = seconds_since(start);
+
+    double batch_error = 0;
+    for(int i = 0; i < count; i++)
+        batch_error = fmax(batch_error, fmax(fabs(fast_sines[i] - sines[i]), fabs(fast_cosines[i] - cosines[i])));
+
+    // Vectors pointing everywhere and of various lengths, from the sines and cosines just computed
+    for(int i = 0; i < count; i++) {
+        sines[i] *= i % 7 + 1;
+        cosines[i] *= i % 7 + 1;
+    }
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < count; i++) angles[i] = atan2(sines[i], cosines[i]);
+    double atan_libm_time = seconds_since(start);
+
+    start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < count; i++) fast_sines[i] = trig_atan2(sines[i], cosines[i]);
+    double atan_time = seconds_since(start);
+
+    double atan_error = 0;
+    for(int i = 0; i < count; i++) atan_error = fmax(atan_error, fabs(fast_sines[i] - angles[i]));
+
+    printf("%8d angles: sin+cos %5.1f ns libm, %5.1f ns table (error %.2e), %5.1f ns batch (error %.2e)\n",
+        count, libm_time * 1e9 / count, table_time * 1e9 / count, table_error, batch_time * 1e9 / count, batch_error);
+    printf("%8d angles: atan2 %5.1f ns libm, %5.1f ns polynomial (error %.2e)\n",
+        count, atan_libm_time * 1e9 / count, atan_time * 1e9 / count, atan_error);
+
+    free(angles);
+    free(sines);
+    free(cosines);
+    free(fast_sines);
+    free(fast_cosines);
+    return table_error > 1.2e-6 || batch_error > 4e-16 || atan_error > 1.5e-5;
+}
+
+/*
+    Runs every benchmark and prints its results.
+*/
+int main(void) {
+    struct job_pool pool;
+    if(jobs_init(&pool, 0)) {
+        fprintf(stderr, "Error starting job pool.\n");
+        return 1;
+    }
+
+    trig_init();
+
+    printf("Entity update (SoA, chunks of %d):\n", ENTITY_CHUNK_SIZE);
+    for(int count = 10000; count <= 1000000; count *= 10) {
+        if(bench_entities(&pool, count)) {
+            fprintf(stderr, "Error allocating %d entities.\n", count);
+            jobs_destroy(&pool);
+            return 1;
+        }
+    }
+
+    printf("Line of sight (%d walls, cells of %d units):\n", map_lines, GRID_CELL_SIZE);
+    for(int count = 1000; count <= 100000; count *= 10) {
+        if(bench_line_of_sight(&pool, count)) {
+            fprintf(stderr, "Error answering %d line-of-sight queries.\n", count);
+            jobs_destroy(&pool);
+            return 1;
+        }
+    }
+
+    printf("Camera rays (%d walls, %d rays from (120, 180)):\n", map_lines, RAYS_NUMBER);
+    if(bench_camera(300)) {
+        fprintf(stderr, "Ray packets disagree with single rays.\n");
+        jobs_destroy(&pool);
+        return 1;
+    }
+
+    printf("Visibility polygon (%d walls, field of view):\n", map_lines);
+    bench_visibility(2000);
+
+    printf("Quantized walls (%d walls):\n", map_lines);
+    if(bench_quantized(1000000)) {
+        fprintf(stderr, "Quantized hits exceed the error bound.\n");
+        jobs_destroy(&pool);
+        return 1;
+    }
+    printf("Quantized walls (%d random walls, non-integer endpoints):\n", MAP_MAX_LINES);
+    if(bench_quantized_random(MAP_MAX_LINES, 1000000)) {
+        fprintf(stderr, "Quantized hits exceed the error bound.\n");
+        jobs_destroy(&pool);
+        return 1;
+    }
+
+    printf("Sliding door (%d walls):\n", map_lines + 1);
+    if(bench_doors(100000)) {
+        fprintf(stderr, "Incremental grid updates lost walls.\n");
+        jobs_destroy(&pool);
+        return 1;
+    }
+
+    printf("Trigonometry (table of %d intervals):\n", TRIG_TABLE_SIZE);
+    if(bench_trig(1000000)) {
+        fprintf(stderr, "Trigonometry errors exceed their bounds.\n");
+        jobs_destroy(&pool);
+        return 1;
+    }
+
+    jobs_destroy(&pool);
+    return 0;
+}
@@ -0,0 +1,691 @@
+// Offline tool checking the incremental level edits against indexes rebuilt from scratch
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "chunks.h"
+#include "collision.h"
+#include "constants.h"
+#include "doors.h"
+#include "grid.h"
+#include "levels.h"
+#include "map.h"
+#include "memory.h"
+#include "pvs.h"
+#include "quantized.h"
+#include "raycast.h"
+
+#define CHECK_EDITS 5000        // Random edits applied to level 1
+#define CHECK_WORLD 300         // Edited walls are drawn within [0, CHECK_WORLD] on both axes (units)
+#define CHECK_REPORT_LIMIT 10   // Failures printed in full
+#define CHECK_ROOMS 5           // Rooms of the visibility fixture
+#define CHECK_DOORS 4           // Doors of the visibility fixture
+#define CHECK_PVS_FILE "check.pvs" // Scratch file the fixture's sets are saved to and loaded from
+#define CHECK_CHUNK_DIR "check_chunks" // Directory level 1 is exported to and streamed from (must exist)
+#define CHECK_CHUNK_POINTS 200  // Points of level 1 the streamed chunks are checked around
+#define CHECK_CHUNK_RAYS 64     // Rays and moves checked from each point
+#define CHECK_CHUNK_WAIT 5000   // Milliseconds allowed for the chunks around a point to load
+
+/*
+    Visibility fixture: a row of four rooms joined by doors in their shared walls, and a fifth
+    room north of the last one, entered through the east end of its ceiling.
+    Looking down the row, the line of sight bends at most a few degrees, so the north room
+    cannot be seen from the first two rooms, nor they from it; every other pair sees each other.
+*/
+// Room outlines as {x0, y0, xf, yf}
+static const double check_rooms[CHECK_ROOMS][4] = {
+    { -100, 0, 0, 100 }, { 0, 0, 100, 100 }, { 100, 0, 200, 100 }, { 200, 0, 300, 100 }, { 200, 100, 300, 200 }
+};
+// Doors as {room, other room, x0, y0, xf, yf}
+static const double check_doors[CHECK_DOORS][6] = {
+    { 0, 1, 0, 45, 0, 55 }, { 1, 2, 100, 40, 100, 60 }, { 2, 3, 200, 40, 200, 60 }, { 3, 4, 280, 100, 300, 100 }
+};
+// Bit j of entry i is set if room j is potentially visible from room i
+static const int check_visible[CHECK_ROOMS] = { 0x0F, 0x0F, 0x1F, 0x1F, 0x1C };
+
+// Number of failed checks so far
+static int failures = 0;
+
+/**
+ * Records a failed check and prints it, up to CHECK_REPORT_LIMIT of them.
+ *
+ * @param edit The index of the edit after which the check failed.
+ * @param what What was wrong.
+ * @param section The id of the section concerned, or -1.
+ * @param detail A number further describing the failure (a row, a cell...).
+ */
+static void fail(int edit, const char* what, int section, int detail) {
+    if(failures++ < CHECK_REPORT_LIMIT)
+        printf("after edit %d: %s (section %d, %d)\n", edit, what, section, detail);
+}
+
+/**
+ * Records a failed check of the visibility fixture and prints it, up to CHECK_REPORT_LIMIT
+ * failures in all.
+ *
+ * @param what What was wrong.
+ * @param room The room concerned, or -1.
+ * @param other A second room concerned, or -1.
+ */
+static void fail_fixture(const char* what, int room, int other) {
+    if(failures++ < CHECK_REPORT_LIMIT)
+        printf("visibility fixture: %s (rooms %d, %d)\n", what, room, other);
+}
+
+/**
+ * Records a failed check of the streamed chunks and prints it, up to CHECK_REPORT_LIMIT
+ * failures in all.
+ *
+ * @param what What was wrong.
+ * @param point The index of the point checked around, or -1 for the checks made at a fixed point.
+ * @param ray The index of the ray or move from that point, or -1.
+ */
+static void fail_chunk(const char* what, int point, int ray) {
+    if(failures++ < CHECK_REPORT_LIMIT)
+        printf("streamed chunks around point %d: %s (ray %d)\n", point, what, ray);
+}
+
+/**
+ * Orders map table rows (qsort comparator).
+ *
+ * @param a The first row.
+ * @param b The second row.
+ * @return int Negative, zero or positive as a is below, equal to or above b.
+ */
+static int compare_rows(const void* a, const void* b) {
+    return *(const int*) a - *(const int*) b;
+}
+
+/**
+ * Returns a random number.
+ *
+ * @param low The smallest value.
+ * @param high The largest value.
+ * @return double A value within [low, high].
+ */
+static double random_range(double low, double high) {
+    return low + (high - low) * rand() / RAND_MAX;
+}
+
+/**
+ * Draws a random wall within the checked area.
+ *
+ * @param wall The wall as {x0, y0, xf, yf, r, g, b} (output).
+ */
+static void random_wall(double wall[7]) {
+    wall[0] = random_range(0, CHECK_WORLD);
+    wall[1] = random_range(0, CHECK_WORLD);
+    wall[2] = fmin(CHECK_WORLD, fmax(0, wall[0] + random_range(-60, 60)));
+    wall[3] = fmin(CHECK_WORLD, fmax(0, wall[1] + random_range(-60, 60)));
+    wall[4] = wall[5] = wall[6] = 255;
+}
+
+/**
+ * Compares a section's grid, updated in place, with a grid rebuilt from the section's
+ * visible walls over the same cells: every cell must list the same walls.
+ *
+ * @param section The section.
+ * @param edit The index of the last edit.
+ */
+static void check_grid(const struct section* section, int edit) {
+    const struct wall_grid* grid = section->grid;
+    struct wall_grid rebuilt = *grid;
+    rebuilt.cells = memory_calloc(MEMORY_GRIDS, (size_t) grid->columns * grid->rows, sizeof(struct grid_cell));
+    if(rebuilt.cells == NULL) {
+        fail(edit, "out of memory", section->id, 0);
+        return;
+    }
+
+    for(int i = 0; i < section->visible_wall_count; i++)
+        if(grid_insert(&rebuilt, &map[0][0], section->visible_walls[i]))
+            fail(edit, "visible wall outside the grid", section->id, section->visible_walls[i]);
+
+    for(int c = 0; c < grid->columns * grid->rows; c++) {
+        struct grid_cell* kept = &grid->cells[c], *fresh = &rebuilt.cells[c];
+        if(kept->count != fresh->count) {
+            fail(edit, "grid cell lists a different number of walls", section->id, c);
+            continue;
+        }
+        if(kept->count == 0) continue;
+        qsort(kept->walls, kept->count, sizeof(int), compare_rows);
+        qsort(fresh->walls, fresh->count, sizeof(int), compare_rows);
+        for(int k = 0; k < kept->count; k++)
+            if(kept->walls[k] != fresh->walls[k]) {
+                fail(edit, "grid cell lists a different wall", section->id, c);
+                break;
+            }
+    }
+
+    grid_destroy(&rebuilt);
+}
+
+/**
+ * Compares a section's quantized walls, updated in place, with a set rebuilt from the
+ * section's visible walls: both must hold the same rows, and every wall must decode to
+ * within the error bound of its map row.
+ *
+ * @param section The section.
+ * @param edit The index of the last edit.
+ */
+static void check_quantized(const struct section* section, int edit) {
+    const struct quantized_walls* kept = section->quantized;
+    struct quantized_walls fresh;
+    if(kept == NULL) return; // Too spread out to quantize: the section casts on doubles
+    if(quantized_build(&fresh, section->visible_walls, section->visible_wall_count)) {
+        fail(edit, "quantized walls could not be rebuilt", section->id, 0);
+        return;
+    }
+
+    if(kept->count != fresh.count) {
+        fail(edit, "quantized set holds a different number of walls", section->id, kept->count);
+    } else {
+        int kept_rows[MAP_MAX_LINES], fresh_rows[MAP_MAX_LINES];
+        for(int i = 0; i < kept->count; i++) {
+            kept_rows[i] = kept->rows[i];
+            fresh_rows[i] = fresh.rows[i];
+        }
+        qsort(kept_rows, kept->count, sizeof(int), compare_rows);
+        qsort(fresh_rows, fresh.count, sizeof(int), compare_rows);
+        for(int i = 0; i < kept->count; i++)
+            if(kept_rows[i] != fresh_rows[i]) {
+                fail(edit, "quantized set holds a different row", section->id, kept_rows[i]);
+                break;
+            }
+    }
+
+    double bound = quantized_error_bound(kept);
+    for(int i = 0; i < kept->count; i++) {
+        double line[4];
+        int row = kept->rows[i];
+        quantized_decode(kept, i, line);
+        if(row < 0 || row >= map_lines) {
+            fail(edit, "quantized wall refers to a missing row", section->id, row);
+            continue;
+        }
+        for(int k = 0; k < 4; k++)
+            if(fabs(line[k] - map[row][k]) > bound) {
+                fail(edit, "quantized wall is off its map row", section->id, row);
+                break;
+            }
+    }
+
+    quantized_destroy(&fresh);
+}
+
+/**
+ * Checks every index of a level after an edit: the sections' walls against the map table,
+ * their grids and quantized walls against rebuilt ones, and the door panels' positions.
+ *
+ * @param level The level.
+ * @param doors The doors of the level.
+ * @param openness The openness the doors were last moved to.
+ * @param edit The index of the last edit.
+ */
+static void check_level(const struct level* level, const struct sliding_doors* doors, const double* openness, int edit) {
+    int owners[MAP_MAX_LINES] = { 0 };
+
+    for(int s = 0; s < level->section_count; s++) {
+        const struct section* section = level->sections[s];
+        for(int i = 0; i < section->wall_count; i++) {
+            int row = section->wall_ids[i];
+            const struct line* wall = &section->walls[i];
+            if(row < 0 || row >= map_lines) {
+                fail(edit, "section wall refers to a missing row", s, row);
+                continue;
+            }
+            owners[row]++;
+            if(wall->x0 != map[row][0] || wall->y0 != map[row][1] || wall->xf != map[row][2] || wall->yf != map[row][3])
+                fail(edit, "section wall differs from its map row", s, row);
+        }
+        for(int i = 0; i < section->visible_wall_count; i++)
+            if(section->visible_walls[i] < 0 || section->visible_walls[i] >= map_lines)
+                fail(edit, "visible wall refers to a missing row", s, section->visible_walls[i]);
+
+        check_grid(section, edit);
+        check_quantized(section, edit);
+    }
+
+    for(int row = 0; row < map_lines; row++)
+        if(owners[row] != 1) fail(edit, "map row is not owned by exactly one section", -1, row);
+
+    for(int i = 0; i < doors->count; i++) {
+        const struct sliding_door* door = &doors->doors[i];
+        for(int k = 0; k < 4; k++) {
+            double expected = door->closed[k] + (door->open[k] - door->closed[k]) * openness[i];
+            if(door->row < 0 || door->row >= map_lines || map[door->row][k] != expected) {
+                fail(edit, "door panel is not where the door put it", -1, i);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Adds, moves and removes random walls and sliding doors of level 1 and checks every
+ * index after each edit.
+ *
+ * @return int 0 if level 1 was built, or 1 if an error occurred.
+ */
+static int check_edits(void) {
+    struct level level;
+    struct sliding_doors doors;
+    double openness[SLIDING_DOOR_MAX] = { 0 };
+
+    struct section* start = create_level_1();
+    if(start == NULL || level_index(&level, start) || pvs_build_visible_walls(&level) || level_build_grids(&level)
+        || create_level_1_doors(&level, &doors))
+        return 1;
+
+    srand(CHECK_EDITS);
+    int counts[6] = { 0 };
+    for(int edit = 0; edit < CHECK_EDITS; edit++) {
+        int kind = rand() % 6;
+        double wall[7];
+        random_wall(wall);
+
+        // Edits that cannot be made now slide the doors instead
+        if((kind == 0 && map_lines >= MAP_MAX_LINES - 1) || (kind == 2 && map_lines <= 1)
+            || (kind == 3 && (doors.count == SLIDING_DOOR_MAX || map_lines >= MAP_MAX_LINES - 1)) || (kind == 4 && doors.count == 0))
+            kind = 5;
+
+        if(kind == 0) { // Add a wall
+            if(level_add_wall(&level, level.start, wall) < 0) fail(edit, "wall could not be added", 0, map_lines);
+        } else if(kind == 1) { // Move a wall, possibly a door panel
+            if(level_move_wall(&level, rand() % map_lines, wall)) fail(edit, "wall could not be moved", 0, 0);
+            // A moved panel is reset by the next door move
+            for(int i = 0; i < doors.count; i++) doors.doors[i].shown = -1;
+            sliding_doors_apply(&doors, &level, openness);
+        } else if(kind == 2) { // Remove a wall, possibly a door panel
+            int row = rand() % map_lines;
+            for(int i = 0; i < doors.count; i++) {
+                if(doors.doors[i].row != row) continue;
+                for(int j = i; j < doors.count - 1; j++) openness[j] = openness[j + 1];
+                break;
+            }
+            if(level_remove_wall(&level, row)) fail(edit, "wall could not be removed", 0, row);
+        } else if(kind == 3) { // Add a door
+            double open[4] = { wall[0] + 20, wall[1], wall[2] + 20, wall[3] };
+            if(sliding_door_add(&doors, &level, level.start, wall, open, &wall[4])) fail(edit, "door could not be added", 0, doors.count);
+            else openness[doors.count - 1] = 0;
+        } else if(kind == 4) { // Remove a door
+            int index = rand() % doors.count;
+            sliding_door_remove(&doors, &level, index);
+            for(int j = index; j < doors.count; j++) openness[j] = openness[j + 1];
+        } else { // Slide the doors
+            for(int i = 0; i < doors.count; i++) openness[i] = (double) (rand() % 5) / 4;
+            if(sliding_doors_apply(&doors, &level, openness)) fail(edit, "doors could not be moved", 0, 0);
+        }
+        counts[kind]++;
+
+        check_level(&level, &doors, openness, edit);
+    }
+
+    printf("%d edits (%d wall additions, %d moves, %d removals, %d door additions, %d door removals, %d door slides): %d walls, %d doors left\n",
+        CHECK_EDITS, counts[0], counts[1], counts[2], counts[3], counts[4], counts[5], map_lines, doors.count);
+
+    level_destroy(&level);
+    return 0;
+}
+
+/**
+ * Builds the rooms and doors of the visibility fixture.
+ *
+ * @param rooms The rooms (output).
+ * @return int 0 if the fixture was built, or 1 if an error occurred (the rooms built so far are destroyed).
+ */
+static int build_fixture(struct section* rooms[CHECK_ROOMS]) {
+    for(int i = 0; i < CHECK_ROOMS; i++) {
+        const double* box = check_rooms[i];
+        struct line outline[4] = {
+            { box[0], box[1], box[2], box[1] }, { box[2], box[1], box[2], box[3] },
+            { box[2], box[3], box[0], box[3] }, { box[0], box[3], box[0], box[1] }
+        };
+        rooms[i] = section_create(2, 4);
+        if(rooms[i] == NULL) {
+            for(int k = 0; k < i; k++) section_destroy(rooms[k]);
+            return 1;
+        }
+        for(int k = 0; k < 4; k++) section_add_wall(rooms[i], outline[k]); // Room for four walls was allocated
+    }
+
+    // Each door is a pair of portals sharing a position, one in each room, leading to each other
+    for(int i = 0; i < CHECK_DOORS; i++) {
+        struct section* a = rooms[(int) check_doors[i][0]], *b = rooms[(int) check_doors[i][1]];
+        struct line position = { check_doors[i][2], check_doors[i][3], check_doors[i][4], check_doors[i][5] };
+        if(section_add_door(a, position, NULL)
+            || section_add_door(b, position, &a->doors[a->door_count - 1])) {
+            for(int k = 0; k < CHECK_ROOMS; k++) section_destroy(rooms[k]);
+            return 1;
+        }
+        a->doors[a->door_count - 1].dest = &b->doors[b->door_count - 1];
+    }
+
+    return 0;
+}
+
+/**
+ * Compares the potentially visible sets of the fixture's rooms with the expected ones.
+ *
+ * @param rooms The rooms, with their sets computed or loaded.
+ * @param how How the sets were obtained, for the report.
+ */
+static void compare_visible(struct section* rooms[CHECK_ROOMS], const char* how) {
+    for(int i = 0; i < CHECK_ROOMS; i++)
+        for(int j = 0; j < CHECK_ROOMS; j++)
+            if(pvs_is_visible(rooms[i], rooms[j]) != ((check_visible[i] >> j) & 1))
+                fail_fixture(how, i, j);
+}
+
+/**
+ * Computes the potentially visible sets of the fixture and compares them with the expected
+ * ones, then saves them and checks that they load back only while the geometry is unchanged.
+ *
+ * @return int 0 if the fixture was built, or 1 if an error occurred.
+ */
+static int check_visibility(void) {
+    struct level level;
+    struct section* rooms[CHECK_ROOMS];
+
+    if(build_fixture(rooms)) return 1;
+    if(level_index(&level, rooms[1]) || level.section_count != CHECK_ROOMS || pvs_compute(&level)) {
+        level_destroy(&level);
+        return 1;
+    }
+    compare_visible(rooms, "computed set differs");
+
+    if(pvs_save(&level, CHECK_PVS_FILE)) fail_fixture("sets could not be saved", -1, -1);
+    for(int i = 0; i < CHECK_ROOMS; i++) memset(rooms[i]->pvs, 0, 1);
+    if(pvs_load(&level, CHECK_PVS_FILE)) fail_fixture("sets of unchanged geometry were rejected", -1, -1);
+    compare_visible(rooms, "loaded set differs");
+
+    // Moving a wall or a door must invalidate the file
+    struct line wall = rooms[3]->walls[0];
+    rooms[3]->walls[0].xf += 1;
+    if(!pvs_load(&level, CHECK_PVS_FILE)) fail_fixture("sets of a moved wall were accepted", 3, -1);
+    rooms[3]->walls[0] = wall;
+
+    struct line door = rooms[2]->doors[1].position;
+    struct line moved = { door.x0, door.y0 - 10, door.xf, door.yf - 10 };
+    section_move_door(&rooms[2]->doors[1], moved);
+    if(!pvs_load(&level, CHECK_PVS_FILE)) fail_fixture("sets of a moved door were accepted", 2, 3);
+    section_move_door(&rooms[2]->doors[1], door);
+
+    if(pvs_load(&level, CHECK_PVS_FILE)) fail_fixture("sets of restored geometry were rejected", -1, -1);
+    remove(CHECK_PVS_FILE);
+
+    printf("%d rooms, %d doors: potentially visible sets computed, saved and loaded\n", CHECK_ROOMS, CHECK_DOORS);
+    level_destroy(&level);
+    return 0;
+}
+
+/**
+ * Returns the resident chunk containing a point.
+ *
+ * @param streamer The streamer.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @return const struct chunk* The chunk, or NULL if it has no walls or is not resident.
+ */
+static const struct chunk* chunk_at(const struct chunk_streamer* streamer, double x, double y) {
+    int cx = (int) floor(x / CHUNK_SIZE), cy = (int) floor(y / CHUNK_SIZE);
+    for(int i = 0; i < CHUNK_SLOTS; i++) {
+        const struct chunk* chunk = &streamer->slots[i];
+        if(chunk->state == CHUNK_READY && chunk->cx == cx && chunk->cy == cy) return chunk;
+    }
+    return NULL;
+}
+
+/**
+ * Checks whether two hits are the same.
+ *
+ * @param a The first hit.
+ * @param b The second hit.
+ * @return int 1 if both miss or both hit at the same distance, 0 otherwise.
+ */
+static int same_hit(const struct ray_hit* a, const struct ray_hit* b) {
+    if(a->wall < 0 || b->wall < 0) return a->wall < 0 && b->wall < 0;
+    return fabs(a->distance - b->distance) <= 1e-9 * (1 + a->distance);
+}
+
+/**
+ * Casts a ray through the grids of streamed chunks and against walls added after they
+ * were exported, like the game does once the chunks around the player are resident.
+ *
+ * @param grids The grids of the chunks.
+ * @param grid_count The number of grids.
+ * @param added The map table rows of the walls in no chunk.
+ * @param added_count The number of those rows.
+ * @param direction The unit direction of the ray.
+ * @param x The x-coordinate of the origin.
+ * @param y The y-coordinate of the origin.
+ * @param plane_vector The camera plane.
+ * @param hit The nearest hit (output).
+ */
+static void cast_streamed(const struct wall_grid** grids, int grid_count, const int* added, int added_count,
+    double direction[2], double x, double y, double plane_vector[2], struct ray_hit* hit) {
+    struct ray_hit chunk_hit;
+    raycast_reference(added, added_count, direction, x, y, plane_vector, hit);
+    for(int g = 0; g < grid_count; g++) {
+        raycast_grid(grids[g], direction, x, y, plane_vector, &chunk_hit);
+        if(chunk_hit.distance < hit->distance) *hit = chunk_hit;
+    }
+}
+
+/**
+ * Updates a streamer around a still point until the chunks around it are resident,
+ * for up to CHECK_CHUNK_WAIT milliseconds.
+ *
+ * @param streamer The streamer.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @param grids The grids of the chunks (output, CHUNK_AREA at most).
+ * @return int The number of grids, or -1 if the area is still incomplete.
+ */
+static int wait_for_area(struct chunk_streamer* streamer, double x, double y, const struct wall_grid** grids) {
+    const double still[2] = { 0, 0 };
+    int grid_count = -1;
+    for(int waited = 0; waited < CHECK_CHUNK_WAIT && grid_count < 0; waited++) {
+        chunk_streamer_update(streamer, x, y, still);
+        grid_count = chunk_streamer_gather(streamer, x, y, grids);
+        if(grid_count < 0) SDL_Delay(1);
+    }
+    return grid_count;
+}
+
+/**
+ * Checks edits made while streaming: walls copied into the chunks can be neither moved nor
+ * removed, and a wall added later is hit and collided with through the rows after the
+ * exported ones.
+ *
+ * @param level The streamed level, with its streamed walls set.
+ * @param streamer The streamer.
+ * @param x The x-coordinate of a point of the level.
+ * @param y The y-coordinate of that point.
+ */
+static void check_streamed_edits(struct level* level, struct chunk_streamer* streamer, double x, double y) {
+    const struct wall_grid* grids[CHUNK_AREA];
+    int added[MAP_MAX_LINES], added_count = 0;
+    double first[7];
+
+    memcpy(first, map[0], sizeof(first));
+    const double moved[4] = { first[0] + 1, first[1] + 1, first[2] + 1, first[3] + 1 };
+    if(!level_move_wall(level, 0, moved) || memcmp(first, map[0], sizeof(first)) != 0)
+        fail_chunk("streamed wall was moved", -1, -1);
+    if(!level_remove_wall(level, 0) || map_lines != streamer->wall_count)
+        fail_chunk("streamed wall was removed", -1, -1);
+
+    const double wall[7] = { x - 20, y + 5, x + 20, y + 5, 255, 0, 0 };
+    int row = level_add_wall(level, level->start, wall);
+    int grid_count = wait_for_area(streamer, x, y, grids);
+    if(row < 0 || grid_count < 0) {
+        fail_chunk("wall could not be added while streaming", -1, -1);
+        return;
+    }
+    for(int i = streamer->wall_count; i < map_lines; i++) added[added_count++] = i;
+
+    double direction[2] = { 0, 1 }, plane_vector[2] = { -1, 0 };
+    struct ray_hit hit;
+    cast_streamed(grids, grid_count, added, added_count, direction, x, y, plane_vector, &hit);
+    if(hit.wall != row) fail_chunk("ray missed a wall added while streaming", -1, -1);
+
+    struct point from = { x, y }, to = { x, y + 20 };
+    struct point expected = collide_and_slide(level->start->grid, from, to, PLAYER_WIDTH / 2);
+    struct point got = collide_and_slide_grids(grids, grid_count, added, added_count, from, to, PLAYER_WIDTH / 2);
+    if(fabs(expected.x - got.x) > 1e-9 || fabs(expected.y - got.y) > 1e-9 || got.y > y + 5 - PLAYER_WIDTH / 2 + 1e-9)
+        fail_chunk("move went through a wall added while streaming", -1, -1);
+
+    level_remove_wall(level, row);
+}
+
+/**
+ * Truncates the file of the chunk holding a point, then checks that the streamer marks
+ * that chunk failed rather than missing and keeps the area incomplete, and that it
+ * loads the chunk once the file is exported again.
+ *
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @return int 0 if the chunks were written and streamed, or 1 if an error occurred.
+ */
+static int check_failed_chunk(double x, double y) {
+    struct chunk_streamer streamer;
+    const struct wall_grid* grids[CHUNK_AREA];
+    const double still[2] = { 0, 0 };
+    char path[256];
+    int cx = (int) floor(x / CHUNK_SIZE), cy = (int) floor(y / CHUNK_SIZE), wall_count = 1;
+
+    // A file cut short after its header
+    snprintf(path, sizeof(path), "%s/%d_%d.chunk", CHECK_CHUNK_DIR, cx, cy);
+    FILE* file = fopen(path, "wb");
+    if(file == NULL) return 1;
+    int error = fwrite("CHK3", 1, 4, file) != 4 || fwrite(&wall_count, sizeof(int), 1, file) != 1;
+    if(fclose(file) != 0 || error || chunk_streamer_start(&streamer, CHECK_CHUNK_DIR)) return 1;
+
+    enum chunk_state state = CHUNK_QUEUED;
+    for(int waited = 0; waited < CHECK_CHUNK_WAIT && (state == CHUNK_QUEUED || state == CHUNK_LOADING); waited++) {
+        chunk_streamer_update(&streamer, x, y, still);
+        SDL_LockMutex(streamer.lock);
+        for(int i = 0; i < CHUNK_SLOTS; i++)
+            if(streamer.slots[i].state != CHUNK_EMPTY && streamer.slots[i].cx == cx && streamer.slots[i].cy == cy)
+                state = streamer.slots[i].state;
+        SDL_UnlockMutex(streamer.lock);
+        SDL_Delay(1);
+    }
+    if(state != CHUNK_FAILED) fail_chunk("truncated chunk was not marked failed", -1, -1);
+    if(chunk_streamer_gather(&streamer, x, y, grids) >= 0) fail_chunk("area with a failed chunk was used", -1, -1);
+
+    // Fixing the file lets the next retry load it
+    if(chunk_export(CHECK_CHUNK_DIR) < 0) {
+        chunk_streamer_stop(&streamer);
+        return 1;
+    }
+    if(wait_for_area(&streamer, x, y, grids) < 0) fail_chunk("failed chunk was not read again", -1, -1);
+    if(streamer.metrics.failures == 0) fail_chunk("failed read was not counted", -1, -1);
+    chunk_streamer_stop(&streamer);
+    return 0;
+}
+
+/**
+ * Exports level 1 to chunk files, streams them back around random points and checks that
+ * rays and moves against the chunks around each point give the same results as against
+ * the whole map, and that rays hitting a wall within the point's own chunk find it in
+ * that chunk alone, wherever the wall's middle is. Then checks a chunk whose file is cut short.
+ *
+ * @return int 0 if the chunks were exported and streamed, or 1 if an error occurred.
+ */
+static int check_chunks(void) {
+    struct level level;
+    struct chunk_streamer streamer;
+
+    struct section* start = create_level_1();
+    if(start == NULL || level_index(&level, start) || pvs_build_visible_walls(&level) || level_build_grids(&level))
+        return 1;
+    int written = chunk_export(CHECK_CHUNK_DIR);
+    if(written < 0 || chunk_streamer_start(&streamer, CHECK_CHUNK_DIR)) {
+        level_destroy(&level);
+        return 1;
+    }
+
+    srand(CHECK_CHUNK_POINTS);
+    int rays = 0, own_chunk_rays = 0, moves = 0;
+    for(int p = 0; p < CHECK_CHUNK_POINTS; p++) {
+        double x = random_range(10, CHECK_WORLD), y = random_range(10, CHECK_WORLD);
+        const struct wall_grid* grids[CHUNK_AREA];
+        int grid_count = wait_for_area(&streamer, x, y, grids);
+        if(grid_count < 0) {
+            fail_chunk("chunks around a point did not load", p, -1);
+            continue;
+        }
+        const struct chunk* own = chunk_at(&streamer, x, y);
+
+        for(int k = 0; k < CHECK_CHUNK_RAYS; k++) {
+            double angle = random_range(-PI, PI);
+            double direction[2] = { cos(angle), sin(angle) };
+            double plane_vector[2] = { -direction[1], direction[0] };
+            struct ray_hit reference, hit, streamed;
+
+            // Rays: the nearest hit over the chunks around the point
+            raycast_reference(NULL, map_lines, direction, x, y, plane_vector, &reference);
+            cast_streamed(grids, grid_count, NULL, 0, direction, x, y, plane_vector, &streamed);
+            rays++;
+            if(!same_hit(&reference, &streamed)) fail_chunk("ray through the chunks missed the nearest wall", p, k);
+            else if(streamed.wall >= 0 && (streamed.row[4] != reference.row[4] || streamed.row[5] != reference.row[5]
+                || streamed.row[6] != reference.row[6]))
+                fail_chunk("ray through the chunks hit a wall of another color", p, k);
+
+            // A wall hit within the point's chunk must be stored in that chunk
+            if(reference.wall >= 0 && own != NULL && chunk_at(&streamer, reference.x, reference.y) == own) {
+                raycast_grid(&own->grid, direction, x, y, plane_vector, &hit);
+                own_chunk_rays++;
+                if(!same_hit(&reference, &hit)) fail_chunk("wall crossing a chunk is missing from it", p, k);
+            }
+
+            // Moves: the same stop and slide against the chunks as against the section
+            struct point from = { x, y }, to = { x + 40 * direction[0], y + 40 * direction[1] };
+            struct point expected = collide_and_slide(level.start->grid, from, to, PLAYER_WIDTH / 2);
+            struct point got = collide_and_slide_grids(grids, grid_count, NULL, 0, from, to, PLAYER_WIDTH / 2);
+            moves++;
+            if(fabs(expected.x - got.x) > 1e-9 || fabs(expected.y - got.y) > 1e-9)
+                fail_chunk("move against the chunks ended elsewhere", p, k);
+        }
+    }
+
+    printf("%d chunk files, %d points: %d rays (%d within the point's chunk), %d moves compared with the map\n",
+        written, CHECK_CHUNK_POINTS, rays, own_chunk_rays, moves);
+
+    level.streamed_walls = streamer.wall_count;
+    check_streamed_edits(&level, &streamer, 150, 150);
+    level.streamed_walls = 0;
+    chunk_streamer_stop(&streamer);
+
+    int error = check_failed_chunk(50, 50);
+    level_destroy(&level);
+    return error;
+}
+
+/*
+    Runs every check and prints its results.
+    Exits with 1 if any check fails.
+*/
+int main(void) {
+    printf("Streamed chunks against the map:\n");
+    if(check_chunks()) {
+        fprintf(stderr, "Error exporting or streaming level 1 from %s.\n", CHECK_CHUNK_DIR);
+        return 1;
+    }
+
+    printf("Level edits against full rebuilds:\n");
+    if(check_edits()) {
+        fprintf(stderr, "Error building level 1.\n");
+        return 1;
+    }
+
+    printf("Visibility through doors:\n");
+    if(check_visibility()) {
+        fprintf(stderr, "Error building the visibility fixture.\n");
+        return 1;
+    }
+
+    printf("%d failures\n", failures);
+    return failures > 0;
+}
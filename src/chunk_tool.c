@@ -0,0 +1,26 @@
+// Offline tool splitting a level into the chunk files streamed by the game
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "chunks.h"
+#include "constants.h"
+#include "map.h"
+
+/*
+    Simplifies the map the same way the game does and writes one file per chunk into the
+    directory given as argument (CHUNK_DIR by default), which must exist.
+*/
+int main(int argc, char* argv[]) {
+    const char* directory = argc > 1 ? argv[1] : CHUNK_DIR;
+
+    map_simplify(NULL); // Chunks must hold the same walls as the game's map table
+
+    int written = chunk_export(directory);
+    if(written < 0) {
+        fprintf(stderr, "Error writing chunks to %s.\n", directory);
+        return 1;
+    }
+    printf("%d walls written to %d chunks of %d units in %s\n", map_lines, written, CHUNK_SIZE, directory);
+
+    return 0;
+}
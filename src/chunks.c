@@ -0,0 +1,568 @@
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "constants.h"
+#include "map.h"
+#include "memory.h"
+#include "chunks.h"
+
+// Identify files written by chunk_export
+#define CHUNK_MAGIC "CHK3"
+#define CHUNK_INDEX_MAGIC "CHI1"
+
+/**
+ * Returns the chunk column or row containing a world coordinate.
+ *
+ * @param coordinate The world x- or y-coordinate.
+ * @return int The chunk column (for x) or row (for y).
+ */
+static int chunk_coordinate(double coordinate) {
+    return (int) floor(coordinate / CHUNK_SIZE);
+}
+
+/**
+ * Builds the path of a chunk file.
+ *
+ * @param directory The directory of the chunk files.
+ * @param cx The chunk column.
+ * @param cy The chunk row.
+ * @param path The path (output).
+ * @param size The capacity of path.
+ */
+static void chunk_path(const char* directory, int cx, int cy, char* path, size_t size) {
+    snprintf(path, size, "%s/%d_%d.chunk", directory, cx, cy);
+}
+
+/**
+ * Builds the path of the index file of a chunk directory.
+ *
+ * @param directory The directory of the chunk files.
+ * @param path The path (output).
+ * @param size The capacity of path.
+ */
+static void chunk_index_path(const char* directory, char* path, size_t size) {
+    snprintf(path, size, "%s/index", directory);
+}
+
+/**
+ * Checks whether a segment crosses or touches a chunk (Liang-Barsky clip against its square).
+ *
+ * @param segment The segment as {x0, y0, xf, yf}.
+ * @param cx The chunk column.
+ * @param cy The chunk row.
+ * @return int 1 if part of the segment lies in the chunk, its edges included, 0 otherwise.
+ */
+static int segment_in_chunk(const double segment[4], int cx, int cy) {
+    double x0 = segment[0], y0 = segment[1], dx = segment[2] - x0, dy = segment[3] - y0;
+    double min_x = (double) cx * CHUNK_SIZE, min_y = (double) cy * CHUNK_SIZE;
+    double p[4] = { -dx, dx, -dy, dy };
+    double q[4] = { x0 - min_x, min_x + CHUNK_SIZE - x0, y0 - min_y, min_y + CHUNK_SIZE - y0 };
+    double t0 = 0, t1 = 1;
+
+    for(int i = 0; i < 4; i++) {
+        if(p[i] == 0) {
+            if(q[i] < 0) return FALSE;
+            continue;
+        }
+        double t = q[i] / p[i];
+        if(p[i] < 0) t0 = fmax(t0, t);
+        else t1 = fmin(t1, t);
+        if(t0 > t1) return FALSE;
+    }
+    return TRUE;
+}
+
+/**
+ * Writes the walls crossing one chunk, if there are any.
+ *
+ * @param directory The directory to write into.
+ * @param cx The chunk column.
+ * @param cy The chunk row.
+ * @return int 1 if the file was written, 0 if the chunk is empty, or -1 if an error occurred.
+ */
+static int chunk_write(const char* directory, int cx, int cy) {
+    char path[256];
+    int wall_count = 0;
+
+    for(int i = 0; i < map_lines; i++) wall_count += segment_in_chunk(map[i], cx, cy);
+    if(wall_count == 0) return 0;
+
+    chunk_path(directory, cx, cy, path, sizeof(path));
+    FILE* file = fopen(path, "wb");
+    if(file == NULL) return -1;
+
+    int error = fwrite(CHUNK_MAGIC, 1, 4, file) != 4
+        || fwrite(&wall_count, sizeof(int), 1, file) != 1;
+    for(int i = 0; i < map_lines && !error; i++)
+        if(segment_in_chunk(map[i], cx, cy)) error = fwrite(map[i], sizeof(double), 7, file) != 7;
+
+    return fclose(file) != 0 || error ? -1 : 1;
+}
+
+/**
+ * Writes the walls of the map table into one file per chunk they cross: a wall crossing
+ * a chunk border is stored in every chunk it crosses. An index file records the exported
+ * walls, so the game only streams chunks cut from its own map.
+ *
+ * @param directory The existing directory to write into.
+ * @return int The number of chunk files written, or -1 if an error occurred.
+ */
+int chunk_export(const char* directory) {
+    char path[256];
+    int first[2] = { 0, 0 }, last[2] = { -1, -1 }; // Range of chunks covered by the walls
+    int count = 0;
+
+    for(int i = 0; i < map_lines; i++) {
+        for(int axis = 0; axis < 2; axis++) {
+            int low = chunk_coordinate(fmin(map[i][axis], map[i][axis + 2]));
+            int high = chunk_coordinate(fmax(map[i][axis], map[i][axis + 2]));
+            if(i == 0 || low < first[axis]) first[axis] = low;
+            if(i == 0 || high > last[axis]) last[axis] = high;
+        }
+    }
+
+    for(int cy = first[1]; cy <= last[1]; cy++) {
+        for(int cx = first[0]; cx <= last[0]; cx++) {
+            int written = chunk_write(directory, cx, cy);
+            if(written < 0) return -1;
+            count += written;
+        }
+    }
+
+    chunk_index_path(directory, path, sizeof(path));
+    FILE* file = fopen(path, "wb");
+    if(file == NULL) return -1;
+    int error = fwrite(CHUNK_INDEX_MAGIC, 1, 4, file) != 4
+        || fwrite(&map_lines, sizeof(int), 1, file) != 1
+        || fwrite(map, sizeof(map[0]), map_lines, file) != (size_t) map_lines;
+    return fclose(file) != 0 || error ? -1 : count;
+}
+
+/**
+ * Checks that a chunk directory was exported from the walls at the start of the map table.
+ * Walls added later (door panels) are not in the chunks and must be collided with apart.
+ *
+ * @param directory The directory of the chunk files.
+ * @param count The number of exported walls (output).
+ * @return int 0 if the index matches the map table, or 1 if it is missing or does not match.
+ */
+static int chunk_index_check(const char* directory, int* count) {
+    static double exported[MAP_MAX_LINES][7];
+    char path[256], magic[4];
+
+    chunk_index_path(directory, path, sizeof(path));
+    FILE* file = fopen(path, "rb");
+    if(file == NULL) return 1;
+
+    int error = fread(magic, 1, 4, file) != 4 || memcmp(magic, CHUNK_INDEX_MAGIC, 4) != 0
+        || fread(count, sizeof(int), 1, file) != 1 || *count < 0 || *count > map_lines
+        || fread(exported, sizeof(exported[0]), *count, file) != (size_t) *count
+        || memcmp(exported, map, sizeof(exported[0]) * *count) != 0;
+    fclose(file);
+    return error;
+}
+
+/**
+ * Forgets the data of a chunk without freeing it.
+ *
+ * @param chunk The chunk to empty.
+ */
+static void chunk_reset(struct chunk* chunk) {
+    chunk->walls = NULL;
+    chunk->grid.cells = NULL;
+    chunk->wall_count = 0;
+    chunk->bytes = 0;
+}
+
+/**
+ * Frees the data of a chunk.
+ *
+ * @param chunk The chunk to empty.
+ */
+static void chunk_free(struct chunk* chunk) {
+    if(chunk->grid.cells != NULL) grid_destroy(&chunk->grid);
+    memory_free(chunk->walls);
+    chunk_reset(chunk);
+}
+
+/**
+ * Reads a chunk file and indexes its walls. Runs on the loader thread, without the lock.
+ *
+ * @param directory The directory of the chunk files.
+ * @param chunk The chunk to fill; cx and cy must be set.
+ * @return int 0 if the chunk was read, 1 if it has no file, or -1 if the file could not be
+ *             opened or read, is invalid, or the chunk could not be allocated.
+ */
+static int chunk_read(const char* directory, struct chunk* chunk) {
+    char path[256], magic[4];
+    chunk_path(directory, chunk->cx, chunk->cy, path, sizeof(path));
+
+    FILE* file = fopen(path, "rb");
+    if(file == NULL) return errno == ENOENT ? 1 : -1;
+
+    int error = fread(magic, 1, 4, file) != 4 || memcmp(magic, CHUNK_MAGIC, 4) != 0
+        || fread(&chunk->wall_count, sizeof(int), 1, file) != 1
+        || chunk->wall_count < 0;
+    if(!error) {
+        chunk->walls = memory_alloc(MEMORY_CHUNKS, sizeof(double[7]) * (chunk->wall_count > 0 ? chunk->wall_count : 1));
+        error = chunk->walls == NULL
+            || fread(chunk->walls, sizeof(double[7]), chunk->wall_count, file) != (size_t) chunk->wall_count;
+    }
+    fclose(file);
+
+    if(!error) error = grid_build_table(&chunk->grid, &chunk->walls[0][0], NULL, chunk->wall_count, GRID_CELL_SIZE);
+    if(error) {
+        chunk_free(chunk);
+        return -1;
+    }
+
+    // Account for the tables and the grid cells
+    chunk->bytes = sizeof(double[7]) * chunk->wall_count
+        + sizeof(struct grid_cell) * chunk->grid.columns * chunk->grid.rows;
+    for(int i = 0; i < chunk->grid.columns * chunk->grid.rows; i++)
+        chunk->bytes += sizeof(int) * chunk->grid.cells[i].capacity;
+    return 0;
+}
+
+/**
+ * Returns the wait before a chunk that failed to load is read again, doubled after each
+ * failure up to CHUNK_RETRY_MAX_DELAY.
+ *
+ * @param attempts The failed reads in a row, at least 1.
+ * @return Uint64 The wait in performance counter ticks.
+ */
+static Uint64 retry_delay(int attempts) {
+    double delay = CHUNK_RETRY_DELAY;
+    for(int i = 1; i < attempts && delay < CHUNK_RETRY_MAX_DELAY; i++) delay *= 2;
+    if(delay > CHUNK_RETRY_MAX_DELAY) delay = CHUNK_RETRY_MAX_DELAY;
+    return (Uint64) (delay * SDL_GetPerformanceFrequency() / 1000);
+}
+
+/**
+ * Loader thread: frees the data of evicted chunks, then takes the most urgent queued chunk,
+ * reads it without holding the lock and installs it. A chunk whose file exists but cannot
+ * be read is reported and marked failed, to be read again after a growing delay.
+ *
+ * @param data The streamer.
+ * @return int Always 0.
+ */
+static int loader_thread(void* data) {
+    struct chunk_streamer* streamer = data;
+
+    SDL_LockMutex(streamer->lock);
+    while(atomic_load(&streamer->running)) {
+        if(streamer->retired_count > 0) {
+            struct chunk retired = streamer->retired[--streamer->retired_count];
+            SDL_UnlockMutex(streamer->lock);
+            chunk_free(&retired);
+            SDL_LockMutex(streamer->lock);
+            continue;
+        }
+        if(streamer->queue_count == 0) {
+            SDL_CondWait(streamer->wake, streamer->lock);
+            continue;
+        }
+
+        int slot = streamer->queue[0];
+        streamer->queue_count--;
+        memmove(streamer->queue, streamer->queue + 1, sizeof(int) * streamer->queue_count);
+
+        struct chunk* target = &streamer->slots[slot];
+        struct chunk loaded = { 0 };
+        loaded.cx = target->cx;
+        loaded.cy = target->cy;
+        target->state = CHUNK_LOADING;
+        SDL_UnlockMutex(streamer->lock);
+
+        int error = chunk_read(streamer->directory, &loaded);
+        if(error < 0)
+            fprintf(stderr, "Error reading chunk %d_%d from %s; falling back to the sections until it loads.\n",
+                loaded.cx, loaded.cy, streamer->directory);
+
+        SDL_LockMutex(streamer->lock);
+        if(error > 0) {
+            target->state = CHUNK_MISSING;
+            streamer->metrics.missing++;
+            continue;
+        }
+        if(error < 0) {
+            target->attempts++;
+            target->retry_at = SDL_GetPerformanceCounter() + retry_delay(target->attempts);
+            target->state = CHUNK_FAILED;
+            streamer->metrics.failures++;
+            continue;
+        }
+
+        double latency = (double) (SDL_GetPerformanceCounter() - target->requested_at) * 1000 / SDL_GetPerformanceFrequency();
+        target->wall_count = loaded.wall_count;
+        target->walls = loaded.walls;
+        target->grid = loaded.grid;
+        target->bytes = loaded.bytes;
+        target->attempts = 0;
+        target->state = CHUNK_READY;
+
+        struct chunk_metrics* metrics = &streamer->metrics;
+        metrics->loads++;
+        metrics->total_latency += latency;
+        if(latency > metrics->max_latency) metrics->max_latency = latency;
+        metrics->resident_bytes += loaded.bytes;
+        if(metrics->resident_bytes > metrics->peak_bytes) metrics->peak_bytes = metrics->resident_bytes;
+    }
+    SDL_UnlockMutex(streamer->lock);
+
+    return 0;
+}
+
+/**
+ * Starts the loader thread with no chunk resident.
+ *
+ * @param streamer The streamer to start.
+ * @param directory The directory holding the chunk files.
+ * @return int 0 if the streamer was started, or 1 if an error occurred or the directory
+ *             holds no chunks exported from the walls of the map table.
+ */
+int chunk_streamer_start(struct chunk_streamer* streamer, const char* directory) {
+    int wall_count;
+    if(chunk_index_check(directory, &wall_count)) return 1;
+
+    memset(streamer, 0, sizeof(struct chunk_streamer));
+    streamer->directory = directory;
+    streamer->wall_count = wall_count;
+    for(int i = 0; i < CHUNK_SLOTS; i++) streamer->slots[i].state = CHUNK_EMPTY;
+
+    streamer->lock = SDL_CreateMutex();
+    streamer->wake = SDL_CreateCond();
+    if(streamer->lock == NULL || streamer->wake == NULL) {
+        if(streamer->wake != NULL) SDL_DestroyCond(streamer->wake);
+        if(streamer->lock != NULL) SDL_DestroyMutex(streamer->lock);
+        return 1;
+    }
+
+    atomic_init(&streamer->running, TRUE);
+    streamer->thread = SDL_CreateThread(loader_thread, "chunk loader", streamer);
+    if(streamer->thread == NULL) {
+        fprintf(stderr, "Error starting chunk loader: %s\n", SDL_GetError());
+        SDL_DestroyCond(streamer->wake);
+        SDL_DestroyMutex(streamer->lock);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Hands the data of a resident chunk to the loader thread to free, and returns its slot to the pool.
+ * Called with the lock held.
+ *
+ * @param streamer The streamer.
+ * @param chunk The chunk to evict.
+ */
+static void evict(struct chunk_streamer* streamer, struct chunk* chunk) {
+    streamer->metrics.resident_bytes -= chunk->bytes;
+    streamer->metrics.evictions++;
+
+    // A slot is only refilled by the loader, which frees the retired data first, so at most
+    // one retired entry per slot is pending; the fallback frees on the spot
+    if(streamer->retired_count < CHUNK_SLOTS) {
+        streamer->retired[streamer->retired_count++] = *chunk;
+        chunk_reset(chunk);
+    } else {
+        chunk_free(chunk);
+    }
+    chunk->state = CHUNK_EMPTY;
+}
+
+/**
+ * Finds the least recently used resident chunk outside the loading area. Called with the lock held.
+ *
+ * @param streamer The streamer.
+ * @return struct chunk* The chunk, or NULL if every resident chunk is needed.
+ */
+static struct chunk* least_recently_used(struct chunk_streamer* streamer) {
+    struct chunk* oldest = NULL;
+    for(int i = 0; i < CHUNK_SLOTS; i++) {
+        struct chunk* chunk = &streamer->slots[i];
+        if(chunk->state == CHUNK_READY && !chunk->desired && (oldest == NULL || chunk->last_used < oldest->last_used))
+            oldest = chunk;
+    }
+    return oldest;
+}
+
+/**
+ * Queues a chunk slot for the loader thread. Called with the lock held.
+ *
+ * @param streamer The streamer.
+ * @param chunk The slot, with its chunk coordinates set.
+ */
+static void enqueue(struct chunk_streamer* streamer, struct chunk* chunk) {
+    chunk->state = CHUNK_QUEUED;
+    chunk->requested_at = SDL_GetPerformanceCounter();
+    streamer->queue[streamer->queue_count++] = chunk - streamer->slots;
+}
+
+/**
+ * Marks one chunk as needed: counts a hit if it is resident, otherwise queues it
+ * (reusing a free slot, or evicting the least recently used chunk if none is free).
+ * A chunk that failed to load is queued again once its retry delay has passed.
+ * Called with the lock held.
+ *
+ * @param streamer The streamer.
+ * @param cx The chunk column.
+ * @param cy The chunk row.
+ */
+static void request(struct chunk_streamer* streamer, int cx, int cy) {
+    struct chunk* free_slot = NULL;
+
+    for(int i = 0; i < CHUNK_SLOTS; i++) {
+        struct chunk* chunk = &streamer->slots[i];
+        if(chunk->state != CHUNK_EMPTY && chunk->cx == cx && chunk->cy == cy) {
+            if(chunk->desired) return; // Already counted this update (both areas overlap)
+            chunk->desired = TRUE;
+            chunk->last_used = streamer->update;
+            if(chunk->state == CHUNK_READY) streamer->metrics.hits++;
+            else if(chunk->state != CHUNK_MISSING) streamer->metrics.misses++;
+            if(chunk->state == CHUNK_FAILED && SDL_GetPerformanceCounter() >= chunk->retry_at) enqueue(streamer, chunk);
+            return;
+        }
+        int unused = chunk->state == CHUNK_MISSING || chunk->state == CHUNK_FAILED;
+        if(free_slot == NULL && (chunk->state == CHUNK_EMPTY || (unused && !chunk->desired)))
+            free_slot = chunk;
+    }
+
+    streamer->metrics.misses++;
+    if(free_slot == NULL) {
+        free_slot = least_recently_used(streamer);
+        if(free_slot == NULL) return; // Every slot is needed: try again next update
+        evict(streamer, free_slot);
+    }
+
+    free_slot->cx = cx;
+    free_slot->cy = cy;
+    free_slot->desired = TRUE;
+    free_slot->last_used = streamer->update;
+    free_slot->attempts = 0;
+    enqueue(streamer, free_slot);
+}
+
+/**
+ * Requests the chunks within CHUNK_LOAD_RADIUS of a chunk, ring by ring from the center.
+ * Called with the lock held.
+ *
+ * @param streamer The streamer.
+ * @param cx The column of the center chunk.
+ * @param cy The row of the center chunk.
+ */
+static void request_area(struct chunk_streamer* streamer, int cx, int cy) {
+    for(int ring = 0; ring <= CHUNK_LOAD_RADIUS; ring++)
+        for(int dy = -ring; dy <= ring; dy++)
+            for(int dx = -ring; dx <= ring; dx++)
+                if(abs(dx) == ring || abs(dy) == ring) request(streamer, cx + dx, cy + dy);
+}
+
+/**
+ * Requests the chunks within CHUNK_LOAD_RADIUS of the player and of where its velocity
+ * takes it within CHUNK_LOOKAHEAD seconds, nearest first, and evicts the least recently
+ * used chunks outside that area while the memory cap is exceeded. Never waits for I/O.
+ *
+ * @param streamer The streamer.
+ * @param x The x-coordinate of the player.
+ * @param y The y-coordinate of the player.
+ * @param velocity The velocity of the player.
+ */
+void chunk_streamer_update(struct chunk_streamer* streamer, double x, double y, const double velocity[2]) {
+    SDL_LockMutex(streamer->lock);
+    streamer->update++;
+    for(int i = 0; i < CHUNK_SLOTS; i++) streamer->slots[i].desired = FALSE;
+
+    request_area(streamer, chunk_coordinate(x), chunk_coordinate(y));
+    request_area(streamer, chunk_coordinate(x + velocity[0] * CHUNK_LOOKAHEAD), chunk_coordinate(y + velocity[1] * CHUNK_LOOKAHEAD));
+
+    // Drop queued chunks the player moved away from before they were loaded
+    int kept = 0;
+    for(int i = 0; i < streamer->queue_count; i++) {
+        struct chunk* chunk = &streamer->slots[streamer->queue[i]];
+        if(chunk->desired) {
+            streamer->queue[kept++] = streamer->queue[i];
+        } else {
+            chunk->state = CHUNK_EMPTY;
+            streamer->metrics.cancels++;
+        }
+    }
+    streamer->queue_count = kept;
+
+    // Out-of-range chunks stay cached until the memory cap is exceeded
+    while(streamer->metrics.resident_bytes > CHUNK_MEMORY_CAP) {
+        struct chunk* oldest = least_recently_used(streamer);
+        if(oldest == NULL) break;
+        evict(streamer, oldest);
+    }
+
+    if(streamer->queue_count > 0 || streamer->retired_count > 0) SDL_CondSignal(streamer->wake);
+    SDL_UnlockMutex(streamer->lock);
+}
+
+/**
+ * Collects the broad-phase grids of the chunks within CHUNK_LOAD_RADIUS of a point, once
+ * all of them are resident (chunks without a file hold no walls and are skipped). A chunk
+ * whose file could not be read keeps the area incomplete, so callers fall back to the sections.
+ * The grids stay valid until the next chunk_streamer_update, which must be called from
+ * the same thread or kept from running meanwhile (the game holds the world lock).
+ *
+ * @param streamer The streamer.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @param grids The grids (output, CHUNK_AREA at most).
+ * @return int The number of grids, or -1 if a chunk of the area is not resident yet or failed to load.
+ */
+int chunk_streamer_gather(struct chunk_streamer* streamer, double x, double y, const struct wall_grid** grids) {
+    int center[2] = { chunk_coordinate(x), chunk_coordinate(y) };
+    int count = 0, complete = TRUE;
+
+    SDL_LockMutex(streamer->lock);
+    for(int dy = -CHUNK_LOAD_RADIUS; dy <= CHUNK_LOAD_RADIUS && complete; dy++) {
+        for(int dx = -CHUNK_LOAD_RADIUS; dx <= CHUNK_LOAD_RADIUS && complete; dx++) {
+            const struct chunk* found = NULL;
+            for(int i = 0; i < CHUNK_SLOTS && found == NULL; i++) {
+                const struct chunk* chunk = &streamer->slots[i];
+                if(chunk->cx == center[0] + dx && chunk->cy == center[1] + dy
+                    && (chunk->state == CHUNK_READY || chunk->state == CHUNK_MISSING))
+                    found = chunk;
+            }
+
+            if(found == NULL) complete = FALSE; // Queued, loading or failed
+            else if(found->state == CHUNK_READY) grids[count++] = &found->grid;
+        }
+    }
+    SDL_UnlockMutex(streamer->lock);
+
+    return complete ? count : -1;
+}
+
+/**
+ * Stops the loader thread, frees every chunk and prints the metrics.
+ *
+ * @param streamer The streamer to stop.
+ */
+void chunk_streamer_stop(struct chunk_streamer* streamer) {
+    SDL_LockMutex(streamer->lock);
+    atomic_store(&streamer->running, FALSE);
+    SDL_CondSignal(streamer->wake);
+    SDL_UnlockMutex(streamer->lock);
+    SDL_WaitThread(streamer->thread, NULL);
+
+    struct chunk_metrics* metrics = &streamer->metrics;
+    fprintf(stderr, "Chunks: %lu hits, %lu misses, %lu loaded (%.2f ms average, %.2f ms max), "
+        "%lu missing, %lu failed, %lu evicted, %lu cancelled, %zu bytes peak.\n",
+        metrics->hits, metrics->misses, metrics->loads,
+        metrics->loads > 0 ? metrics->total_latency / metrics->loads : 0, metrics->max_latency,
+        metrics->missing, metrics->failures, metrics->evictions, metrics->cancels, metrics->peak_bytes);
+
+    for(int i = 0; i < CHUNK_SLOTS; i++) chunk_free(&streamer->slots[i]);
+    for(int i = 0; i < streamer->retired_count; i++) chunk_free(&streamer->retired[i]);
+    SDL_DestroyCond(streamer->wake);
+    SDL_DestroyMutex(streamer->lock);
+}
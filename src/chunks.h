@@ -0,0 +1,141 @@
+#ifndef CHUNKS_H
+#define CHUNKS_H
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include <SDL2/SDL.h>
+
+#include "constants.h"
+#include "grid.h"
+
+// Number of chunks within CHUNK_LOAD_RADIUS of a chunk, itself included
+#define CHUNK_AREA ((2 * CHUNK_LOAD_RADIUS + 1) * (2 * CHUNK_LOAD_RADIUS + 1))
+
+// Number of chunk slots: enough for two loading areas and the chunks kept under the memory cap
+#define CHUNK_SLOTS (2 * CHUNK_AREA + 32)
+
+// Lifecycle of a chunk slot
+enum chunk_state {
+    CHUNK_EMPTY,    // Slot unused
+    CHUNK_QUEUED,   // Waiting for the loader thread
+    CHUNK_LOADING,  // Being read by the loader thread
+    CHUNK_READY,    // Resident: walls and grid may be used
+    CHUNK_MISSING,  // No file for this chunk (kept so it is not requested again every frame)
+    CHUNK_FAILED    // File unreadable or out of memory: read again once retry_at is reached
+};
+
+/*
+    Square piece of the world, CHUNK_SIZE units wide, with its own walls and broad-phase grid.
+    Chunk (cx, cy) covers [cx * CHUNK_SIZE, (cx + 1) * CHUNK_SIZE] along x, and likewise along y;
+    a wall is stored in every chunk it crosses, so a chunk holds every wall within its square.
+    Section doors are not exported: the player changes sections through the level even while streaming.
+*/
+struct chunk {
+    int cx;                 // Chunk column
+    int cy;                 // Chunk row
+    enum chunk_state state; // Lifecycle state, guarded by the streamer lock
+    int desired;            // 1 if the chunk is within the radius of the player or its predicted position
+
+    int wall_count;         // Number of walls
+    double (*walls)[7];     // Walls laid out like the map table rows
+    struct wall_grid grid;  // Broad-phase index over walls (rows of this chunk's table)
+    size_t bytes;           // Memory held by the chunk's data
+
+    Uint64 requested_at;    // Performance counter when the chunk was requested
+    unsigned long last_used;// Last update that needed the chunk
+    int attempts;           // Failed reads in a row
+    Uint64 retry_at;        // Performance counter before which a failed chunk is not read again
+};
+
+// Counters reported by the streamer
+struct chunk_metrics {
+    unsigned long hits;         // Needed chunks found resident
+    unsigned long misses;       // Needed chunks not resident yet
+    unsigned long loads;        // Chunks loaded
+    unsigned long missing;      // Chunks without a file
+    unsigned long failures;     // Failed reads of existing chunk files (truncated, corrupt, out of memory)
+    unsigned long evictions;    // Chunks evicted over the memory cap
+    unsigned long cancels;      // Queued chunks dropped before loading because no longer needed
+    double total_latency;       // Sum of request-to-ready times (milliseconds)
+    double max_latency;         // Longest request-to-ready time (milliseconds)
+    size_t resident_bytes;      // Memory held by resident chunks
+    size_t peak_bytes;          // Highest value of resident_bytes
+};
+
+/*
+    Keeps the chunks around the player resident, loading them on a background thread.
+    The render thread only posts requests and installs nothing itself, so it never waits for I/O;
+    it does not free evicted chunks either, so it never touches the heap.
+*/
+struct chunk_streamer {
+    const char* directory;              // Directory holding the chunk files
+    int wall_count;                     // Rows at the start of the map table exported into the chunks; later rows are in none
+    struct chunk slots[CHUNK_SLOTS];    // Chunk table
+    int queue[CHUNK_SLOTS];             // Slots waiting for the loader, most urgent first
+    int queue_count;                    // Number of entries in queue
+    struct chunk retired[CHUNK_SLOTS];  // Data of evicted chunks, freed by the loader rather than the render thread
+    int retired_count;                  // Number of entries in retired
+    unsigned long update;               // Number of updates so far
+    struct chunk_metrics metrics;       // Counters, guarded by lock
+
+    SDL_mutex* lock;                    // Guards the slots' states, the queue, the retired data and the metrics
+    SDL_cond* wake;                     // Signaled when the queue or the retired data grow, or the streamer stops
+    SDL_Thread* thread;                 // The loader thread
+    atomic_int running;                 // Cleared to stop the loader thread
+};
+
+/**
+ * Writes the walls of the map table into one file per chunk they cross: a wall crossing
+ * a chunk border is stored in every chunk it crosses. An index file records the exported
+ * walls, so the game only streams chunks cut from its own map.
+ *
+ * @param directory The existing directory to write into.
+ * @return int The number of chunk files written, or -1 if an error occurred.
+ */
+int chunk_export(const char* directory);
+
+/**
+ * Starts the loader thread with no chunk resident.
+ *
+ * @param streamer The streamer to start.
+ * @param directory The directory holding the chunk files.
+ * @return int 0 if the streamer was started, or 1 if an error occurred or the directory
+ *             holds no chunks exported from the walls of the map table.
+ */
+int chunk_streamer_start(struct chunk_streamer* streamer, const char* directory);
+
+/**
+ * Requests the chunks within CHUNK_LOAD_RADIUS of the player and of where its velocity
+ * takes it within CHUNK_LOOKAHEAD seconds, nearest first, and evicts the least recently
+ * used chunks outside that area while the memory cap is exceeded. Never waits for I/O.
+ *
+ * @param streamer The streamer.
+ * @param x The x-coordinate of the player.
+ * @param y The y-coordinate of the player.
+ * @param velocity The velocity of the player.
+ */
+void chunk_streamer_update(struct chunk_streamer* streamer, double x, double y, const double velocity[2]);
+
+/**
+ * Collects the broad-phase grids of the chunks within CHUNK_LOAD_RADIUS of a point, once
+ * all of them are resident (chunks without a file hold no walls and are skipped). A chunk
+ * whose file could not be read keeps the area incomplete, so callers fall back to the sections.
+ * The grids stay valid until the next chunk_streamer_update, which must be called from
+ * the same thread or kept from running meanwhile (the game holds the world lock).
+ *
+ * @param streamer The streamer.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @param grids The grids (output, CHUNK_AREA at most).
+ * @return int The number of grids, or -1 if a chunk of the area is not resident yet or failed to load.
+ */
+int chunk_streamer_gather(struct chunk_streamer* streamer, double x, double y, const struct wall_grid** grids);
+
+/**
+ * Stops the loader thread, frees every chunk and prints the metrics.
+ *
+ * @param streamer The streamer to stop.
+ */
+void chunk_streamer_stop(struct chunk_streamer* streamer);
+
+#endif
@@ -0,0 +1,221 @@
+#include <math.h>
+#include <stddef.h>
+
+#include "constants.h"
+#include "map.h"
+#include "collision.h"
+
+/**
+ * Returns the point of a wall closest to a point.
+ * 
+ * @param wall The wall, as a row of its table.
+ * @param p The point.
+ * @return struct point The closest point of the wall.
+ */
+static struct point closest_on_wall(const double* wall, struct point p) {
+    double ax = wall[0], ay = wall[1];
+    double dx = wall[2] - ax, dy = wall[3] - ay;
+    double length2 = dx*dx + dy*dy;
+    double t = length2 > 0 ? ((p.x - ax) * dx + (p.y - ay) * dy) / length2 : 0;
+    t = fmin(fmax(t, 0), 1);
+
+    struct point closest = { ax + t * dx, ay + t * dy };
+    return closest;
+}
+
+/**
+ * Computes the earliest time a moving circle touches a circle of the same radius around a point.
+ * 
+ * @param start The center of the moving circle at t = 0.
+ * @param move The displacement of the center between t = 0 and t = 1.
+ * @param cx The x-coordinate of the point to avoid.
+ * @param cy The y-coordinate of the point to avoid.
+ * @param radius The radius of the circle.
+ * @return double The time of impact in [0, 1], or INFINITY if there is none.
+ */
+static double corner_time_of_impact(struct point start, double move[2], double cx, double cy, double radius) {
+    double m[2] = { start.x - cx, start.y - cy };
+    double a = move[0]*move[0] + move[1]*move[1];
+    double b = 2 * (m[0]*move[0] + m[1]*move[1]);
+    double c = m[0]*m[0] + m[1]*m[1] - radius*radius;
+
+    if(a == 0 || b >= 0) return INFINITY; // Not moving, or moving away
+    double discriminant = b*b - 4*a*c;
+    if(discriminant < 0) return INFINITY;
+
+    double t = (-b - sqrt(discriminant)) / (2*a);
+    return t >= 0 && t <= 1 ? t : INFINITY;
+}
+
+/**
+ * Computes the earliest time a moving circle touches a wall.
+ * The swept volume of the wall is its two faces offset by the radius plus a circle at each end.
+ * 
+ * @param wall The wall, as a row of its table.
+ * @param start The center of the circle at t = 0.
+ * @param move The displacement of the center between t = 0 and t = 1.
+ * @param radius The radius of the circle.
+ * @return double The time of impact in [0, 1], or INFINITY if there is none.
+ */
+static double wall_time_of_impact(const double* wall, struct point start, double move[2], double radius) {
+    double ax = wall[0], ay = wall[1];
+    double dx = wall[2] - ax, dy = wall[3] - ay;
+    double length = sqrt(dx*dx + dy*dy);
+    double best = INFINITY;
+
+    if(length > 0) {
+        double normal[2] = { -dy / length, dx / length };
+        double distance = (start.x - ax) * normal[0] + (start.y - ay) * normal[1];
+        double side = distance < 0 ? -1 : 1;
+        double approach = -side * (move[0] * normal[0] + move[1] * normal[1]);
+
+        // Face hit: reach the offset line while still within the wall's extent
+        if(approach > 0 && fabs(distance) >= radius) {
+            double t = (fabs(distance) - radius) / approach;
+            if(t <= 1) {
+                double px = start.x + t * move[0] - ax, py = start.y + t * move[1] - ay;
+                double along = (px * dx + py * dy) / (length * length);
+                if(along >= 0 && along <= 1) best = t;
+            }
+        }
+    }
+
+    best = fmin(best, corner_time_of_impact(start, move, wall[0], wall[1], radius));
+    best = fmin(best, corner_time_of_impact(start, move, wall[2], wall[3], radius));
+    return best;
+}
+
+/**
+ * Pushes a circle out of every wall it overlaps.
+ * 
+ * @param walls The candidate walls, as rows of their tables.
+ * @param count The number of candidate walls.
+ * @param center The center of the circle, updated in place.
+ * @param radius The radius of the circle.
+ */
+static void depenetrate(const double* const* walls, int count, struct point* center, double radius) {
+    for(int i = 0; i < count; i++) {
+        struct point closest = closest_on_wall(walls[i], *center);
+        double away[2] = { center->x - closest.x, center->y - closest.y };
+        double distance = abs_vector2(away);
+        if(distance >= radius || distance == 0) continue;
+
+        double push = radius + COLLISION_SKIN - distance;
+        center->x += away[0] / distance * push;
+        center->y += away[1] / distance * push;
+    }
+}
+
+/**
+ * Lists the walls of several grids whose cells overlap a box, and a list of map walls.
+ * A wall stored in several grids is listed once per grid.
+ * 
+ * @param grids The grids.
+ * @param grid_count The number of grids.
+ * @param extra The map table rows of walls listed whatever the box, or NULL.
+ * @param extra_count The number of rows in extra.
+ * @param box The box as {min_x, min_y, max_x, max_y}.
+ * @param walls The walls found, as rows of their tables (output, COLLISION_MAX_WALLS at most).
+ * @return int The number of walls found.
+ */
+static int gather_walls(const struct wall_grid* const* grids, int grid_count, const int* extra, int extra_count,
+    const double box[4], const double** walls) {
+    static int ids[COLLISION_MAX_WALLS]; // Only ever used by the simulation thread
+    int count = 0;
+
+    for(int g = 0; g < grid_count; g++) {
+        int found = grid_query_box(grids[g], box[0], box[1], box[2], box[3], ids, COLLISION_MAX_WALLS - count);
+        for(int i = 0; i < found; i++) walls[count++] = &grids[g]->table[7 * ids[i]];
+    }
+    for(int i = 0; i < extra_count && count < COLLISION_MAX_WALLS; i++) walls[count++] = map[extra[i]];
+
+    return count;
+}
+
+/**
+ * Moves a circle from a start point towards a desired point, stopping at walls and
+ * sliding along them. The whole path is swept, so no wall is skipped however long
+ * the step is. Candidate walls come from the grid within the move's length of the
+ * start, which holds every wall the slides can reach.
+ * 
+ * @param grid The grid indexing the walls to collide with.
+ * @param start The center of the circle before the move.
+ * @param desired The center the circle is trying to reach.
+ * @param radius The radius of the circle.
+ * @return struct point The center of the circle after the move.
+ */
+struct point collide_and_slide(const struct wall_grid* grid, struct point start, struct point desired, double radius) {
+    return collide_and_slide_grids(&grid, 1, NULL, 0, start, desired, radius);
+}
+
+/**
+ * Moves a circle like collide_and_slide, against the walls of several grids, each over its
+ * own table (e.g. the chunks around the player), and against map walls listed apart
+ * (e.g. door panels, which move and so are in no chunk).
+ * 
+ * @param grids The grids indexing the walls to collide with.
+ * @param grid_count The number of grids.
+ * @param extra The map table rows of further walls to collide with, or NULL.
+ * @param extra_count The number of rows in extra.
+ * @param start The center of the circle before the move.
+ * @param desired The center the circle is trying to reach.
+ * @param radius The radius of the circle.
+ * @return struct point The center of the circle after the move.
+ */
+struct point collide_and_slide_grids(const struct wall_grid* const* grids, int grid_count, const int* extra, int extra_count,
+    struct point start, struct point desired, double radius) {
+    static const double* walls[COLLISION_MAX_WALLS]; // Only ever used by the simulation thread
+    struct point position = start;
+    double move[2] = { desired.x - start.x, desired.y - start.y };
+
+    // Walls the circle overlaps push it out before it moves
+    double margin = radius + COLLISION_SKIN;
+    double near_box[4] = { start.x - margin, start.y - margin, start.x + margin, start.y + margin };
+    int count = gather_walls(grids, grid_count, extra, extra_count, near_box, walls);
+    depenetrate(walls, count, &position, radius);
+
+    // Broad phase: each slide only shortens the remaining move, so the whole path, slides
+    // included, stays within the move's length of where it starts
+    double reach = abs_vector2(move) + margin;
+    double reach_box[4] = { position.x - reach, position.y - reach, position.x + reach, position.y + reach };
+    count = gather_walls(grids, grid_count, extra, extra_count, reach_box, walls);
+
+    for(int iteration = 0; iteration < COLLISION_ITERATIONS; iteration++) {
+        double first_time = INFINITY;
+        const double* first_wall = NULL;
+        for(int i = 0; i < count; i++) {
+            double t = wall_time_of_impact(walls[i], position, move, radius);
+            if(t < first_time) {
+                first_time = t;
+                first_wall = walls[i];
+            }
+        }
+
+        if(first_wall == NULL) { // Free path
+            position.x += move[0];
+            position.y += move[1];
+            return position;
+        }
+
+        // Advance to the contact, stopping a skin width short of the wall
+        double move_length = abs_vector2(move);
+        double back_off = move_length > 0 ? fmin(first_time, COLLISION_SKIN / move_length) : 0;
+        position.x += move[0] * (first_time - back_off);
+        position.y += move[1] * (first_time - back_off);
+
+        // Slide: drop the part of the remaining move that goes into the wall
+        struct point contact = closest_on_wall(first_wall, position);
+        double normal[2] = { position.x - contact.x, position.y - contact.y };
+        normalize_vector2(normal);
+        double remaining = 1 - first_time + back_off;
+        move[0] *= remaining;
+        move[1] *= remaining;
+        double into = move[0] * normal[0] + move[1] * normal[1];
+        if(into < 0) {
+            move[0] -= into * normal[0];
+            move[1] -= into * normal[1];
+        }
+    }
+
+    return position; // Out of iterations (wedged in a corner): stay at the last contact
+}
@@ -0,0 +1,38 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "algebra.h"
+#include "grid.h"
+
+/**
+ * Moves a circle from a start point towards a desired point, stopping at walls and
+ * sliding along them. The whole path is swept, so no wall is skipped however long
+ * the step is. Candidate walls come from the grid within the move's length of the
+ * start, which holds every wall the slides can reach.
+ * 
+ * @param grid The grid indexing the walls to collide with.
+ * @param start The center of the circle before the move.
+ * @param desired The center the circle is trying to reach.
+ * @param radius The radius of the circle.
+ * @return struct point The center of the circle after the move.
+ */
+struct point collide_and_slide(const struct wall_grid* grid, struct point start, struct point desired, double radius);
+
+/**
+ * Moves a circle like collide_and_slide, against the walls of several grids, each over its
+ * own table (e.g. the chunks around the player), and against map walls listed apart
+ * (e.g. door panels, which move and so are in no chunk).
+ * 
+ * @param grids The grids indexing the walls to collide with.
+ * @param grid_count The number of grids.
+ * @param extra The map table rows of further walls to collide with, or NULL.
+ * @param extra_count The number of rows in extra.
+ * @param start The center of the circle before the move.
+ * @param desired The center the circle is trying to reach.
+ * @param radius The radius of the circle.
+ * @return struct point The center of the circle after the move.
+ */
+struct point collide_and_slide_grids(const struct wall_grid* const* grids, int grid_count, const int* extra, int extra_count,
+    struct point start, struct point desired, double radius);
+
+#endif
@@ -32,14 +32,65 @@ typedef enum {
 #define PLAYER_JUMP_VELOCITY 0;  // Initial vertical velocity for jumping (currently unused)
 #define GRAVITY_ACCELERATION 550;// Gravitational pull, affecting jump mechanics
 
+// Simulation
+#define SIM_TICK_RATE 120        // Simulation ticks per second, independent of the frame rate
+#define MAX_DELTA_TIME 0.1       // Longest step simulated at once (seconds)
+
+// Entities
+#define ENTITY_CHUNK_SIZE 4096   // Entities integrated per parallel job chunk
+#define ENTITY_MAX_TURN_STEP 0.5 // Largest turn (radians) applied to an entity in one update; longer turns are clamped
+#define LOS_CHUNK_SIZE 1024      // Line-of-sight queries answered per parallel job chunk (multiple of 32)
+
+// Sliding doors
+#define DOOR_TRIGGER_DISTANCE 60 // Distance (units) from a door's center within which it opens
+#define DOOR_SPEED 2             // Openness gained or lost per second (1 = fully open)
+
+// Map simplification
+#define MAP_MERGE_EPSILON 1e-6   // Distance (units) under which wall endpoints and lines are considered equal
+
+// World streaming
+#define CHUNK_DIR "chunks"       // Directory of the chunk files written by chunks.out
+#define CHUNK_SIZE 256           // Width and height of a chunk (units)
+#define CHUNK_LOAD_RADIUS ((VIEW_DISTANCE + CHUNK_SIZE - 1) / CHUNK_SIZE) // Chunks kept loaded on each side of the player's chunk, enough to see VIEW_DISTANCE away
+#define CHUNK_LOOKAHEAD 1.5      // Seconds of movement predicted to request chunks early
+#define CHUNK_MEMORY_CAP (4 << 20) // Bytes of chunk data above which chunks out of range are evicted
+#define CHUNK_RETRY_DELAY 250    // Milliseconds before a chunk that failed to load is read again, doubled after each failure
+#define CHUNK_RETRY_MAX_DELAY 8000 // Longest wait between two reads of a failing chunk (milliseconds)
+
+// Collision
+#define GRID_CELL_SIZE 50        // Size of a broad-phase grid cell (units)
+#define COLLISION_SKIN 0.01      // Gap kept between the player and the walls it touches (units)
+#define COLLISION_ITERATIONS 4   // Slides resolved per step before the player stops
+#define COLLISION_MAX_WALLS 1024 // Candidate walls of one move, over every grid it is checked against
+
 // Raycasting constants
 #define RAYS_NUMBER (WINDOW_WIDTH)  // Number of rays cast, typically equal to screen width
+#define VIEW_DISTANCE 600           // Distance (units) at which walls have faded to their dimmest
+#define RAY_PACKET_SIZE 8           // Adjacent rays traced together by the packet kernel (at most RAY_PACKET_MAX)
+#define ADAPTIVE_STEP 16            // Columns between two initial samples of the adaptive kernel
+#define ADAPTIVE_DISTANCE_JUMP 20   // Distance difference (units) above which two samples on one wall are refined
+#define SPAN_NEAR_PLANE 0.01        // Depth (units) in front of the camera where the span engine clips walls
+#define QUANTIZED_MIN_STEP (1.0 / 256) // Finest quantization step of compact walls (units)
+#define QUANTIZED_MAX_STEP (1.0 / 16)  // Coarsest step allowed before a wall set is kept in doubles (units)
 //#define FOV (3.5 * PI / 5)        // Alternative field of view
 #define FOV (PI / 3)                // Current field of view (60 degrees)
 //#define FOV (2*PI)                // Another alternative FOV covering a full 360 degrees
 
-// Rendering mode
-#define FIRST_PERSON 0            // Flag to enable first-person rendering mode
+// Rendering modes, cycled at runtime with M
+enum render_mode {
+    RENDER_FIRST_PERSON,    // Ray-cast 3D view over the whole window
+    RENDER_TOP_DOWN,        // Top-down map with the visible area
+    RENDER_SPLIT,           // 3D view on the left half, top-down map on the right half
+    RENDER_MODE_COUNT
+};
+#define START_RENDER_MODE RENDER_TOP_DOWN // Mode shown at startup
+
+// Top-down view navigation
+#define TOPDOWN_PAN_STEP 20      // Pixels panned per arrow key press
+#define TOPDOWN_ZOOM_STEP 1.1    // Zoom multiplier per mouse wheel step
+#define TOPDOWN_MIN_ZOOM 0.25    // Smallest zoom (screen pixels per world unit)
+#define TOPDOWN_MAX_ZOOM 8       // Largest zoom (screen pixels per world unit)
+#define VISIBILITY_RADIUS 2000   // Half-width of the square bounding the visible area (units)
 
 // Mouse sensitivity for camera movement
 #define MOUSE_SENSITIVITY 2       // Multiplier for mouse movement
@@ -47,5 +98,17 @@ typedef enum {
 // Environment size constants
 #define FLOOR_SIZE (WINDOW_HEIGHT / 2) // Size of the floor area on the screen
 #define WALL_SIZE 50                   // Size of a wall in the environment (units)
+#define SKY_HILL_HEIGHT 64             // Height of the band of distant hills above the horizon (pixels)
+
+// Level data
+#define PVS_FILE "level1.pvs"          // Potentially visible sets of level 1, written by pvs.out
+
+// Memory accounting
+#define MEMORY_FRAME_CHECK FALSE       // Abort on any heap allocation or free inside a frame (debug)
+
+// Video streaming
+#define VIDEO_STREAM_ENV "RAYCASTER_STREAM" // Environment variable holding the stream destination
+#define VIDEO_QUEUE_SIZE 4                  // Recycled frame buffers between the render loop and the writer
+#define VIDEO_STREAM_FPS 60                 // Frame rate advertised in the Y4M header
 
 #endif
@@ -0,0 +1,129 @@
+#include <math.h>
+
+#include "constants.h"
+#include "doors.h"
+
+/**
+ * Adds a closed sliding door, inserting its panel as a wall of a section.
+ * The level keeps a reference to the doors, so removing walls keeps their panel rows valid.
+ * 
+ * @param doors The doors of the level.
+ * @param level The level.
+ * @param section The section the panel belongs to.
+ * @param closed The panel endpoints {x0, y0, xf, yf} when closed.
+ * @param open The panel endpoints when fully open.
+ * @param color The color of the panel as {r, g, b}.
+ * @return int 0 if the door was added, or 1 if an error occurred (no panel wall is left behind).
+ */
+int sliding_door_add(struct sliding_doors* doors, struct level* level, struct section* section,
+    const double closed[4], const double open[4], const double color[3]) {
+    if(doors->count == SLIDING_DOOR_MAX) return 1;
+
+    double wall[7] = { closed[0], closed[1], closed[2], closed[3], color[0], color[1], color[2] };
+    int row = level_add_wall(level, section, wall);
+    if(row < 0) return 1;
+
+    // Slide the panel open once, in steps shorter than a grid cell, and back: every cell it will
+    // cross gets room for it now, and cells never shrink, so moving it later never allocates
+    double travel = 0;
+    for(int k = 0; k < 4; k++) travel = fmax(travel, fabs(open[k] - closed[k]));
+    int steps = (int) ceil(travel * 2 / GRID_CELL_SIZE) + 1;
+    for(int step = 1; step <= steps; step++) {
+        double position[4];
+        for(int k = 0; k < 4; k++) position[k] = closed[k] + (open[k] - closed[k]) * step / steps;
+        if(level_move_wall(level, row, position)) {
+            level_remove_wall(level, row); // No door refers to the panel yet
+            return 1;
+        }
+    }
+    if(level_move_wall(level, row, closed)) {
+        level_remove_wall(level, row);
+        return 1;
+    }
+
+    struct sliding_door* door = &doors->doors[doors->count++];
+    for(int k = 0; k < 4; k++) {
+        door->closed[k] = closed[k];
+        door->open[k] = open[k];
+    }
+    door->row = row;
+    door->shown = 0;
+    level->doors = doors;
+    return 0;
+}
+
+/**
+ * Removes a sliding door and its panel wall. The doors after it move down one place,
+ * so arrays indexed by door (such as the openness) must drop the same entry.
+ * 
+ * @param doors The doors of the level.
+ * @param level The level.
+ * @param index The index of the door.
+ */
+void sliding_door_remove(struct sliding_doors* doors, struct level* level, int index) {
+    int row = doors->doors[index].row;
+    level->doors = doors;
+    level_remove_wall(level, row); // Drops the door through sliding_doors_wall_removed (panels are never streamed)
+}
+
+/**
+ * Keeps the doors in step with a wall removed from the map table: drops the door whose
+ * panel was at `row`, and renames the panel that moved from the last row `last` to `row`.
+ * Called by level_remove_wall.
+ * 
+ * @param doors The doors of the level.
+ * @param row The map table row of the removed wall.
+ * @param last The row the last wall of the table moved from.
+ */
+void sliding_doors_wall_removed(struct sliding_doors* doors, int row, int last) {
+    int kept = 0;
+    for(int i = 0; i < doors->count; i++) {
+        if(doors->doors[i].row == row) continue; // Its panel is gone
+        doors->doors[kept] = doors->doors[i];
+        if(doors->doors[kept].row == last) doors->doors[kept].row = row;
+        kept++;
+    }
+    doors->count = kept;
+}
+
+/**
+ * Opens the doors near a point and closes the others, at DOOR_SPEED. Called by the simulation.
+ * 
+ * @param doors The doors of the level.
+ * @param openness The openness of each door, from 0 (closed) to 1 (open), updated in place.
+ * @param x The x-coordinate of the player.
+ * @param y The y-coordinate of the player.
+ * @param delta_time The time step in seconds.
+ */
+void sliding_doors_step(const struct sliding_doors* doors, double* openness, double x, double y, double delta_time) {
+    for(int i = 0; i < doors->count; i++) {
+        const double* closed = doors->doors[i].closed;
+        double center_x = (closed[0] + closed[2]) / 2, center_y = (closed[1] + closed[3]) / 2;
+        int near = hypot(x - center_x, y - center_y) < DOOR_TRIGGER_DISTANCE;
+
+        openness[i] += (near ? DOOR_SPEED : -DOOR_SPEED) * delta_time;
+        openness[i] = fmax(0, fmin(1, openness[i]));
+    }
+}
+
+/**
+ * Moves the panels whose openness changed since they were last moved. Called by the renderer,
+ * with the simulation kept from reading the level.
+ * 
+ * @param doors The doors of the level.
+ * @param level The level.
+ * @param openness The openness of each door, from 0 (closed) to 1 (open).
+ * @return int 0 if the panels were moved, or 1 if an error occurred.
+ */
+int sliding_doors_apply(struct sliding_doors* doors, struct level* level, const double* openness) {
+    for(int i = 0; i < doors->count; i++) {
+        struct sliding_door* door = &doors->doors[i];
+        if(openness[i] == door->shown) continue; // Resting doors cost nothing
+
+        double position[4];
+        for(int k = 0; k < 4; k++) position[k] = door->closed[k] + (door->open[k] - door->closed[k]) * openness[i];
+        if(level_move_wall(level, door->row, position)) return 1;
+        door->shown = openness[i];
+    }
+    return 0;
+}
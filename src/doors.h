@@ -0,0 +1,85 @@
+#ifndef DOORS_H
+#define DOORS_H
+
+#include "levels.h"
+
+// Largest number of sliding doors in a level
+#define SLIDING_DOOR_MAX 8
+
+/*
+    Wall panel that slides open when the player comes near.
+    The simulation decides how far each door is open; the renderer moves the panels,
+    which only updates the grid cells and quantized walls the panel touches.
+*/
+struct sliding_door {
+    double closed[4];   // Panel endpoints {x0, y0, xf, yf} when closed
+    double open[4];     // Panel endpoints when fully open
+    int row;            // Map table row of the panel
+    double shown;       // Openness the panel was last moved to (render thread only)
+};
+
+// Sliding doors of a level; the positions are fixed once the simulation starts
+struct sliding_doors {
+    int count;                                  // Number of doors
+    struct sliding_door doors[SLIDING_DOOR_MAX];// The doors
+};
+
+/**
+ * Adds a closed sliding door, inserting its panel as a wall of a section.
+ * The level keeps a reference to the doors, so removing walls keeps their panel rows valid.
+ * 
+ * @param doors The doors of the level.
+ * @param level The level.
+ * @param section The section the panel belongs to.
+ * @param closed The panel endpoints {x0, y0, xf, yf} when closed.
+ * @param open The panel endpoints when fully open.
+ * @param color The color of the panel as {r, g, b}.
+ * @return int 0 if the door was added, or 1 if an error occurred (no panel wall is left behind).
+ */
+int sliding_door_add(struct sliding_doors* doors, struct level* level, struct section* section,
+    const double closed[4], const double open[4], const double color[3]);
+
+/**
+ * Removes a sliding door and its panel wall. The doors after it move down one place,
+ * so arrays indexed by door (such as the openness) must drop the same entry.
+ * 
+ * @param doors The doors of the level.
+ * @param level The level.
+ * @param index The index of the door.
+ */
+void sliding_door_remove(struct sliding_doors* doors, struct level* level, int index);
+
+/**
+ * Keeps the doors in step with a wall removed from the map table: drops the door whose
+ * panel was at `row`, and renames the panel that moved from the last row `last` to `row`.
+ * Called by level_remove_wall.
+ * 
+ * @param doors The doors of the level.
+ * @param row The map table row of the removed wall.
+ * @param last The row the last wall of the table moved from.
+ */
+void sliding_doors_wall_removed(struct sliding_doors* doors, int row, int last);
+
+/**
+ * Opens the doors near a point and closes the others, at DOOR_SPEED. Called by the simulation.
+ * 
+ * @param doors The doors of the level.
+ * @param openness The openness of each door, from 0 (closed) to 1 (open), updated in place.
+ * @param x The x-coordinate of the player.
+ * @param y The y-coordinate of the player.
+ * @param delta_time The time step in seconds.
+ */
+void sliding_doors_step(const struct sliding_doors* doors, double* openness, double x, double y, double delta_time);
+
+/**
+ * Moves the panels whose openness changed since they were last moved. Called by the renderer,
+ * with the simulation kept from reading the level.
+ * 
+ * @param doors The doors of the level.
+ * @param level The level.
+ * @param openness The openness of each door, from 0 (closed) to 1 (open).
+ * @return int 0 if the panels were moved, or 1 if an error occurred.
+ */
+int sliding_doors_apply(struct sliding_doors* doors, struct level* level, const double* openness);
+
+#endif
@@ -0,0 +1,192 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "constants.h"
+#include "entity.h"
+#include "memory.h"
+
+/**
+ * Allocates an empty store.
+ * 
+ * @param store The store to initialize.
+ * @param capacity The maximum number of entities.
+ * @return int 0 if the store was allocated, or 1 if an error occurred.
+ */
+int entity_store_init(struct entity_store* store, int capacity) {
+    store->count = 0;
+    store->capacity = capacity;
+    store->x = memory_alloc(MEMORY_ENTITIES, sizeof(double) * capacity);
+    store->y = memory_alloc(MEMORY_ENTITIES, sizeof(double) * capacity);
+    store->vx = memory_alloc(MEMORY_ENTITIES, sizeof(double) * capacity);
+    store->vy = memory_alloc(MEMORY_ENTITIES, sizeof(double) * capacity);
+    store->heading_x = memory_alloc(MEMORY_ENTITIES, sizeof(double) * capacity);
+    store->heading_y = memory_alloc(MEMORY_ENTITIES, sizeof(double) * capacity);
+    store->turn = memory_alloc(MEMORY_ENTITIES, sizeof(double) * capacity);
+    store->moves = memory_alloc(MEMORY_ENTITIES, capacity);
+
+    if(store->x == NULL || store->y == NULL || store->vx == NULL || store->vy == NULL
+        || store->heading_x == NULL || store->heading_y == NULL || store->turn == NULL || store->moves == NULL) {
+        entity_store_destroy(store);
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Adds an entity standing still.
+ * 
+ * @param store The store.
+ * @param x The x-coordinate of the entity.
+ * @param y The y-coordinate of the entity.
+ * @param angle The angle the entity faces (in radians).
+ * @return int The index of the new entity, or -1 if the store is full.
+ */
+int entity_spawn(struct entity_store* store, double x, double y, double angle) {
+    if(store->count == store->capacity) return -1;
+
+    int i = store->count++;
+    store->x[i] = x;
+    store->y[i] = y;
+    store->vx[i] = 0;
+    store->vy[i] = 0;
+    store->heading_x[i] = cos(angle);
+    store->heading_y[i] = sin(angle);
+    store->turn[i] = 0;
+    store->moves[i] = 0;
+    return i;
+}
+
+/**
+ * Returns the angle an entity faces.
+ * 
+ * @param store The store.
+ * @param index The index of the entity.
+ * @return double The angle, within [-PI, PI].
+ */
+double entity_angle(const struct entity_store* store, int index) {
+    return atan2(store->heading_y[index], store->heading_x[index]);
+}
+
+/**
+ * Integration kernel of entity_update_range over raw arrays.
+ * Restrict-qualified parameters tell the compiler the arrays never alias, so the loop
+ * vectorizes (GCC ignores restrict on local copies of the store's pointers).
+ * 
+ * @param x The x-coordinates.
+ * @param y The y-coordinates.
+ * @param vx The velocities along x.
+ * @param vy The velocities along y.
+ * @param hx The cosines of the angles.
+ * @param hy The sines of the angles.
+ * @param turn The rotation speeds.
+ * @param moves The movement flags.
+ * @param first The first entity to update.
+ * @param last One past the last entity to update.
+ * @param delta_time The time elapsed since the last update.
+ */
+static void integrate(double* restrict x, double* restrict y, double* restrict vx, double* restrict vy,
+    double* restrict hx, double* restrict hy, const double* restrict turn, const unsigned char* restrict moves,
+    int first, int last, double delta_time) {
+    for(int i = first; i < last; i++) {
+        // Turn: rotate the heading by the turn angle like rotate_vector2, with the sine and
+        // cosine from their Taylor series up to the 11th and 12th powers; for angles up to
+        // ENTITY_MAX_TURN_STEP (0.5) the dropped terms are below 0.5^13 / 13! < 2e-14.
+        // Then renormalize so rounding does not build up over many steps
+        double step = turn[i] * delta_time;
+        step = 0.5 * (fabs(step + ENTITY_MAX_TURN_STEP) - fabs(step - ENTITY_MAX_TURN_STEP)); // Clamp without branches
+        double t = step * step;
+        double s = step * (1 - t * (1.0 / 6) * (1 - t * (1.0 / 20) * (1 - t * (1.0 / 42)
+            * (1 - t * (1.0 / 72) * (1 - t * (1.0 / 110))))));
+        double c = 1 - t * 0.5 * (1 - t * (1.0 / 12) * (1 - t * (1.0 / 30) * (1 - t * (1.0 / 56)
+            * (1 - t * (1.0 / 90) * (1 - t * (1.0 / 132))))));
+        double nx = hx[i] * c - hy[i] * s;
+        double ny = hx[i] * s + hy[i] * c;
+        double inverse = 1 / sqrt(nx*nx + ny*ny);
+        hx[i] = nx * inverse;
+        hy[i] = ny * inverse;
+
+        // Forward and strafe axes from the flags, front over back and right over left like
+        // set_move_player; computed arithmetically so the loop has no branches
+        int up = (moves[i] & UP) != 0, down = (moves[i] & DOWN) != 0;
+        int right = (moves[i] & RIGHT) != 0, left = (moves[i] & LEFT) != 0;
+        double forward = up - (1 - up) * down;
+        double strafe = right - (1 - right) * left;
+
+        // The right of heading (c, s) is (-s, c), i.e. the direction at angle + PI/2
+        double mx = forward * hx[i] - strafe * hy[i];
+        double my = forward * hy[i] + strafe * hx[i];
+        // The tiny bias keeps (0, 0) at (0, 0) without a branch (fmax would block vectorization)
+        double scale = PLAYER_MOVE_SPEED / sqrt(mx*mx + my*my + 1e-18);
+        vx[i] = mx * scale;
+        vy[i] = my * scale;
+
+        x[i] += vx[i] * delta_time;
+        y[i] += vy[i] * delta_time;
+    }
+}
+
+/**
+ * Integrates entities [first, last): turns them by turn * delta_time, clamped to
+ * ENTITY_MAX_TURN_STEP, derives their velocity from their movement flags the way
+ * set_move_player does for the player, and moves them. Each turn is within 2e-14 radians
+ * of the requested angle.
+ * 
+ * @param store The store.
+ * @param first The first entity to update.
+ * @param last One past the last entity to update.
+ * @param delta_time The time elapsed since the last update.
+ */
+void entity_update_range(struct entity_store* store, int first, int last, double delta_time) {
+    integrate(store->x, store->y, store->vx, store->vy, store->heading_x, store->heading_y,
+        store->turn, store->moves, first, last, delta_time);
+}
+
+// Arguments of a parallel entity update
+struct entity_job {
+    struct entity_store* store; // The store to update
+    double delta_time;          // The time step
+};
+
+/**
+ * Job pool adapter for entity_update_range.
+ * 
+ * @param context The entity_job.
+ * @param first The first entity to update.
+ * @param last One past the last entity to update.
+ */
+static void entity_update_job(void* context, int first, int last) {
+    struct entity_job* job = context;
+    entity_update_range(job->store, first, last, job->delta_time);
+}
+
+/**
+ * Integrates every entity, in parallel chunks of ENTITY_CHUNK_SIZE on the pool.
+ * 
+ * @param store The store.
+ * @param pool The worker pool, or NULL to update on the calling thread.
+ * @param delta_time The time elapsed since the last update.
+ */
+void entity_update(struct entity_store* store, struct job_pool* pool, double delta_time) {
+    struct entity_job job = { store, delta_time };
+    jobs_parallel_for(pool, store->count, ENTITY_CHUNK_SIZE, entity_update_job, &job);
+}
+
+/**
+ * Frees every array of the store.
+ * 
+ * @param store The store to destroy.
+ */
+void entity_store_destroy(struct entity_store* store) {
+    memory_free(store->x);
+    memory_free(store->y);
+    memory_free(store->vx);
+    memory_free(store->vy);
+    memory_free(store->heading_x);
+    memory_free(store->heading_y);
+    memory_free(store->turn);
+    memory_free(store->moves);
+    store->x = store->y = store->vx = store->vy = NULL;
+    store->heading_x = store->heading_y = store->turn = NULL;
+    store->moves = NULL;
+    store->count = store->capacity = 0;
+}
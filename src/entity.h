@@ -0,0 +1,83 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+#include "jobs.h"
+
+/*
+    Structure-of-arrays store of moving entities (NPCs).
+    Each attribute lives in its own array so the integration step runs over
+    contiguous memory and vectorizes. Headings are kept as unit vectors rather than
+    angles, so moving needs no trigonometry and turning only a short polynomial.
+*/
+struct entity_store {
+    int count;              // Number of live entities
+    int capacity;           // Allocated size of every array
+    double* x;              // Positions along x
+    double* y;              // Positions along y
+    double* vx;             // Velocities along x (units per second)
+    double* vy;             // Velocities along y (units per second)
+    double* heading_x;      // Cosine of each entity's angle
+    double* heading_y;      // Sine of each entity's angle
+    double* turn;           // Rotation speeds (radians per second, counter-clockwise)
+    unsigned char* moves;   // Movement flags, a combination of the Direction values
+};
+
+/**
+ * Allocates an empty store.
+ * 
+ * @param store The store to initialize.
+ * @param capacity The maximum number of entities.
+ * @return int 0 if the store was allocated, or 1 if an error occurred.
+ */
+int entity_store_init(struct entity_store* store, int capacity);
+
+/**
+ * Adds an entity standing still.
+ * 
+ * @param store The store.
+ * @param x The x-coordinate of the entity.
+ * @param y The y-coordinate of the entity.
+ * @param angle The angle the entity faces (in radians).
+ * @return int The index of the new entity, or -1 if the store is full.
+ */
+int entity_spawn(struct entity_store* store, double x, double y, double angle);
+
+/**
+ * Returns the angle an entity faces.
+ * 
+ * @param store The store.
+ * @param index The index of the entity.
+ * @return double The angle, within [-PI, PI].
+ */
+double entity_angle(const struct entity_store* store, int index);
+
+/**
+ * Integrates entities [first, last): turns them by turn * delta_time, clamped to
+ * ENTITY_MAX_TURN_STEP, derives their velocity from their movement flags the way
+ * set_move_player does for the player, and moves them. Each turn is within 2e-14 radians
+ * of the requested angle.
+ * 
+ * @param store The store.
+ * @param first The first entity to update.
+ * @param last One past the last entity to update.
+ * @param delta_time The time elapsed since the last update.
+ */
+void entity_update_range(struct entity_store* store, int first, int last, double delta_time);
+
+/**
+ * Integrates every entity, in parallel chunks of ENTITY_CHUNK_SIZE on the pool.
+ * 
+ * @param store The store.
+ * @param pool The worker pool, or NULL to update on the calling thread.
+ * @param delta_time The time elapsed since the last update.
+ */
+void entity_update(struct entity_store* store, struct job_pool* pool, double delta_time);
+
+/**
+ * Frees every array of the store.
+ * 
+ * @param store The store to destroy.
+ */
+void entity_store_destroy(struct entity_store* store);
+
+#endif
@@ -0,0 +1,489 @@
+// Offline tool fuzzing every ray kernel against raycast_reference on random and adversarial walls
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL2/SDL.h>
+
+#include "constants.h"
+#include "algebra.h"
+#include "grid.h"
+#include "map.h"
+#include "quantized.h"
+#include "raycast.h"
+#include "span.h"
+#include "trig.h"
+
+#define FUZZ_WORLD 400          // Walls are drawn within [0, FUZZ_WORLD] on both axes (units)
+#define FUZZ_MAX_WALLS 60       // Largest number of walls in a scene
+#define FUZZ_CAMERAS 4          // Camera fans cast per scene
+#define FUZZ_SINGLE_RAYS 64     // Adversarial single rays cast per scene
+#define FUZZ_TOLERANCE 1e-9     // Relative distance difference below which two hits agree
+#define FUZZ_SLACK 1e-6         // Distance (units) within which a ray grazes a wall end or two hits coincide
+#define FUZZ_REPORT_LIMIT 5     // Mismatches printed in full per kernel
+#define FUZZ_MAX_EXCUSED 0.01   // Largest share of a kernel's rays that may disagree on ambiguous geometry
+
+// Walls of a scene with their acceleration structures
+struct fuzz_scene {
+    struct wall_grid grid;              // Grid over every wall
+    struct quantized_walls quantized;   // Compact copy of every wall
+    double quantized_bound;             // Largest distance between a quantized and an original wall point
+};
+
+// Rays sharing an origin: a camera fan in screen order, or a single ray
+struct fuzz_rays {
+    double x;                       // The x-coordinate of the origin
+    double y;                       // The y-coordinate of the origin
+    double angle;                   // The angle the camera faces
+    double plane_vector[2];         // The camera plane
+    int count;                      // Number of rays
+    double angles[RAYS_NUMBER];     // Angle of each ray, within [-PI, PI]
+    double directions[RAYS_NUMBER][2]; // Unit direction of each ray
+};
+
+// Kernel under test
+struct fuzz_kernel {
+    const char* name;
+    void (*cast)(const struct fuzz_scene* scene, const struct fuzz_rays* rays, struct ray_hit* hits);
+    int exact;          // 1 if every ray must agree with the reference, 0 if the kernel approximates by design
+    int fan_only;       // 1 if the kernel can only cast a full camera fan
+    int quantized;      // 1 if the kernel reads the quantized walls, whose rounding bounds how far its hits may move
+    double near;        // Depth below which the kernel clips walls away
+};
+
+// Results of a kernel
+struct fuzz_tally {
+    double time;        // Seconds spent casting the camera fans
+    long rays;          // Rays compared with the reference
+    long excused;       // Disagreements on ambiguous geometry: grazed wall ends, walls touching the origin or each other, the near plane
+    long mismatches;    // Disagreements beyond the tolerance
+};
+
+/*
+    Kernel adapters: cast every ray of a fan or single ray with one kernel.
+    Parameters:
+        - const struct fuzz_scene* scene: the walls and their acceleration structures
+        - const struct fuzz_rays* rays: the rays to cast
+        - struct ray_hit* hits: the closest hit of each ray (output)
+*/
+static void cast_reference(const struct fuzz_scene* scene, const struct fuzz_rays* rays, struct ray_hit* hits) {
+    (void) scene;
+    for(int i = 0; i < rays->count; i++)
+        raycast_reference(NULL, map_lines, rays->directions[i], rays->x, rays->y, (double*) rays->plane_vector, &hits[i]);
+}
+
+static void cast_grid(const struct fuzz_scene* scene, const struct fuzz_rays* rays, struct ray_hit* hits) {
+    for(int i = 0; i < rays->count; i++)
+        raycast_grid(&scene->grid, rays->directions[i], rays->x, rays->y, (double*) rays->plane_vector, &hits[i]);
+}
+
+static void cast_packet(const struct fuzz_scene* scene, const struct fuzz_rays* rays, struct ray_hit* hits) {
+    for(int i = 0; i < rays->count; i += RAY_PACKET_SIZE) {
+        int count = rays->count - i < RAY_PACKET_SIZE ? rays->count - i : RAY_PACKET_SIZE;
+        raycast_packet(&scene->grid, (double (*)[2]) &rays->directions[i], count, rays->x, rays->y, (double*) rays->plane_vector, &hits[i]);
+    }
+}
+
+static void cast_adaptive(const struct fuzz_scene* scene, const struct fuzz_rays* rays, struct ray_hit* hits) {
+    raycast_adaptive(&scene->grid, (double (*)[2]) rays->directions, rays->count, rays->x, rays->y, (double*) rays->plane_vector, ADAPTIVE_STEP, hits);
+}
+
+static void cast_spans(const struct fuzz_scene* scene, const struct fuzz_rays* rays, struct ray_hit* hits) {
+    (void) scene;
+    span_cast(NULL, map_lines, rays->angle, rays->x, rays->y, (double*) rays->plane_vector, RAYS_NUMBER, hits);
+}
+
+static void cast_quantized(const struct fuzz_scene* scene, const struct fuzz_rays* rays, struct ray_hit* hits) {
+    for(int i = 0; i < rays->count; i++)
+        raycast_quantized(&scene->quantized, rays->directions[i], rays->x, rays->y, (double*) rays->plane_vector, &hits[i]);
+}
+
+// Every kernel, the reference first
+static const struct fuzz_kernel kernels[] = {
+    { "reference", cast_reference, TRUE, FALSE, FALSE, 0 },
+    { "grid", cast_grid, TRUE, FALSE, FALSE, 0 },
+    { "packet", cast_packet, TRUE, FALSE, FALSE, 0 },
+    { "adaptive", cast_adaptive, FALSE, TRUE, FALSE, 0 },
+    { "spans", cast_spans, TRUE, TRUE, FALSE, SPAN_NEAR_PLANE },
+    { "quantized", cast_quantized, TRUE, FALSE, TRUE, 0 }
+};
+#define KERNEL_COUNT ((int) (sizeof(kernels) / sizeof(kernels[0])))
+
+// Results of each kernel, in the order of kernels
+static struct fuzz_tally tallies[KERNEL_COUNT];
+
+/**
+ * Returns a random number.
+ *
+ * @param low The smallest value.
+ * @param high The largest value.
+ * @return double A value within [low, high].
+ */
+static double random_range(double low, double high) {
+    return low + (high - low) * rand() / RAND_MAX;
+}
+
+/**
+ * Returns the time elapsed since `start` in seconds.
+ *
+ * @param start A value of SDL_GetPerformanceCounter.
+ * @return double The elapsed time in seconds.
+ */
+static double seconds_since(Uint64 start) {
+    return (double) (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
+/**
+ * Fills the map table with random walls, mixing the shapes that stress the special cases of
+ * intersection_lines: horizontal and vertical walls, walls sharing endpoints, walls on integer
+ * coordinates, tiny and zero-length walls.
+ */
+static void generate_walls(void) {
+    map_lines = 1 + rand() % FUZZ_MAX_WALLS;
+
+    for(int i = 0; i < map_lines; i++) {
+        double* wall = map[i];
+        wall[0] = random_range(0, FUZZ_WORLD);
+        wall[1] = random_range(0, FUZZ_WORLD);
+        wall[2] = random_range(0, FUZZ_WORLD);
+        wall[3] = random_range(0, FUZZ_WORLD);
+
+        switch(rand() % 6) {
+            case 0: // Horizontal
+                wall[3] = wall[1];
+                break;
+            case 1: // Vertical
+                wall[2] = wall[0];
+                break;
+            case 2: // Chained to the previous wall
+                if(i > 0) {
+                    wall[0] = map[i - 1][2];
+                    wall[1] = map[i - 1][3];
+                }
+                break;
+            case 3: // On the integer lattice, where rays from lattice points pass exactly through endpoints
+                for(int k = 0; k < 4; k++) wall[k] = floor(wall[k]);
+                break;
+            case 4: // Tiny, sometimes zero-length
+                wall[2] = wall[0] + (rand() % 4 == 0 ? 0 : random_range(-1, 1));
+                wall[3] = wall[1] + (rand() % 4 == 0 ? 0 : random_range(-1, 1));
+                break;
+            default: // Anywhere
+                break;
+        }
+
+        wall[4] = 255;
+        wall[5] = 255;
+        wall[6] = 255;
+    }
+    map_touch();
+}
+
+/**
+ * Picks a ray origin: anywhere (including outside the walls' bounding box), on the integer
+ * lattice, on a wall's endpoint, or level with a wall's first endpoint.
+ *
+ * @param x The x-coordinate of the origin (output).
+ * @param y The y-coordinate of the origin (output).
+ */
+static void generate_origin(double* x, double* y) {
+    const double* wall = map[rand() % map_lines];
+
+    switch(rand() % 5) {
+        case 0:
+            *x = floor(random_range(0, FUZZ_WORLD));
+            *y = floor(random_range(0, FUZZ_WORLD));
+            break;
+        case 1:
+            *x = wall[0];
+            *y = wall[1];
+            break;
+        case 2: // The reference's horizontal-wall branch rejects rays starting level with the wall
+            *x = random_range(0, FUZZ_WORLD);
+            *y = wall[1];
+            break;
+        default:
+            *x = random_range(-FUZZ_WORLD / 4, FUZZ_WORLD * 5 / 4);
+            *y = random_range(-FUZZ_WORLD / 4, FUZZ_WORLD * 5 / 4);
+            break;
+    }
+}
+
+/**
+ * Picks a ray angle from an origin: anywhere, along an axis or a quadrant boundary (exactly or
+ * nudged), exactly at a wall endpoint, or parallel to a wall.
+ *
+ * @param x The x-coordinate of the origin.
+ * @param y The y-coordinate of the origin.
+ * @return double The angle, within [-PI, PI].
+ */
+static double generate_angle(double x, double y) {
+    static const double axes[] = { 0, PI / 2, -PI / 2, PI, -PI, 1.5707963267948966, -1.5707963267948966 };
+    static const double nudges[] = { 0, 1e-12, -1e-12, 1e-7, -1e-7 };
+    const double* wall = map[rand() % map_lines];
+    double angle;
+
+    switch(rand() % 5) {
+        case 0:
+            angle = axes[rand() % (sizeof(axes) / sizeof(axes[0]))] + nudges[rand() % (sizeof(nudges) / sizeof(nudges[0]))];
+            break;
+        case 1: // Grazes an endpoint
+            angle = atan2(wall[3] - y, wall[2] - x);
+            break;
+        case 2: // Parallel to a wall
+            angle = atan2(wall[3] - wall[1], wall[2] - wall[0]);
+            break;
+        default:
+            angle = random_range(-PI, PI);
+            break;
+    }
+
+    if(angle > PI) angle = PI;
+    if(angle < -PI) angle = -PI;
+    return angle;
+}
+
+/**
+ * Builds a camera fan exactly like cast_rays and cast_camera do.
+ *
+ * @param rays The fan (output).
+ * @param x The x-coordinate of the camera.
+ * @param y The y-coordinate of the camera.
+ * @param angle The angle the camera faces.
+ */
+static void make_fan(struct fuzz_rays* rays, double x, double y, double angle) {
+    rays->x = x;
+    rays->y = y;
+    rays->angle = angle;
+    double sine, cosine;
+    trig_sincos_batch(&angle, &sine, &cosine, 1);
+    rays->plane_vector[0] = -sine;
+    rays->plane_vector[1] = cosine;
+    rays->count = RAYS_NUMBER;
+    trig_direction_fan(angle + (FOV/2), -(FOV / RAYS_NUMBER), RAYS_NUMBER, rays->directions);
+    for(int i = 0; i < RAYS_NUMBER; i++) {
+        rays->angles[i] = angle + (FOV/2) - (FOV / RAYS_NUMBER) * i;
+        normalize_angle(&rays->angles[i]);
+    }
+}
+
+/**
+ * Returns the distance from a point to a ray.
+ *
+ * @param px The x-coordinate of the point.
+ * @param py The y-coordinate of the point.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param angle The angle of the ray.
+ * @return double The distance from the point to the nearest point of the ray.
+ */
+static double distance_to_ray(double px, double py, double x, double y, double angle) {
+    double dx = cos(angle), dy = sin(angle);
+    double along = (px - x) * dx + (py - y) * dy;
+    if(along <= 0) return hypot(px - x, py - y);
+    return fabs((px - x) * dy - (py - y) * dx);
+}
+
+/**
+ * Returns the distance from a point to a map wall.
+ *
+ * @param wall The map table row of the wall.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @return double The distance.
+ */
+static double distance_to_wall(int wall, double x, double y) {
+    double dx = map[wall][2] - map[wall][0], dy = map[wall][3] - map[wall][1];
+    double length = dx * dx + dy * dy;
+    double t = length > 0 ? ((x - map[wall][0]) * dx + (y - map[wall][1]) * dy) / length : 0;
+    t = fmax(0, fmin(1, t));
+    return hypot(map[wall][0] + t * dx - x, map[wall][1] + t * dy - y);
+}
+
+/**
+ * Checks whether a ray passes within `slack` of either end of a wall, where rounding
+ * legitimately decides whether the wall is hit.
+ *
+ * @param wall The map table row of the wall, or -1.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param angle The angle of the ray.
+ * @param slack The distance.
+ * @return int 1 if the ray grazes an end of the wall, 0 otherwise.
+ */
+static int grazes_wall_end(int wall, double x, double y, double angle, double slack) {
+    if(wall < 0) return 0;
+    return distance_to_ray(map[wall][0], map[wall][1], x, y, angle) <= slack
+        || distance_to_ray(map[wall][2], map[wall][3], x, y, angle) <= slack;
+}
+
+/**
+ * Checks whether two hits may legitimately differ because the geometry is ambiguous within
+ * `slack`: the ray grazes an end of either wall, either wall passes through the ray origin,
+ * or either hit lies on the other's wall (coincident or crossing walls).
+ *
+ * @param reference The reference hit.
+ * @param hit The kernel's hit.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param angle The angle of the ray.
+ * @param slack The distance.
+ * @return int 1 if the geometry is ambiguous, 0 otherwise.
+ */
+static int ambiguous(const struct ray_hit* reference, const struct ray_hit* hit, double x, double y, double angle, double slack) {
+    if(grazes_wall_end(reference->wall, x, y, angle, slack) || grazes_wall_end(hit->wall, x, y, angle, slack)) return 1;
+    if((reference->wall >= 0 && distance_to_wall(reference->wall, x, y) <= slack)
+        || (hit->wall >= 0 && distance_to_wall(hit->wall, x, y) <= slack))
+        return 1;
+    return reference->wall >= 0 && hit->wall >= 0 && (distance_to_wall(reference->wall, hit->x, hit->y) <= slack
+        || distance_to_wall(hit->wall, reference->x, reference->y) <= slack);
+}
+
+/**
+ * Compares a kernel's hit with the reference's. Hits agree when both miss or their distances
+ * match. A kernel that moves the walls by up to `bound` (the quantized one) also agrees when its
+ * hit lies within `bound` of the wall it reports, and that wall is the reference's or the
+ * geometry is ambiguous within `bound`. Any other disagreement is excused only when the geometry
+ * is ambiguous within FUZZ_SLACK or the reference hit is in front of the kernel's near plane.
+ *
+ * @param kernel The kernel.
+ * @param reference The reference hit.
+ * @param hit The kernel's hit.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param angle The angle of the ray.
+ * @param bound The largest distance the kernel moves a wall point, 0 if it reads the walls unchanged.
+ * @return int 0 if the hits agree, 1 if the disagreement is excused, 2 if it is a mismatch.
+ */
+static int compare_hits(const struct fuzz_kernel* kernel, const struct ray_hit* reference, const struct ray_hit* hit,
+    double x, double y, double angle, double bound) {
+    if(reference->wall < 0 && hit->wall < 0) return 0;
+    if(reference->wall >= 0 && hit->wall >= 0
+        && fabs(reference->distance - hit->distance) <= FUZZ_TOLERANCE * (1 + reference->distance))
+        return 0;
+
+    if(bound > 0 && (hit->wall < 0 || distance_to_wall(hit->wall, hit->x, hit->y) <= bound)
+        && (hit->wall == reference->wall || ambiguous(reference, hit, x, y, angle, bound)))
+        return 0;
+
+    if(ambiguous(reference, hit, x, y, angle, FUZZ_SLACK)) return 1;
+    if(reference->wall >= 0 && reference->distance <= kernel->near + FUZZ_SLACK) return 1;
+    return 2;
+}
+
+/**
+ * Casts rays with every kernel and compares each hit with the reference's.
+ *
+ * @param scene The walls and their acceleration structures.
+ * @param rays The rays.
+ * @param timed 1 to add the casting times to the kernels' totals.
+ * @param scene_index The index of the scene, printed with mismatches.
+ */
+static void compare_kernels(const struct fuzz_scene* scene, const struct fuzz_rays* rays, int timed, int scene_index) {
+    static struct ray_hit reference[RAYS_NUMBER];
+    static struct ray_hit hits[RAYS_NUMBER];
+
+    for(int k = 0; k < KERNEL_COUNT; k++) {
+        const struct fuzz_kernel* kernel = &kernels[k];
+        struct fuzz_tally* tally = &tallies[k];
+        if(kernel->fan_only && rays->count != RAYS_NUMBER) continue;
+        if(kernel->quantized && scene->quantized.walls == NULL) continue;
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        kernel->cast(scene, rays, k == 0 ? reference : hits);
+        if(timed) tally->time += seconds_since(start);
+        if(k == 0) continue;
+
+        double bound = kernel->quantized ? scene->quantized_bound + FUZZ_SLACK : 0;
+        for(int i = 0; i < rays->count; i++) {
+            int verdict = compare_hits(kernel, &reference[i], &hits[i], rays->x, rays->y, rays->angles[i], bound);
+            tally->rays++;
+            tally->excused += verdict == 1;
+            if(verdict < 2) continue;
+
+            // Approximate kernels are expected to miss some walls: only count them
+            if(tally->mismatches++ < FUZZ_REPORT_LIMIT && kernel->exact) {
+                printf("%s mismatch in scene %d: ray from (%.17g, %.17g) at angle %.17g\n",
+                    kernel->name, scene_index, rays->x, rays->y, rays->angles[i]);
+                printf("    reference: wall %d at distance %.17g\n", reference[i].wall, reference[i].distance);
+                printf("    %s: wall %d at distance %.17g\n", kernel->name, hits[i].wall, hits[i].distance);
+                int walls[2] = { reference[i].wall, hits[i].wall };
+                for(int w = 0; w < 2; w++) {
+                    if(walls[w] < 0) continue;
+                    printf("    wall %d: (%.17g, %.17g) - (%.17g, %.17g)\n", walls[w],
+                        map[walls[w]][0], map[walls[w]][1], map[walls[w]][2], map[walls[w]][3]);
+                }
+            }
+        }
+    }
+}
+
+/*
+    Generates scenes of random walls and compares every ray kernel with the reference on
+    camera fans and on adversarial single rays, then prints the agreement and relative speed
+    of each kernel. Arguments: the number of scenes (1000 by default) and the random seed (1).
+    Exits with 1 if an exact kernel disagrees with the reference beyond the tolerance, or if
+    more than FUZZ_MAX_EXCUSED of any kernel's rays are excused.
+*/
+int main(int argc, char* argv[]) {
+    int scenes = argc > 1 ? atoi(argv[1]) : 1000;
+    unsigned seed = argc > 2 ? (unsigned) atoi(argv[2]) : 1;
+    static struct fuzz_rays rays;
+    struct fuzz_scene scene;
+
+    trig_init();
+    srand(seed);
+
+    for(int s = 0; s < scenes; s++) {
+        generate_walls();
+        if(grid_build(&scene.grid, NULL, map_lines, GRID_CELL_SIZE)) {
+            fprintf(stderr, "Error building grid.\n");
+            return 1;
+        }
+        if(quantized_build(&scene.quantized, NULL, map_lines)) scene.quantized.walls = NULL;
+        else scene.quantized_bound = quantized_error_bound(&scene.quantized);
+
+        for(int c = 0; c < FUZZ_CAMERAS; c++) {
+            double x, y;
+            generate_origin(&x, &y);
+            make_fan(&rays, x, y, generate_angle(x, y));
+            compare_kernels(&scene, &rays, TRUE, s);
+        }
+
+        for(int r = 0; r < FUZZ_SINGLE_RAYS; r++) {
+            double x, y;
+            generate_origin(&x, &y);
+            rays.x = x;
+            rays.y = y;
+            rays.angle = generate_angle(x, y);
+            rays.plane_vector[0] = cos(rays.angle + PI/2);
+            rays.plane_vector[1] = sin(rays.angle + PI/2);
+            rays.count = 1;
+            rays.angles[0] = rays.angle;
+            rays.directions[0][0] = cos(rays.angle);
+            rays.directions[0][1] = sin(rays.angle);
+            compare_kernels(&scene, &rays, FALSE, s);
+        }
+
+        grid_destroy(&scene.grid);
+        if(scene.quantized.walls != NULL) quantized_destroy(&scene.quantized);
+    }
+
+    int failed = FALSE;
+    long fan_rays = (long) scenes * FUZZ_CAMERAS * RAYS_NUMBER;
+    printf("%d scenes of up to %d walls, seed %u, %ld fan rays:\n", scenes, FUZZ_MAX_WALLS, seed, fan_rays);
+    for(int k = 0; k < KERNEL_COUNT; k++) {
+        const struct fuzz_kernel* kernel = &kernels[k];
+        const struct fuzz_tally* tally = &tallies[k];
+        printf("%10s: %7.1f ns/ray (%5.2fx reference)", kernel->name, tally->time * 1e9 / fan_rays, tallies[0].time / tally->time);
+        if(k > 0)
+            printf(", %ld rays compared, %ld excused (%.3f%%), %ld mismatches%s", tally->rays, tally->excused,
+                100.0 * tally->excused / tally->rays, tally->mismatches, kernel->exact ? "" : " (approximate)");
+        printf("\n");
+        if(kernel->exact && tally->mismatches > 0) failed = TRUE;
+        if(k > 0 && tally->excused > FUZZ_MAX_EXCUSED * tally->rays) {
+            printf("%10s: more than %.1f%% of rays excused\n", kernel->name, 100 * FUZZ_MAX_EXCUSED);
+            failed = TRUE;
+        }
+    }
+    return failed;
+}
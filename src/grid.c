@@ -0,0 +1,273 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "constants.h"
+#include "map.h"
+#include "memory.h"
+#include "grid.h"
+
+/**
+ * Returns the cell column containing a world x-coordinate, clamped to the grid.
+ * 
+ * @param grid The grid.
+ * @param x The world x-coordinate.
+ * @return int The column index.
+ */
+int grid_column(const struct wall_grid* grid, double x) {
+    int column = (int) floor((x - grid->min_x) / grid->cell_size);
+    return column < 0 ? 0 : column >= grid->columns ? grid->columns - 1 : column;
+}
+
+/**
+ * Returns the cell row containing a world y-coordinate, clamped to the grid.
+ * 
+ * @param grid The grid.
+ * @param y The world y-coordinate.
+ * @return int The row index.
+ */
+int grid_row(const struct wall_grid* grid, double y) {
+    int row = (int) floor((y - grid->min_y) / grid->cell_size);
+    return row < 0 ? 0 : row >= grid->rows ? grid->rows - 1 : row;
+}
+
+/**
+ * Checks whether a wall crosses a cell (Liang-Barsky clip against the cell rectangle).
+ * 
+ * @param grid The grid.
+ * @param wall The wall as {x0, y0, xf, yf}.
+ * @param column The column of the cell.
+ * @param row The row of the cell.
+ * @return int 1 if the wall crosses the cell, 0 otherwise.
+ */
+static int wall_crosses_cell(const struct wall_grid* grid, const double* wall, int column, int row) {
+    double x0 = wall[0], y0 = wall[1];
+    double dx = wall[2] - x0, dy = wall[3] - y0;
+    double left = grid->min_x + column * grid->cell_size, top = grid->min_y + row * grid->cell_size;
+    double p[4] = { -dx, dx, -dy, dy };
+    double q[4] = { x0 - left, left + grid->cell_size - x0, y0 - top, top + grid->cell_size - y0 };
+    double t0 = 0, t1 = 1;
+
+    for(int i = 0; i < 4; i++) {
+        if(p[i] == 0) {
+            if(q[i] < 0) return 0; // Parallel to this edge and outside
+            continue;
+        }
+        double t = q[i] / p[i];
+        if(p[i] < 0) t0 = fmax(t0, t);
+        else t1 = fmin(t1, t);
+        if(t0 > t1) return 0;
+    }
+    return 1;
+}
+
+/**
+ * Appends a wall to a cell, growing the cell if needed.
+ * 
+ * @param cell The cell.
+ * @param wall The map table row of the wall.
+ * @return int 0 if the wall was added, or 1 if an error occurred.
+ */
+static int cell_add(struct grid_cell* cell, int wall) {
+    if(cell->count == cell->capacity) {
+        int capacity = cell->capacity ? cell->capacity * 2 : 4;
+        int* walls = memory_realloc(MEMORY_GRIDS, cell->walls, sizeof(int) * capacity);
+        if(walls == NULL) return 1;
+        cell->walls = walls;
+        cell->capacity = capacity;
+    }
+    cell->walls[cell->count++] = wall;
+    return 0;
+}
+
+/**
+ * Builds a grid over a set of map walls, sized to their bounding box.
+ * 
+ * @param grid The grid to build.
+ * @param wall_ids The map table rows of the walls to index.
+ * @param wall_count The number of walls to index.
+ * @param cell_size The width and height of a cell in world units.
+ * @return int 0 if the grid was built, or 1 if an error occurred.
+ */
+int grid_build(struct wall_grid* grid, const int* wall_ids, int wall_count, double cell_size) {
+    return grid_build_table(grid, &map[0][0], wall_ids, wall_count, cell_size);
+}
+
+/**
+ * Builds a grid over walls stored in a table laid out like the map table
+ * (rows of seven doubles starting with x0, y0, xf, yf), sized to their bounding box.
+ * 
+ * @param grid The grid to build.
+ * @param table The first element of the wall table.
+ * @param wall_ids The rows of the walls to index, or NULL for rows 0 to wall_count - 1.
+ * @param wall_count The number of walls to index.
+ * @param cell_size The width and height of a cell in world units.
+ * @return int 0 if the grid was built, or 1 if an error occurred.
+ */
+int grid_build_table(struct wall_grid* grid, const double* table, const int* wall_ids, int wall_count, double cell_size) {
+    double min[2] = { INFINITY, INFINITY }, max[2] = { -INFINITY, -INFINITY };
+    for(int i = 0; i < wall_count; i++) {
+        const double* wall = &table[7 * (wall_ids != NULL ? wall_ids[i] : i)];
+        min[0] = fmin(min[0], fmin(wall[0], wall[2]));
+        min[1] = fmin(min[1], fmin(wall[1], wall[3]));
+        max[0] = fmax(max[0], fmax(wall[0], wall[2]));
+        max[1] = fmax(max[1], fmax(wall[1], wall[3]));
+    }
+    if(wall_count == 0) min[0] = min[1] = max[0] = max[1] = 0;
+
+    grid->min_x = min[0];
+    grid->min_y = min[1];
+    grid->cell_size = cell_size;
+    grid->table = table;
+    grid->columns = (int) ((max[0] - min[0]) / cell_size) + 1;
+    grid->rows = (int) ((max[1] - min[1]) / cell_size) + 1;
+    grid->cells = memory_calloc(MEMORY_GRIDS, (size_t) grid->columns * grid->rows, sizeof(struct grid_cell));
+    if(grid->cells == NULL) return 1;
+
+    for(int i = 0; i < wall_count; i++) {
+        int id = wall_ids != NULL ? wall_ids[i] : i;
+        const double* wall = &table[7 * id];
+        int first_column = grid_column(grid, fmin(wall[0], wall[2]));
+        int last_column = grid_column(grid, fmax(wall[0], wall[2]));
+        int first_row = grid_row(grid, fmin(wall[1], wall[3]));
+        int last_row = grid_row(grid, fmax(wall[1], wall[3]));
+
+        for(int row = first_row; row <= last_row; row++) {
+            for(int column = first_column; column <= last_column; column++) {
+                if(!wall_crosses_cell(grid, wall, column, row)) continue;
+                if(cell_add(&grid->cells[row * grid->columns + column], id)) {
+                    grid_destroy(grid);
+                    return 1;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Adds a wall to a built grid, in every cell it crosses, without touching other cells.
+ * 
+ * @param grid The grid.
+ * @param table The first element of the wall table the grid indexes.
+ * @param id The row of the wall.
+ * @return int 0 if the wall was added, or 1 if it reaches outside the grid (which must
+ *             then be rebuilt) or an error occurred.
+ */
+int grid_insert(struct wall_grid* grid, const double* table, int id) {
+    const double* wall = &table[7 * id];
+    if(fmin(wall[0], wall[2]) < grid->min_x || fmax(wall[0], wall[2]) >= grid->min_x + grid->columns * grid->cell_size
+        || fmin(wall[1], wall[3]) < grid->min_y || fmax(wall[1], wall[3]) >= grid->min_y + grid->rows * grid->cell_size)
+        return 1; // Clamping would file the outside part under the border cells
+
+    int first_column = grid_column(grid, fmin(wall[0], wall[2]));
+    int last_column = grid_column(grid, fmax(wall[0], wall[2]));
+    int first_row = grid_row(grid, fmin(wall[1], wall[3]));
+    int last_row = grid_row(grid, fmax(wall[1], wall[3]));
+
+    for(int row = first_row; row <= last_row; row++)
+        for(int column = first_column; column <= last_column; column++)
+            if(wall_crosses_cell(grid, wall, column, row) && cell_add(&grid->cells[row * grid->columns + column], id)) return 1;
+
+    return 0;
+}
+
+/**
+ * Renames or removes a wall in the cells overlapping its bounding box.
+ * 
+ * @param grid The grid.
+ * @param wall The wall as {x0, y0, xf, yf}, where it was when it was inserted.
+ * @param id The row of the wall.
+ * @param new_id The new row of the wall, or -1 to remove it.
+ */
+static void cells_replace(struct wall_grid* grid, const double* wall, int id, int new_id) {
+    int first_column = grid_column(grid, fmin(wall[0], wall[2]));
+    int last_column = grid_column(grid, fmax(wall[0], wall[2]));
+    int first_row = grid_row(grid, fmin(wall[1], wall[3]));
+    int last_row = grid_row(grid, fmax(wall[1], wall[3]));
+
+    for(int row = first_row; row <= last_row; row++) {
+        for(int column = first_column; column <= last_column; column++) {
+            struct grid_cell* cell = &grid->cells[row * grid->columns + column];
+            for(int i = 0; i < cell->count; i++) {
+                if(cell->walls[i] != id) continue;
+                if(new_id >= 0) cell->walls[i] = new_id;
+                else cell->walls[i--] = cell->walls[--cell->count]; // Order within a cell does not matter
+            }
+        }
+    }
+}
+
+/**
+ * Removes a wall from a built grid, visiting only the cells it was filed under.
+ * 
+ * @param grid The grid.
+ * @param wall The wall as {x0, y0, xf, yf}, where it was when it was inserted.
+ * @param id The row of the wall.
+ */
+void grid_remove(struct wall_grid* grid, const double* wall, int id) {
+    cells_replace(grid, wall, id, -1);
+}
+
+/**
+ * Changes the row a wall is filed under, e.g. after its table row moved.
+ * 
+ * @param grid The grid.
+ * @param wall The wall as {x0, y0, xf, yf}.
+ * @param id The current row of the wall.
+ * @param new_id The new row of the wall.
+ */
+void grid_rename(struct wall_grid* grid, const double* wall, int id, int new_id) {
+    cells_replace(grid, wall, id, new_id);
+}
+
+/**
+ * Lists the walls whose cells overlap a box. Each wall is reported once.
+ * Safe to call from several threads at the same time.
+ * 
+ * @param grid The grid to query.
+ * @param min_x The left edge of the box.
+ * @param min_y The top edge of the box.
+ * @param max_x The right edge of the box.
+ * @param max_y The bottom edge of the box.
+ * @param out The rows of the walls found in the grid's table (output).
+ * @param max_out The capacity of out.
+ * @return int The number of walls written to out.
+ */
+int grid_query_box(const struct wall_grid* grid, double min_x, double min_y, double max_x, double max_y, int* out, int max_out) {
+    int first_column = grid_column(grid, min_x), last_column = grid_column(grid, max_x);
+    int first_row = grid_row(grid, min_y), last_row = grid_row(grid, max_y);
+    int count = 0;
+
+    for(int row = first_row; row <= last_row; row++) {
+        for(int column = first_column; column <= last_column; column++) {
+            const struct grid_cell* cell = &grid->cells[row * grid->columns + column];
+
+            for(int i = 0; i < cell->count && count < max_out; i++) {
+                int wall = cell->walls[i];
+
+                // Walls crossing several cells are reported from the first one; candidate
+                // lists are short, so a scan beats per-query bookkeeping and stays thread-safe
+                int seen = FALSE;
+                for(int j = 0; j < count && !seen; j++) seen = out[j] == wall;
+                if(seen) continue;
+
+                out[count++] = wall;
+            }
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Frees every cell of the grid.
+ * 
+ * @param grid The grid to destroy.
+ */
+void grid_destroy(struct wall_grid* grid) {
+    if(grid->cells == NULL) return;
+    for(int i = 0; i < grid->columns * grid->rows; i++) memory_free(grid->cells[i].walls);
+    memory_free(grid->cells);
+    grid->cells = NULL;
+}
@@ -0,0 +1,120 @@
+#ifndef GRID_H
+#define GRID_H
+
+// Cell of a wall grid: the map rows of every wall overlapping the cell
+struct grid_cell {
+    int count;      // Number of walls in the cell
+    int capacity;   // Allocated size of walls
+    int* walls;     // Rows of the walls in the grid's table
+};
+
+/*
+    Uniform grid over a set of walls of a table laid out like the map table (the map itself
+    or a chunk's walls), used as the broad phase of collision and ray queries.
+    Each wall is stored in every cell it crosses.
+*/
+struct wall_grid {
+    double min_x;             // World x-coordinate of the left edge of the grid
+    double min_y;             // World y-coordinate of the top edge of the grid
+    double cell_size;         // Width and height of a cell in world units
+    int columns;              // Number of cells along x
+    int rows;                 // Number of cells along y
+    struct grid_cell* cells;  // Cells in row-major order
+    const double* table;      // First element of the wall table the cells index (the map table or a chunk's walls)
+};
+
+/**
+ * Builds a grid over a set of map walls, sized to their bounding box.
+ * 
+ * @param grid The grid to build.
+ * @param wall_ids The map table rows of the walls to index.
+ * @param wall_count The number of walls to index.
+ * @param cell_size The width and height of a cell in world units.
+ * @return int 0 if the grid was built, or 1 if an error occurred.
+ */
+int grid_build(struct wall_grid* grid, const int* wall_ids, int wall_count, double cell_size);
+
+/**
+ * Builds a grid over walls stored in a table laid out like the map table
+ * (rows of seven doubles starting with x0, y0, xf, yf), sized to their bounding box.
+ * 
+ * @param grid The grid to build.
+ * @param table The first element of the wall table.
+ * @param wall_ids The rows of the walls to index, or NULL for rows 0 to wall_count - 1.
+ * @param wall_count The number of walls to index.
+ * @param cell_size The width and height of a cell in world units.
+ * @return int 0 if the grid was built, or 1 if an error occurred.
+ */
+int grid_build_table(struct wall_grid* grid, const double* table, const int* wall_ids, int wall_count, double cell_size);
+
+/**
+ * Adds a wall to a built grid, in every cell it crosses, without touching other cells.
+ * 
+ * @param grid The grid.
+ * @param table The first element of the wall table the grid indexes.
+ * @param id The row of the wall.
+ * @return int 0 if the wall was added, or 1 if it reaches outside the grid (which must
+ *             then be rebuilt) or an error occurred.
+ */
+int grid_insert(struct wall_grid* grid, const double* table, int id);
+
+/**
+ * Removes a wall from a built grid, visiting only the cells it was filed under.
+ * 
+ * @param grid The grid.
+ * @param wall The wall as {x0, y0, xf, yf}, where it was when it was inserted.
+ * @param id The row of the wall.
+ */
+void grid_remove(struct wall_grid* grid, const double* wall, int id);
+
+/**
+ * Changes the row a wall is filed under, e.g. after its table row moved.
+ * 
+ * @param grid The grid.
+ * @param wall The wall as {x0, y0, xf, yf}.
+ * @param id The current row of the wall.
+ * @param new_id The new row of the wall.
+ */
+void grid_rename(struct wall_grid* grid, const double* wall, int id, int new_id);
+
+/**
+ * Lists the walls whose cells overlap a box. Each wall is reported once.
+ * Safe to call from several threads at the same time.
+ * 
+ * @param grid The grid to query.
+ * @param min_x The left edge of the box.
+ * @param min_y The top edge of the box.
+ * @param max_x The right edge of the box.
+ * @param max_y The bottom edge of the box.
+ * @param out The rows of the walls found in the grid's table (output).
+ * @param max_out The capacity of out.
+ * @return int The number of walls written to out.
+ */
+int grid_query_box(const struct wall_grid* grid, double min_x, double min_y, double max_x, double max_y, int* out, int max_out);
+
+/**
+ * Returns the cell column containing a world x-coordinate, clamped to the grid.
+ * 
+ * @param grid The grid.
+ * @param x The world x-coordinate.
+ * @return int The column index.
+ */
+int grid_column(const struct wall_grid* grid, double x);
+
+/**
+ * Returns the cell row containing a world y-coordinate, clamped to the grid.
+ * 
+ * @param grid The grid.
+ * @param y The world y-coordinate.
+ * @return int The row index.
+ */
+int grid_row(const struct wall_grid* grid, double y);
+
+/**
+ * Frees every cell of the grid.
+ * 
+ * @param grid The grid to destroy.
+ */
+void grid_destroy(struct wall_grid* grid);
+
+#endif
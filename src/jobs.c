@@ -0,0 +1,144 @@
+#include <stdlib.h>
+#include <SDL2/SDL.h>
+
+#include "constants.h"
+#include "jobs.h"
+#include "memory.h"
+
+/**
+ * Claims and runs chunks of the current loop until none is left.
+ * 
+ * @param pool The pool.
+ */
+static void run_chunks(struct job_pool* pool) {
+    for(;;) {
+        int first = atomic_fetch_add(&pool->next_chunk, 1) * pool->chunk;
+        if(first >= pool->count) return;
+        int last = first + pool->chunk < pool->count ? first + pool->chunk : pool->count;
+        pool->function(pool->context, first, last);
+    }
+}
+
+/**
+ * Worker thread: waits for a loop, helps with it, then waits for the next one.
+ * 
+ * @param data The pool.
+ * @return int Always 0.
+ */
+static int worker_thread(void* data) {
+    struct job_pool* pool = data;
+    unsigned long seen = 0;
+
+    SDL_LockMutex(pool->lock);
+    for(;;) {
+        while(pool->generation == seen && !pool->stopping)
+            SDL_CondWait(pool->work_ready, pool->lock);
+        if(pool->stopping) break;
+        seen = pool->generation;
+        SDL_UnlockMutex(pool->lock);
+
+        run_chunks(pool);
+
+        SDL_LockMutex(pool->lock);
+        if(--pool->busy == 0) SDL_CondSignal(pool->work_done);
+    }
+    SDL_UnlockMutex(pool->lock);
+    return 0;
+}
+
+/**
+ * Starts a pool of worker threads.
+ * 
+ * @param pool The pool to start.
+ * @param thread_count The number of workers, or 0 to use one per CPU besides the caller.
+ * @return int 0 if the pool was started, or 1 if an error occurred.
+ */
+int jobs_init(struct job_pool* pool, int thread_count) {
+    if(thread_count <= 0) thread_count = SDL_GetCPUCount() - 1;
+    if(thread_count < 0) thread_count = 0;
+
+    pool->thread_count = 0;
+    pool->generation = 0;
+    pool->stopping = FALSE;
+    pool->busy = 0;
+    atomic_init(&pool->next_chunk, 0);
+    pool->lock = SDL_CreateMutex();
+    pool->work_ready = SDL_CreateCond();
+    pool->work_done = SDL_CreateCond();
+    pool->threads = memory_alloc(MEMORY_JOBS, sizeof(SDL_Thread*) * (thread_count > 0 ? thread_count : 1));
+    if(pool->lock == NULL || pool->work_ready == NULL || pool->work_done == NULL || pool->threads == NULL) {
+        jobs_destroy(pool);
+        return 1;
+    }
+
+    for(int i = 0; i < thread_count; i++) {
+        pool->threads[i] = SDL_CreateThread(worker_thread, "job worker", pool);
+        if(pool->threads[i] == NULL) {
+            jobs_destroy(pool);
+            return 1;
+        }
+        pool->thread_count++;
+    }
+
+    return 0;
+}
+
+/**
+ * Runs function over [0, count) in chunks of `chunk` items on every thread of the pool,
+ * returning once every chunk is done. Chunks never overlap, so each item is visited once.
+ * 
+ * @param pool The pool, or NULL to run everything on the calling thread.
+ * @param count The number of items.
+ * @param chunk The number of items per chunk.
+ * @param function The work function.
+ * @param context The context passed to the work function.
+ */
+void jobs_parallel_for(struct job_pool* pool, int count, int chunk, job_function function, void* context) {
+    if(count <= 0) return;
+    if(pool == NULL || pool->thread_count == 0 || count <= chunk) {
+        function(context, 0, count);
+        return;
+    }
+
+    SDL_LockMutex(pool->lock);
+    pool->function = function;
+    pool->context = context;
+    pool->count = count;
+    pool->chunk = chunk > 0 ? chunk : 1;
+    atomic_store(&pool->next_chunk, 0);
+    pool->busy = pool->thread_count;
+    pool->generation++;
+    SDL_CondBroadcast(pool->work_ready);
+    SDL_UnlockMutex(pool->lock);
+
+    run_chunks(pool); // The caller works instead of waiting idle
+
+    SDL_LockMutex(pool->lock);
+    while(pool->busy > 0) SDL_CondWait(pool->work_done, pool->lock);
+    SDL_UnlockMutex(pool->lock);
+}
+
+/**
+ * Stops the workers and frees the pool.
+ * 
+ * @param pool The pool to destroy.
+ */
+void jobs_destroy(struct job_pool* pool) {
+    if(pool->lock != NULL) {
+        SDL_LockMutex(pool->lock);
+        pool->stopping = TRUE;
+        if(pool->work_ready != NULL) SDL_CondBroadcast(pool->work_ready);
+        SDL_UnlockMutex(pool->lock);
+    }
+    for(int i = 0; i < pool->thread_count; i++) SDL_WaitThread(pool->threads[i], NULL);
+
+    memory_free(pool->threads);
+    if(pool->work_done != NULL) SDL_DestroyCond(pool->work_done);
+    if(pool->work_ready != NULL) SDL_DestroyCond(pool->work_ready);
+    if(pool->lock != NULL) SDL_DestroyMutex(pool->lock);
+    pool->threads = NULL;
+    pool->thread_count = 0;
+    pool->lock = NULL;
+    pool->work_ready = NULL;
+    pool->work_done = NULL;
+}
@@ -0,0 +1,59 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdatomic.h>
+#include <SDL2/SDL.h>
+
+// Work function run on a range [first, last) of a parallel loop
+typedef void (*job_function)(void* context, int first, int last);
+
+/*
+    Pool of worker threads running parallel loops in fixed-size chunks.
+    Workers claim chunks through an atomic counter; the calling thread works too.
+*/
+struct job_pool {
+    int thread_count;           // Number of worker threads (the caller is not counted)
+    SDL_Thread** threads;       // The worker threads
+    SDL_mutex* lock;            // Guards generation, stopping and busy
+    SDL_cond* work_ready;       // Signaled when a new loop starts or the pool stops
+    SDL_cond* work_done;        // Signaled when the last worker leaves a loop
+    unsigned long generation;   // Incremented for every loop
+    int stopping;               // 1 once the pool is being destroyed
+    int busy;                   // Workers still inside the current loop
+
+    job_function function;      // Work function of the current loop
+    void* context;              // Context of the current loop
+    int count;                  // Number of items of the current loop
+    int chunk;                  // Items per chunk
+    atomic_int next_chunk;      // Next chunk to claim
+};
+
+/**
+ * Starts a pool of worker threads.
+ * 
+ * @param pool The pool to start.
+ * @param thread_count The number of workers, or 0 to use one per CPU besides the caller.
+ * @return int 0 if the pool was started, or 1 if an error occurred.
+ */
+int jobs_init(struct job_pool* pool, int thread_count);
+
+/**
+ * Runs function over [0, count) in chunks of `chunk` items on every thread of the pool,
+ * returning once every chunk is done. Chunks never overlap, so each item is visited once.
+ * 
+ * @param pool The pool, or NULL to run everything on the calling thread.
+ * @param count The number of items.
+ * @param chunk The number of items per chunk.
+ * @param function The work function.
+ * @param context The context passed to the work function.
+ */
+void jobs_parallel_for(struct job_pool* pool, int count, int chunk, job_function function, void* context);
+
+/**
+ * Stops the workers and frees the pool.
+ * 
+ * @param pool The pool to destroy.
+ */
+void jobs_destroy(struct job_pool* pool);
+
+#endif
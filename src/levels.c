@@ -0,0 +1,279 @@
+#include <stdlib.h>
+
+#include "constants.h"
+#include "doors.h"
+#include "levels.h"
+#include "map.h"
+#include "memory.h"
+#include "pvs.h"
+
+/**
+ * Creates the first level of the game from the map table.
+ * The sample map is a single open room, so every wall goes into one section.
+ * 
+ * @return struct section* Pointer to the section the player spawns in, or NULL if allocation fails.
+ */
+struct section* create_level_1(void) {
+    struct section* room = section_create(1, MAP_MAX_LINES);
+    if(room == NULL) return NULL;
+
+    for(int i = 0; i < map_lines; i++) {
+        if(section_add_map_wall(room, i)) {
+            section_destroy(room);
+            return NULL;
+        }
+    }
+
+    return room;
+}
+
+/**
+ * Adds the sliding doors of the first level. The door closing the gap in the upper
+ * corridor runs just inside it and slides along the wall to its left.
+ * 
+ * @param level The indexed level 1.
+ * @param doors The doors to fill.
+ * @return int 0 if the doors were added, or 1 if an error occurred.
+ */
+int create_level_1_doors(struct level* level, struct sliding_doors* doors) {
+    const double closed[4] = { 199, 49.5, 251, 49.5 }, open[4] = { 149, 49.5, 201, 49.5 };
+    const double color[3] = { 0, 255, 255 };
+
+    doors->count = 0;
+    return sliding_door_add(doors, level, level->start, closed, open, color);
+}
+
+/**
+ * Collects every section reachable from a start section through doors and assigns their ids.
+ * 
+ * @param level The level to fill.
+ * @param start The section the player spawns in.
+ * @return int 0 if the level was indexed, or 1 if an error occurred.
+ */
+int level_index(struct level* level, struct section* start) {
+    int capacity = 8;
+    level->start = start;
+    level->section_count = 0;
+    level->doors = NULL;
+    level->streamed_walls = 0;
+    level->sections = memory_alloc(MEMORY_LEVELS, sizeof(struct section*) * capacity);
+    if(level->sections == NULL) return 1;
+
+    // Breadth-first walk over the door graph; the sections array doubles as the queue
+    start->id = 0;
+    level->sections[level->section_count++] = start;
+    for(int head = 0; head < level->section_count; head++) {
+        struct section* current = level->sections[head];
+
+        for(int i = 0; i < current->door_count; i++) {
+            struct door* dest = current->doors[i].dest;
+            if(dest == NULL || dest->room == NULL) continue;
+
+            struct section* next = dest->room;
+            int seen = FALSE;
+            for(int j = 0; j < level->section_count && !seen; j++) seen = level->sections[j] == next;
+            if(seen) continue;
+
+            if(level->section_count == capacity) {
+                struct section** grown = memory_realloc(MEMORY_LEVELS, level->sections, sizeof(struct section*) * capacity * 2);
+                if(grown == NULL) return 1;
+                level->sections = grown;
+                capacity *= 2;
+            }
+            next->id = level->section_count;
+            level->sections[level->section_count++] = next;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Builds the broad-phase grid of every section of a level, and its compact
+ * quantized walls where they can be quantized accurately.
+ * 
+ * @param level The level, with the visible walls of its sections built.
+ * @return int 0 if every grid was built, or 1 if an error occurred.
+ */
+int level_build_grids(struct level* level) {
+    for(int i = 0; i < level->section_count; i++) {
+        if(section_build_grid(level->sections[i])) return 1;
+        section_build_quantized(level->sections[i]); // Optional: sections without it cast rays on doubles
+    }
+    return 0;
+}
+
+/**
+ * Returns the position of a value in an array.
+ * 
+ * @param values The array.
+ * @param count The number of values.
+ * @param value The value to find.
+ * @return int The index of the value, or -1 if it is absent.
+ */
+static int find_row(const int* values, int count, int value) {
+    for(int i = 0; i < count; i++)
+        if(values[i] == value) return i;
+    return -1;
+}
+
+/**
+ * Files a wall the section can see in its grid, rebuilding the grid if the wall
+ * reaches outside it.
+ * 
+ * @param section The section.
+ * @param row The map table row of the wall.
+ * @return int 0 if the grid is up to date, or 1 if an error occurred.
+ */
+static int grid_add_wall(struct section* section, int row) {
+    if(section->grid == NULL || grid_insert(section->grid, &map[0][0], row) == 0) return 0;
+    return section_build_grid(section);
+}
+
+/**
+ * Adds a wall to the map table and to a section, and to the indexes of every section
+ * that can see it. The grids are updated in place; the quantized copies of those
+ * sections are rebuilt, since the new wall may widen their bounding box.
+ * 
+ * @param level The level.
+ * @param section The section the wall belongs to.
+ * @param wall The wall as {x0, y0, xf, yf, r, g, b}.
+ * @return int The map table row of the wall, or -1 if an error occurred (the wall is then added nowhere).
+ */
+int level_add_wall(struct level* level, struct section* section, const double wall[7]) {
+    int row = map_add_wall(wall);
+    if(row < 0) return -1;
+    if(section_add_map_wall(section, row)) {
+        map_remove_wall(row);
+        return -1;
+    }
+
+    for(int i = 0; i < level->section_count; i++) {
+        struct section* viewer = level->sections[i];
+        if(!pvs_is_visible(viewer, section)) continue;
+
+        // On failure, take the wall back out of the map, the section and the viewers reached so far
+        int* grown = memory_realloc(MEMORY_PVS, viewer->visible_walls, sizeof(int) * (viewer->visible_wall_count + 1));
+        if(grown == NULL) {
+            level_remove_wall(level, row);
+            return -1;
+        }
+        viewer->visible_walls = grown;
+        viewer->visible_walls[viewer->visible_wall_count++] = row;
+
+        if(grid_add_wall(viewer, row)) {
+            level_remove_wall(level, row);
+            return -1;
+        }
+        if(viewer->quantized != NULL) section_build_quantized(viewer);
+    }
+
+    return row;
+}
+
+/**
+ * Moves a wall of the map table, e.g. a sliding door panel. Only the grid cells the wall
+ * leaves and enters and its quantized copy change, unless it moves outside a section's
+ * grid or quantized range, in which case that structure is rebuilt. Walls copied into
+ * streamed chunks cannot be moved, since the chunks would keep showing them where they were.
+ * 
+ * @param level The level.
+ * @param row The map table row of the wall.
+ * @param position The new endpoints as {x0, y0, xf, yf}.
+ * @return int 0 if every index was updated, or 1 if the wall is streamed or an error occurred.
+ */
+int level_move_wall(struct level* level, int row, const double position[4]) {
+    if(row < level->streamed_walls) return 1;
+    double previous[4] = { map[row][0], map[row][1], map[row][2], map[row][3] };
+    map_move_wall(row, position);
+
+    for(int i = 0; i < level->section_count; i++) {
+        struct section* section = level->sections[i];
+
+        int own = find_row(section->wall_ids, section->wall_count, row);
+        if(own >= 0) section->walls[own] = (struct line) { position[0], position[1], position[2], position[3] };
+
+        if(find_row(section->visible_walls, section->visible_wall_count, row) < 0) continue;
+
+        if(section->grid != NULL) grid_remove(section->grid, previous, row);
+        if(grid_add_wall(section, row)) return 1;
+
+        if(section->quantized != NULL) {
+            int index = find_row(section->quantized->rows, section->quantized->count, row);
+            if(index >= 0 && quantized_update(section->quantized, index)) section_build_quantized(section);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Removes a wall from the map table and from every section and index. The last wall of
+ * the table takes its row, so that wall is renamed wherever it is referenced, sliding
+ * door panels included. Removing a door panel removes its door. Walls copied into
+ * streamed chunks cannot be removed.
+ * 
+ * @param level The level.
+ * @param row The map table row of the wall.
+ * @return int 0 if the wall was removed, or 1 if it is streamed.
+ */
+int level_remove_wall(struct level* level, int row) {
+    int last = map_lines - 1;
+    if(row < level->streamed_walls) return 1;
+
+    for(int i = 0; i < level->section_count; i++) {
+        struct section* section = level->sections[i];
+
+        int own = find_row(section->wall_ids, section->wall_count, row);
+        if(own >= 0) {
+            section->wall_count--;
+            section->walls[own] = section->walls[section->wall_count];
+            section->wall_ids[own] = section->wall_ids[section->wall_count];
+        }
+
+        int visible = find_row(section->visible_walls, section->visible_wall_count, row);
+        if(visible < 0) continue;
+        section->visible_walls[visible] = section->visible_walls[--section->visible_wall_count];
+        if(section->grid != NULL) grid_remove(section->grid, map[row], row);
+        if(section->quantized != NULL) {
+            int index = find_row(section->quantized->rows, section->quantized->count, row);
+            if(index >= 0) quantized_remove(section->quantized, index);
+        }
+    }
+
+    map_remove_wall(row);
+    if(level->doors != NULL) sliding_doors_wall_removed(level->doors, row, last);
+    if(row == last) return 0;
+
+    for(int i = 0; i < level->section_count; i++) {
+        struct section* section = level->sections[i];
+
+        int own = find_row(section->wall_ids, section->wall_count, last);
+        if(own >= 0) section->wall_ids[own] = row;
+
+        int visible = find_row(section->visible_walls, section->visible_wall_count, last);
+        if(visible < 0) continue;
+        section->visible_walls[visible] = row;
+        if(section->grid != NULL) grid_rename(section->grid, map[row], last, row);
+        if(section->quantized != NULL) {
+            int index = find_row(section->quantized->rows, section->quantized->count, last);
+            if(index >= 0) section->quantized->rows[index] = row;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Destroys every section of a level and frees the level's index.
+ * 
+ * @param level The level to destroy.
+ */
+void level_destroy(struct level* level) {
+    for(int i = 0; i < level->section_count; i++) section_destroy(level->sections[i]);
+    memory_free(level->sections);
+    level->sections = NULL;
+    level->section_count = 0;
+    level->start = NULL;
+    level->doors = NULL;
+    level->streamed_walls = 0;
+}
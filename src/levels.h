@@ -3,8 +3,92 @@
 
 #include "section.h"
 
+struct sliding_doors;
+
+// Structure holding every section of a level, indexed by section id
+struct level {
+    struct section* start;       // Section the player spawns in
+    int section_count;           // Number of sections in the level
+    struct section** sections;   // Sections reachable from start, sections[i]->id == i
+    struct sliding_doors* doors; // Sliding doors whose panels are walls of the level, or NULL
+    int streamed_walls;          // Rows at the start of the map table copied into streamed chunks, which
+                                 // cannot be moved or removed (0 when not streaming)
+};
+
 // Function to create the first level of the game
 // Returns a pointer to the newly created section representing level 1
 struct section* create_level_1(void);
 
-#endif  // LEVELS_H
\ No newline at end of file
+/**
+ * Adds the sliding doors of the first level. The door closing the gap in the upper
+ * corridor runs just inside it and slides along the wall to its left.
+ * 
+ * @param level The indexed level 1.
+ * @param doors The doors to fill.
+ * @return int 0 if the doors were added, or 1 if an error occurred.
+ */
+int create_level_1_doors(struct level* level, struct sliding_doors* doors);
+
+/**
+ * Collects every section reachable from a start section through doors and assigns their ids.
+ * 
+ * @param level The level to fill.
+ * @param start The section the player spawns in.
+ * @return int 0 if the level was indexed, or 1 if an error occurred.
+ */
+int level_index(struct level* level, struct section* start);
+
+/**
+ * Builds the broad-phase grid of every section of a level, and its compact
+ * quantized walls where they can be quantized accurately.
+ * 
+ * @param level The level, with the visible walls of its sections built.
+ * @return int 0 if every grid was built, or 1 if an error occurred.
+ */
+int level_build_grids(struct level* level);
+
+/**
+ * Adds a wall to the map table and to a section, and to the indexes of every section
+ * that can see it. The grids are updated in place; the quantized copies of those
+ * sections are rebuilt, since the new wall may widen their bounding box.
+ * 
+ * @param level The level.
+ * @param section The section the wall belongs to.
+ * @param wall The wall as {x0, y0, xf, yf, r, g, b}.
+ * @return int The map table row of the wall, or -1 if an error occurred (the wall is then added nowhere).
+ */
+int level_add_wall(struct level* level, struct section* section, const double wall[7]);
+
+/**
+ * Moves a wall of the map table, e.g. a sliding door panel. Only the grid cells the wall
+ * leaves and enters and its quantized copy change, unless it moves outside a section's
+ * grid or quantized range, in which case that structure is rebuilt. Walls copied into
+ * streamed chunks cannot be moved, since the chunks would keep showing them where they were.
+ * 
+ * @param level The level.
+ * @param row The map table row of the wall.
+ * @param position The new endpoints as {x0, y0, xf, yf}.
+ * @return int 0 if every index was updated, or 1 if the wall is streamed or an error occurred.
+ */
+int level_move_wall(struct level* level, int row, const double position[4]);
+
+/**
+ * Removes a wall from the map table and from every section and index. The last wall of
+ * the table takes its row, so that wall is renamed wherever it is referenced, sliding
+ * door panels included. Removing a door panel removes its door. Walls copied into
+ * streamed chunks cannot be removed.
+ * 
+ * @param level The level.
+ * @param row The map table row of the wall.
+ * @return int 0 if the wall was removed, or 1 if it is streamed.
+ */
+int level_remove_wall(struct level* level, int row);
+
+/**
+ * Destroys every section of a level and frees the level's index.
+ * 
+ * @param level The level to destroy.
+ */
+void level_destroy(struct level* level);
+
+#endif  // LEVELS_H
@@ -1,4 +1,5 @@
 #include "linked_list.h"
+#include "memory.h"
 
 #include <stdlib.h>
 
@@ -8,7 +9,7 @@
  * @return struct linked_list_of_lines* Pointer to the newly created linked list, or NULL if memory allocation fails.
  */
 struct linked_list_of_lines* linked_list_create(void) {
-    struct linked_list_of_lines* new = malloc(sizeof(struct linked_list_of_lines));
+    struct linked_list_of_lines* new = memory_alloc(MEMORY_LISTS, sizeof(struct linked_list_of_lines));
     if(new == NULL) return NULL;
     new->head = NULL;
     return new;
@@ -22,7 +23,7 @@ struct linked_list_of_lines* linked_list_create(void) {
  * @return struct line_node* Pointer to the newly created node, or NULL if memory allocation fails.
  */
 static struct line_node* create_line_node(struct line value, struct line_node* next) {
-    struct line_node* new = malloc(sizeof(struct line_node));
+    struct line_node* new = memory_alloc(MEMORY_LISTS, sizeof(struct line_node));
     if(new == NULL) return NULL;
     new->value = value;
     new->next = next;
@@ -51,7 +52,7 @@ int linked_list_add_line(struct linked_list_of_lines* list, struct line new_line
 void destroy_list_recursive(struct line_node* first) {
     if(first == NULL) return;
     destroy_list_recursive(first->next);
-    free(first);
+    memory_free(first);
 }
 
 /**
@@ -62,5 +63,5 @@ void destroy_list_recursive(struct line_node* first) {
 void linked_list_destroy(struct linked_list_of_lines* list) {
     if(list == NULL) return;
     if(list->head != NULL) destroy_list_recursive(list->head);
-    free(list);
+    memory_free(list);
 }
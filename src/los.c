@@ -0,0 +1,149 @@
+#include <math.h>
+
+#include "constants.h"
+#include "map.h"
+#include "los.h"
+
+/**
+ * Returns the number of words of a visibility mask holding `count` results.
+ * 
+ * @param count The number of queries.
+ * @return int The number of unsigned int words needed.
+ */
+int los_mask_words(int count) {
+    return (count + LOS_WORD_BITS - 1) / LOS_WORD_BITS;
+}
+
+/**
+ * Checks whether a wall touches a segment.
+ * Uses segments_intersect rather than intersection_lines: a sight line is a bounded segment, not a ray.
+ * 
+ * @param wall The map table row of the wall.
+ * @param sight The segment.
+ * @return int 1 if the wall touches the segment, 0 otherwise.
+ */
+static int wall_blocks(int wall, struct line sight) {
+    struct line segment = { map[wall][0], map[wall][1], map[wall][2], map[wall][3] };
+    return segments_intersect(sight, segment);
+}
+
+/**
+ * Checks whether a segment is free of walls, testing every one of them.
+ * This is the reference every accelerated query must agree with.
+ * 
+ * @param walls The map table rows to test, or NULL to test rows 0 to count - 1.
+ * @param count The number of walls to test.
+ * @param from The start of the segment.
+ * @param to The end of the segment.
+ * @return int 1 if no wall touches the segment, 0 otherwise.
+ */
+int los_reference(const int* walls, int count, struct point from, struct point to) {
+    struct line sight = { from.x, from.y, to.x, to.y };
+    for(int k = 0; k < count; k++)
+        if(wall_blocks(walls != NULL ? walls[k] : k, sight)) return FALSE;
+    return TRUE;
+}
+
+/**
+ * Checks whether a segment is free of walls, walking only the grid cells it crosses
+ * and stopping at the first wall that touches it. Safe to call from several threads.
+ * 
+ * @param grid The grid indexing the walls.
+ * @param from The start of the segment.
+ * @param to The end of the segment.
+ * @return int 1 if no wall touches the segment, 0 otherwise.
+ */
+int los_visible(const struct wall_grid* grid, struct point from, struct point to) {
+    struct line sight = { from.x, from.y, to.x, to.y };
+    double origin[2] = { from.x, from.y };
+    double dir[2] = { to.x - from.x, to.y - from.y }; // Not normalized: t runs from 0 at `from` to 1 at `to`
+    double low[2] = { grid->min_x, grid->min_y };
+    double high[2] = { grid->min_x + grid->columns * grid->cell_size, grid->min_y + grid->rows * grid->cell_size };
+    double t_enter = 0, t_leave = 1;
+
+    // Clip the segment to the grid bounds: every wall lies inside them
+    for(int axis = 0; axis < 2; axis++) {
+        if(dir[axis] == 0) {
+            if(origin[axis] < low[axis] || origin[axis] > high[axis]) return TRUE;
+            continue;
+        }
+        double t0 = (low[axis] - origin[axis]) / dir[axis];
+        double t1 = (high[axis] - origin[axis]) / dir[axis];
+        t_enter = fmax(t_enter, fmin(t0, t1));
+        t_leave = fmin(t_leave, fmax(t0, t1));
+    }
+    if(t_enter > t_leave) return TRUE;
+
+    // Walk the cells between the clipped endpoints
+    int cell[2] = { grid_column(grid, from.x + t_enter * dir[0]), grid_row(grid, from.y + t_enter * dir[1]) };
+    int last[2] = { grid_column(grid, from.x + t_leave * dir[0]), grid_row(grid, from.y + t_leave * dir[1]) };
+    int step[2];
+    double t_max[2], t_delta[2];
+    for(int axis = 0; axis < 2; axis++) {
+        step[axis] = dir[axis] > 0 ? 1 : -1;
+        if(dir[axis] == 0) {
+            t_max[axis] = INFINITY;
+            t_delta[axis] = INFINITY;
+            continue;
+        }
+        double boundary = low[axis] + (cell[axis] + (step[axis] > 0)) * grid->cell_size;
+        t_max[axis] = (boundary - origin[axis]) / dir[axis];
+        t_delta[axis] = grid->cell_size / fabs(dir[axis]);
+    }
+
+    for(;;) {
+        const struct grid_cell* current = &grid->cells[cell[1] * grid->columns + cell[0]];
+        for(int i = 0; i < current->count; i++)
+            if(wall_blocks(current->walls[i], sight)) return FALSE; // First blocker settles it
+
+        if(cell[0] == last[0] && cell[1] == last[1]) return TRUE;
+        int axis = t_max[0] < t_max[1] ? 0 : 1;
+        if(t_max[axis] > t_leave) return TRUE;
+        cell[axis] += step[axis];
+        t_max[axis] += t_delta[axis];
+        if(cell[0] < 0 || cell[0] >= grid->columns || cell[1] < 0 || cell[1] >= grid->rows) return TRUE;
+    }
+}
+
+// Arguments of a parallel batch of line-of-sight queries
+struct los_job {
+    const struct wall_grid* grid;       // The grid indexing the walls
+    const struct los_query* queries;    // The queries
+    int count;                          // The number of queries
+    unsigned int* visible;              // The visibility mask (output)
+};
+
+/**
+ * Job pool adapter answering the queries of mask words [first, last).
+ * Each job owns whole words, so no two threads write the same word.
+ * 
+ * @param context The los_job.
+ * @param first The first mask word to fill.
+ * @param last One past the last mask word to fill.
+ */
+static void los_job_words(void* context, int first, int last) {
+    struct los_job* job = context;
+    for(int word = first; word < last; word++) {
+        unsigned int bits = 0;
+        int base = word * LOS_WORD_BITS;
+        int end = base + LOS_WORD_BITS < job->count ? base + LOS_WORD_BITS : job->count;
+        for(int i = base; i < end; i++)
+            if(los_visible(job->grid, job->queries[i].from, job->queries[i].to)) bits |= 1u << (i - base);
+        job->visible[word] = bits;
+    }
+}
+
+/**
+ * Answers a batch of line-of-sight queries in parallel chunks of LOS_CHUNK_SIZE.
+ * Bit (i % LOS_WORD_BITS) of visible[i / LOS_WORD_BITS] is set when query i is visible.
+ * 
+ * @param grid The grid indexing the walls.
+ * @param pool The worker pool, or NULL to answer on the calling thread.
+ * @param queries The queries.
+ * @param count The number of queries.
+ * @param visible The visibility mask, los_mask_words(count) words long (output).
+ */
+void los_batch(const struct wall_grid* grid, struct job_pool* pool, const struct los_query* queries, int count, unsigned int* visible) {
+    struct los_job job = { grid, queries, count, visible };
+    jobs_parallel_for(pool, los_mask_words(count), LOS_CHUNK_SIZE / LOS_WORD_BITS, los_job_words, &job);
+}
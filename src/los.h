@@ -0,0 +1,60 @@
+#ifndef LOS_H
+#define LOS_H
+
+#include "algebra.h"
+#include "grid.h"
+#include "jobs.h"
+
+// Number of query results packed in each word of a visibility mask
+#define LOS_WORD_BITS 32
+
+// Line-of-sight query: can an observer at `from` see `to`?
+struct los_query {
+    struct point from;  // Position of the observer
+    struct point to;    // Position of the target
+};
+
+/**
+ * Returns the number of words of a visibility mask holding `count` results.
+ * 
+ * @param count The number of queries.
+ * @return int The number of unsigned int words needed.
+ */
+int los_mask_words(int count);
+
+/**
+ * Checks whether a segment is free of walls, testing every one of them.
+ * This is the reference every accelerated query must agree with.
+ * 
+ * @param walls The map table rows to test, or NULL to test rows 0 to count - 1.
+ * @param count The number of walls to test.
+ * @param from The start of the segment.
+ * @param to The end of the segment.
+ * @return int 1 if no wall touches the segment, 0 otherwise.
+ */
+int los_reference(const int* walls, int count, struct point from, struct point to);
+
+/**
+ * Checks whether a segment is free of walls, walking only the grid cells it crosses
+ * and stopping at the first wall that touches it. Safe to call from several threads.
+ * 
+ * @param grid The grid indexing the walls.
+ * @param from The start of the segment.
+ * @param to The end of the segment.
+ * @return int 1 if no wall touches the segment, 0 otherwise.
+ */
+int los_visible(const struct wall_grid* grid, struct point from, struct point to);
+
+/**
+ * Answers a batch of line-of-sight queries in parallel chunks of LOS_CHUNK_SIZE.
+ * Bit (i % LOS_WORD_BITS) of visible[i / LOS_WORD_BITS] is set when query i is visible.
+ * 
+ * @param grid The grid indexing the walls.
+ * @param pool The worker pool, or NULL to answer on the calling thread.
+ * @param queries The queries.
+ * @param count The number of queries.
+ * @param visible The visibility mask, los_mask_words(count) words long (output).
+ */
+void los_batch(const struct wall_grid* grid, struct job_pool* pool, const struct los_query* queries, int count, unsigned int* visible);
+
+#endif
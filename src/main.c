@@ -7,36 +7,75 @@
 #include "player.h"    // Player structure and functions
 #include "algebra.h"     // Utility functions for the game
 #include "gametime.h"  // Time handling functions
+#include "video.h"     // Background frame streaming
+#include "simulation.h" // Simulation thread and snapshot triple buffer
+#include "map.h"       // Map wall table
+#include "topdown.h"   // Top-down debug view
+#include "levels.h"    // Sections making up the level
+#include "pvs.h"       // Potentially visible sets of the sections
+#include "raycast.h"   // Ray casting kernels
+#include "span.h"      // Segment-projection engine
+#include "visibility.h" // Visibility polygons
+#include "quantized.h" // Compact wall storage
+#include "chunks.h"    // Background world streaming
+#include "doors.h"     // Sliding doors
+#include "trig.h"      // Trigonometry tables
+#include "sky.h"       // Precomputed sky and jump offsets
+#include "memory.h"    // Allocation accounting
 
-// Map definition: simple 2D array representing lines with their RGB color values
-const int map_lines = 17;
-double map[100][7] = {
-    {10, 10, 300, 10, 255, 0, 0},       // Top horizontal wall
-    {10, 10, 10, 300, 255, 0, 0},       // Left vertical wall
-    {300, 10, 300, 300, 255, 0, 0},     // Right vertical wall
-    // Internal walls
-    {50,  10,  50,  100, 0,   255, 0},       // Vertical wall left
-    {50,  100, 100, 100, 0,   255, 0},     // Horizontal section
-    {100, 100, 100, 200, 0,   255, 0},    // Vertical wall middle left
-    {150, 50,  150, 150, 0,   255, 0},     // Vertical wall middle
-    {150, 150, 200, 150, 0,   255, 0},    // Horizontal section
-    {100, 200, 200, 200, 0,   0,   255},    // Horizontal wall middle bottom
-    {200, 200, 200, 250, 0,   0,   255},    // Vertical wall near bottom
-    {200, 250, 250, 250, 0,   0,   255},    // Bottom right horizontal section
-    {250, 50,  250, 150, 255, 255, 0},   // Vertical wall middle right
-    {250, 50,  300, 50,  255, 255, 0},    // Top-right horizontal wall
-    {150, 150, 150, 200, 0,   255, 255},  // Vertical middle wall extension
-    {200, 50,  150, 50,  0,   255, 255},    // Horizontal upper middle wall
-    {50,  250, 150, 250, 0,   255, 255},   // Horizontal lower middle wall
-    {50,  150, 50,  200, 255, 0,   255},    // Vertical left-bottom wall
-};
+// Global variable to track the game state (running or not)
+int game_is_running = FALSE;
 
+// Optional stream receiving every rendered frame (NULL when streaming is disabled)
+struct video_stream* video_stream = NULL;
 
-// External variables defined in player.h
-extern struct player player;
+// Simulation running on its own thread; the render loop only reads its snapshots
+struct simulation simulation;
 
-// Global variable to track the game state (running or not)
-int game_is_running = FALSE;
+// Input collected by the render thread, handed to the simulation once per frame
+struct sim_input input;
+
+// Pan/zoom state and cached wall layer of the top-down view
+struct topdown_view topdown;
+
+// Sections of the current level (section_count is 0 if the level failed to load)
+struct level level;
+
+// Sliding doors of the current level, opened by the simulation and moved by the renderer
+struct sliding_doors doors;
+
+// Sky panorama and per-column jump offsets of the first-person views
+struct sky sky;
+
+// Kernel used to cast the camera rays, cycled with P
+enum cast_mode cast_mode = CAST_PACKET;
+
+// View drawn every frame, cycled with M
+enum render_mode render_mode = START_RENDER_MODE;
+
+// Draw functions of the views, defined with the rendering code below
+void render_first_person(SDL_Renderer* renderer, const struct player* view);
+void render_top_down(SDL_Renderer* renderer, const struct player* view);
+void render_split(SDL_Renderer* renderer, const struct player* view);
+
+// Behaviour of a view, looked up once per frame rather than tested inside the drawing loops
+struct render_mode_info {
+    void (*draw)(SDL_Renderer* renderer, const struct player* view); // Draws the view over the background
+    int mouse_look;     // 1 if relative mouse movement turns the player, 0 if the player faces the cursor
+    int shows_map;      // 1 if the view shows the top-down map (arrow keys pan it, the wheel zooms it)
+    int sky_width;      // Screen columns spanned by the field of view in the sky and floor behind the view
+};
+
+// Views selectable with M, indexed by enum render_mode
+const struct render_mode_info render_modes[RENDER_MODE_COUNT] = {
+    [RENDER_FIRST_PERSON] = { render_first_person, TRUE, FALSE, WINDOW_WIDTH },
+    [RENDER_TOP_DOWN] = { render_top_down, FALSE, TRUE, WINDOW_WIDTH },
+    [RENDER_SPLIT] = { render_split, TRUE, TRUE, WINDOW_WIDTH / 2 },
+};
+
+// Chunks of the world loaded in the background around the player (only updated if streaming started)
+struct chunk_streamer streamer;
+int streaming = FALSE;
 
 /* 
     Function to initialize SDL, create a window, and create a renderer.
@@ -75,33 +114,86 @@ int initialize_window(SDL_Window** window, SDL_Renderer** renderer) {
         return FALSE;
     }
     
-    // If in first-person mode, lock the mouse and enable blending mode
-    if(FIRST_PERSON) {
-        SDL_SetRelativeMouseMode(SDL_TRUE); // Hide cursor and track relative mouse movement
-        SDL_SetRenderDrawBlendMode(*renderer, SDL_BLENDMODE_BLEND); // Enable blending for transparency
-    }
+    SDL_SetRenderDrawBlendMode(*renderer, SDL_BLENDMODE_BLEND); // Enable blending for transparency
 
     return TRUE; // Initialization succeeded
 }
 
+/* 
+    Loads level 1 and its potentially visible sets.
+    The sets are read from PVS_FILE (written offline by pvs.out) and computed on the spot if the file is missing.
+    Returns: 
+        - TRUE (1) if the level was loaded,
+        - FALSE (0) otherwise; the whole map is then rendered without visibility culling.
+*/
+int load_level(void) {
+    struct map_simplify_report report;
+    map_simplify(&report); // Fewer, longer walls for every ray and collision query
+    fprintf(stderr, "Map: %d walls simplified to %d (%d merged, %d duplicates, %d zero-length).\n",
+        report.before, report.after, report.merged, report.duplicates, report.zero_length);
+
+    struct section* start = create_level_1();
+    if(start == NULL || level_index(&level, start)) {
+        fprintf(stderr, "Error building level.\n");
+        return FALSE;
+    }
+
+    if(pvs_load(&level, PVS_FILE)) {
+        fprintf(stderr, "No precomputed visibility in %s, computing it now.\n", PVS_FILE);
+        if(pvs_compute(&level)) return FALSE;
+    }
+
+    if(pvs_build_visible_walls(&level) || level_build_grids(&level)) return FALSE;
+
+    if(create_level_1_doors(&level, &doors))
+        fprintf(stderr, "Error adding the sliding doors.\n"); // The level stays playable without them
+    return TRUE;
+}
+
 // Setup function to initialize game objects like the player
 void setup(void) {
+    trig_init(); // Fill the sine table before the simulation thread moves the player
+    if(load_level()) {
+        set_player_spawn(level.start); // Track the player's section so only its PVS is considered
+        simulation.doors = &doors; // Let the simulation open the doors the player walks up to
+    }
     setup_player(); // Initialize player properties (position, speed, etc.)
+    topdown_init(&topdown); // Start the top-down view unpanned and unzoomed
+}
+
+/* 
+    Switches the view, capturing the mouse in the views where it turns the player.
+    Parameters:
+        - enum render_mode mode: the new view
+*/
+void set_render_mode(enum render_mode mode) {
+    render_mode = mode;
+    SDL_SetRelativeMouseMode(render_modes[mode].mouse_look ? SDL_TRUE : SDL_FALSE); // Hide cursor and track relative mouse movement
 }
 
 /* 
     Function to process user input events from SDL.
-    Handles keyboard and mouse events to control player movement and actions.
+    Handles keyboard and mouse events and forwards the resulting input to the simulation thread.
 */
 void process_inputs() {
+    memory_frame_begin(); // From here to the end of render, the frame must not touch the heap
+
     SDL_Event event; // SDL event structure
     SDL_PollEvent(&event); // Poll for events (non-blocking)
     
     static int mouse_x = 0, mouse_y = 0; // Static variables to track mouse position
     
-    if(!FIRST_PERSON) { // If not in first-person mode, get mouse position for rotating player
+    const struct render_mode_info* mode = &render_modes[render_mode];
+
+    if(!mode->mouse_look) { // Without mouse look, the player faces the cursor
+        double target[2];
         SDL_GetMouseState(&mouse_x, &mouse_y);
-        rotate_player_towards(mouse_x, mouse_y); // Rotate player towards mouse position
+        topdown_to_world(&topdown, mouse_x, mouse_y, target); // Undo the view pan/zoom
+        input.look_at = TRUE; // Rotate player towards mouse position on the next tick
+        input.look_x = target[0];
+        input.look_y = target[1];
+    } else {
+        input.look_at = FALSE; // Stop facing the cursor of a previous view
     }
 
     // Handle different types of events (e.g., keypress, quit)
@@ -112,157 +204,299 @@ void process_inputs() {
         case SDL_KEYDOWN: // Key press event
             // Handle specific key actions (e.g., movement, jump, reset)
             if(event.key.keysym.sym == SDLK_ESCAPE) game_is_running = FALSE; // ESC quits game
-            if(event.key.keysym.sym == SDLK_w) player.move_set.front = TRUE;  // W moves player forward
-            if(event.key.keysym.sym == SDLK_d) player.move_set.right = TRUE;  // D moves player right
-            if(event.key.keysym.sym == SDLK_s) player.move_set.back = TRUE;   // S moves player back
-            if(event.key.keysym.sym == SDLK_a) player.move_set.left = TRUE;   // A moves player left
-            if(event.key.keysym.sym == SDLK_SPACE) player.move_set.jump = TRUE; // Space makes the player jump
-            if(event.key.keysym.sym == SDLK_r) setup_player(); // R resets player position
+            if(event.key.keysym.sym == SDLK_w) input.move_set.front = TRUE;  // W moves player forward
+            if(event.key.keysym.sym == SDLK_d) input.move_set.right = TRUE;  // D moves player right
+            if(event.key.keysym.sym == SDLK_s) input.move_set.back = TRUE;   // S moves player back
+            if(event.key.keysym.sym == SDLK_a) input.move_set.left = TRUE;   // A moves player left
+            if(event.key.keysym.sym == SDLK_SPACE) input.move_set.jump = TRUE; // Space makes the player jump
+            if(event.key.keysym.sym == SDLK_r) input.reset = TRUE; // R resets player position
+            if(event.key.keysym.sym == SDLK_p) cast_mode = (cast_mode + 1) % CAST_MODE_COUNT; // P cycles the ray casting kernel
+            if(event.key.keysym.sym == SDLK_m) set_render_mode((render_mode + 1) % RENDER_MODE_COUNT); // M cycles the view
+
+            if(mode->shows_map) { // Arrow keys pan the top-down view
+                if(event.key.keysym.sym == SDLK_LEFT) topdown_pan(&topdown, -TOPDOWN_PAN_STEP, 0);
+                if(event.key.keysym.sym == SDLK_RIGHT) topdown_pan(&topdown, TOPDOWN_PAN_STEP, 0);
+                if(event.key.keysym.sym == SDLK_UP) topdown_pan(&topdown, 0, -TOPDOWN_PAN_STEP);
+                if(event.key.keysym.sym == SDLK_DOWN) topdown_pan(&topdown, 0, TOPDOWN_PAN_STEP);
+            }
 
             break;
         case SDL_KEYUP: // Key release event (stop movement when key is released)
-            if(event.key.keysym.sym == SDLK_w) player.move_set.front = FALSE;
-            if(event.key.keysym.sym == SDLK_d) player.move_set.right = FALSE;
-            if(event.key.keysym.sym == SDLK_s) player.move_set.back = FALSE;
-            if(event.key.keysym.sym == SDLK_a) player.move_set.left = FALSE;
-            if(event.key.keysym.sym == SDLK_SPACE) player.move_set.jump = FALSE;
+            if(event.key.keysym.sym == SDLK_w) input.move_set.front = FALSE;
+            if(event.key.keysym.sym == SDLK_d) input.move_set.right = FALSE;
+            if(event.key.keysym.sym == SDLK_s) input.move_set.back = FALSE;
+            if(event.key.keysym.sym == SDLK_a) input.move_set.left = FALSE;
+            if(event.key.keysym.sym == SDLK_SPACE) input.move_set.jump = FALSE;
             break;
 
         case SDL_MOUSEMOTION: // Mouse movement event
-            if(FIRST_PERSON) { // In first-person mode, use relative mouse movement for rotation
+            if(mode->mouse_look) { // Relative mouse movement turns the player
                 SDL_GetRelativeMouseState(&mouse_x, &mouse_y); // Get mouse motion since last frame
-                player.rotation = -mouse_x * MOUSE_SENSITIVITY; // Apply sensitivity scaling to rotation
+                input.rotation = -mouse_x * MOUSE_SENSITIVITY; // Apply sensitivity scaling to rotation
             }
             break;
+        case SDL_MOUSEWHEEL: // Mouse wheel zooms the top-down view around the cursor (the center when the cursor is hidden)
+            if(mode->shows_map && mode->mouse_look)
+                topdown_zoom(&topdown, event.wheel.y > 0 ? TOPDOWN_ZOOM_STEP : 1 / TOPDOWN_ZOOM_STEP, WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2);
+            else if(mode->shows_map)
+                topdown_zoom(&topdown, event.wheel.y > 0 ? TOPDOWN_ZOOM_STEP : 1 / TOPDOWN_ZOOM_STEP, mouse_x, mouse_y);
+            break;
         default:
-            player.rotation = 0; // Reset rotation if no mouse motion
+            input.rotation = 0; // Reset rotation if no mouse motion
     }
+
+    simulation_set_input(&simulation, &input); // Hand the input to the simulation thread
+    input.reset = FALSE; // The reset request is delivered once
 }
 
 /* 
-    Update game state based on time elapsed (delta time).
-    Mainly updates player position and movement.
+    Casts a fan of rays through the grids of the streamed chunks around the player, as packets
+    or one by one in grid mode, and against the walls added after the chunks were exported
+    (the door panels, which move and so are in no chunk, and any wall added at runtime).
+    Parameters:
+        - const struct player* view: the player snapshot to cast from
+        - double (*directions)[2]: the unit direction of each ray
+        - int count: the number of rays
+        - double plane_vector[2]: the camera plane
+        - struct ray_hit hits[]: the closest hit of each ray (output)
+    Returns:
+        - TRUE (1) if the rays were cast,
+        - FALSE (0) if not streaming, or the chunks around the player are not all resident yet.
 */
-void update() {
-    double delta = get_delta_time(); // Get time elapsed since last frame
-    update_player(delta); // Update player position and physics based on input and delta time
+int cast_chunks(const struct player* view, double (*directions)[2], int count, double plane_vector[2], struct ray_hit hits[]) {
+    static struct ray_hit chunk_hits[RAYS_NUMBER]; // Hits within one chunk, merged into hits
+    const struct wall_grid* grids[CHUNK_AREA];
+    int added[MAP_MAX_LINES], added_count = 0;
+
+    int grid_count = streaming ? chunk_streamer_gather(&streamer, view->x, view->y, grids) : -1;
+    if(grid_count < 0) return FALSE;
+
+    for(int row = streamer.wall_count; row < map_lines; row++) added[added_count++] = row;
+    for(int i = 0; i < count; i++)
+        raycast_reference(added, added_count, directions[i], view->x, view->y, plane_vector, &hits[i]);
+
+    for(int g = 0; g < grid_count; g++) {
+        if(cast_mode == CAST_GRID) {
+            for(int i = 0; i < count; i++)
+                raycast_grid(grids[g], directions[i], view->x, view->y, plane_vector, &chunk_hits[i]);
+        } else {
+            for(int i = 0; i < count; i += RAY_PACKET_SIZE) {
+                int packet = count - i < RAY_PACKET_SIZE ? count - i : RAY_PACKET_SIZE;
+                raycast_packet(grids[g], &directions[i], packet, view->x, view->y, plane_vector, &chunk_hits[i]);
+            }
+        }
+        for(int i = 0; i < count; i++)
+            if(chunk_hits[i].distance < hits[i].distance) hits[i] = chunk_hits[i];
+    }
+
+    return TRUE;
 }
 
 /* 
-    Renders the 2D top-down map showing lines from the map array.
-    Only renders if not in first-person mode.
+    Casts every `stride`-th of the RAYS_NUMBER rays from the player's viewpoint with the
+    selected kernel, so a view drawing fewer columns casts only the rays it draws.
+    In grid and packet modes, rays go through the streamed chunks once those around the
+    player are resident. Otherwise they go through the grid of the player's section when
+    there is one, and are tested against every wall of the section's potentially visible set
+    when there is none.
+    Parameters:
+        - const struct player* view: the player snapshot to cast from
+        - double plane_vector[2]: the camera plane
+        - int stride: rays per cast ray (1 casts them all)
+        - struct ray_hit hits[]: the closest hit of each cast ray, RAYS_NUMBER / stride of them (output)
 */
-void render_map(SDL_Renderer* renderer) {
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // Set color to white for lines
-    for(int i = 0; i < map_lines; i++) { // Loop through all lines in the map
-        SDL_RenderDrawLine(renderer, map[i][0], map[i][1], map[i][2], map[i][3]); // Draw each line
+void cast_rays(const struct player* view, double plane_vector[2], int stride, struct ray_hit hits[]) {
+    static double directions[RAYS_NUMBER][2]; // Unit direction of each ray
+    int count = RAYS_NUMBER / stride; // Number of rays cast
+    double angle_off = FOV / RAYS_NUMBER * stride; // Calculate angle step for each ray
+
+    // The first ray looks FOV/2 left of the view, each next one is the previous turned right
+    trig_direction_fan(view->angle + (FOV/2), -angle_off, count, directions);
+
+    // Only walls in the potentially visible set of the player's section can be hit
+    const int* candidates = view->section != NULL ? view->section->visible_walls : NULL;
+    int candidate_count = candidates != NULL ? view->section->visible_wall_count : map_lines;
+
+    if((cast_mode == CAST_GRID || cast_mode == CAST_PACKET) && cast_chunks(view, directions, count, plane_vector, hits))
+        return;
+
+    const struct wall_grid* grid = view->section != NULL ? view->section->grid : NULL;
+    // Project the walls instead of casting rays; too many candidates fall back to rays
+    if(cast_mode == CAST_SPANS && span_cast(candidates, candidate_count, view->angle, view->x, view->y, plane_vector, count, hits) >= 0)
+        return;
+
+    if(cast_mode == CAST_QUANTIZED && view->section != NULL && view->section->quantized != NULL) {
+        for(int i = 0; i < count; i++)
+            raycast_quantized(view->section->quantized, directions[i], view->x, view->y, plane_vector, &hits[i]);
+    } else if(grid == NULL || cast_mode == CAST_REFERENCE || cast_mode == CAST_QUANTIZED) {
+        for(int i = 0; i < count; i++)
+            raycast_reference(candidates, candidate_count, directions[i], view->x, view->y, plane_vector, &hits[i]);
+    } else if(cast_mode == CAST_GRID) {
+        for(int i = 0; i < count; i++)
+            raycast_grid(grid, directions[i], view->x, view->y, plane_vector, &hits[i]);
+    } else if(cast_mode == CAST_ADAPTIVE) { // Cast every Nth column and refine only at edges
+        raycast_adaptive(grid, directions, count, view->x, view->y, plane_vector, ADAPTIVE_STEP, hits);
+    } else { // Neighbouring columns almost always hit the same walls: trace them as packets
+        for(int i = 0; i < count; i += RAY_PACKET_SIZE) {
+            int packet = count - i < RAY_PACKET_SIZE ? count - i : RAY_PACKET_SIZE;
+            raycast_packet(grid, &directions[i], packet, view->x, view->y, plane_vector, &hits[i]);
+        }
     }
 }
 
 /* 
-    Renders the camera (3D view) using raycasting.
-    Casts rays from the player's viewpoint, calculates intersections with walls, 
-    and renders vertical slices representing walls.
+    Renders the visible area of the top-down view.
+    Computes the exact visibility polygon of the player's field of view and fills it
+    in one geometry call, instead of casting one ray per screen column.
+    Parameters:
+        - SDL_Renderer* renderer: the renderer used for drawing
+        - const struct player* view: the player snapshot to render from
 */
-void render_camera(SDL_Renderer* renderer) {
-    double intersection[2]; // Array to store intersection points
-    double angle_off =  FOV / RAYS_NUMBER; // Calculate angle step for each ray
-
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // Set draw color for rays
-    double smallest_intersection[4] = { 0 , 0 , INFINITY, player.angle}; // Track closest intersection
-    double angle, height, distance;
-    double plane_vector[2] = {
-        cos(player.angle + PI/2), // Vector perpendicular to player's view direction
-        sin(player.angle + PI/2)
-    };
-
-    // Cast rays to detect walls
-    for(int i = 0; i < RAYS_NUMBER; i++) {
-        int wall_index = 0; // Index of the closest wall for this ray
-        for(int j = 0; j < map_lines; j++) { // Loop through all walls in the map
-            angle = player.angle + (FOV/2) - (angle_off * i); // Calculate ray angle
-            normalize_angle(&angle); // Ensure angle is within 0 to 2*PI
-            if(intersection_lines(angle, player.x, player.y, map[j], intersection)) { // Check if ray hits a wall
-                distance = distance_from_line(plane_vector, player.x - intersection[0], player.y - intersection[1]); // Calculate perpendicular distance to wall
-                if(distance < smallest_intersection[2]) { // Track the closest intersection
-                    smallest_intersection[0] = intersection[0];
-                    smallest_intersection[1] = intersection[1];
-                    smallest_intersection[2] = distance;
-                    smallest_intersection[3] = angle;
-                    wall_index = j; // Store index of the wall hit
-                }
-            }
-        }
+void render_visibility(SDL_Renderer* renderer, const struct player* view) {
+    static struct visibility_polygon polygon; // Too large for the stack; reused every frame
+
+    // Only walls in the potentially visible set of the player's section can be seen
+    const int* candidates = view->section != NULL ? view->section->visible_walls : NULL;
+    int candidate_count = candidates != NULL ? view->section->visible_wall_count : map_lines;
+
+    if(visibility_compute(candidates, candidate_count, view->x, view->y, view->angle - FOV/2, FOV, VISIBILITY_RADIUS, &polygon) == 0)
+        topdown_draw_visibility(&topdown, renderer, &polygon); // Whole lit area in one geometry call
+    topdown_draw_player(&topdown, renderer, view); // Player marker in one polyline call
+}
+
+/* 
+    Column kernel shared by the first-person views: draws the wall slice hit by every
+    ray cast with `stride`, from column `right_edge` leftwards, one screen column per ray.
+    Each view calls it with constant arguments through its own wrapper, so the compiler
+    can specialize the loop per view; nothing in the loop depends on the render mode.
+    Parameters:
+        - SDL_Renderer* renderer: the renderer used for drawing
+        - const struct ray_hit hits[]: the closest hit of each cast ray
+        - const struct player* view: the player snapshot rendered
+        - int stride: the stride the rays were cast with
+        - int right_edge: screen column of the first ray
+*/
+static inline void draw_columns(SDL_Renderer* renderer, const struct ray_hit hits[], const struct player* view, const int stride, const int right_edge) {
+    for(int i = 0; i < RAYS_NUMBER / stride; i++) {
+        const double* wall = hits[i].row; // Closest wall for this ray, from the map table or a chunk
 
         // If an intersection was found, render the wall slice
-        if(smallest_intersection[2] != INFINITY) {
-            float color = smallest_intersection[2] > 600 ? 0.01 : (1 - smallest_intersection[2] / 600); // Diminish brightness with distance
-            
-            if(FIRST_PERSON) {
-                SDL_SetRenderDrawColor(renderer, map[wall_index][4]*color, map[wall_index][5]*color, map[wall_index][6]*color, 255); // Set wall color
-                height = WINDOW_HEIGHT / (smallest_intersection[2] / WALL_SIZE); // Calculate wall height
-
-                // Calculate vertical position of the wall slice
-                int yi = WINDOW_HEIGHT - FLOOR_SIZE - height / 2;
-                float jump_offset = + 0.7 * player.z * cos(((i - WINDOW_WIDTH/8) * FOV / WINDOW_WIDTH) / 4); // Adjust wall slice based on player's jump offset
-                SDL_RenderDrawLine(renderer, WINDOW_WIDTH - i, yi + player.z + jump_offset, WINDOW_WIDTH - i, yi + height + player.z + jump_offset); // Draw vertical slice of wall
-            } else {
-                SDL_SetRenderDrawColor(renderer, 255 * color, 255 * color, 255 * color, 255); // Set ray color for debugging
-                SDL_RenderDrawLine(renderer, player.x, player.y, smallest_intersection[0], smallest_intersection[1]); // Draw ray from player to intersection
-            }
+        if(wall != NULL) {
+            float color = hits[i].distance > VIEW_DISTANCE ? 0.01 : (1 - hits[i].distance / VIEW_DISTANCE); // Diminish brightness with distance
+            SDL_SetRenderDrawColor(renderer, wall[4]*color, wall[5]*color, wall[6]*color, 255); // Set wall color
+            double height = WINDOW_HEIGHT / (hits[i].distance / WALL_SIZE); // Calculate wall height
+
+            // Calculate vertical position of the wall slice
+            int yi = WINDOW_HEIGHT - FLOOR_SIZE - height / 2;
+            float jump_offset = sky_jump_offset(&sky, i * stride, view->z); // Adjust wall slice based on player's jump offset
+            int x = right_edge - i;
+            SDL_RenderDrawLine(renderer, x, yi + view->z + jump_offset, x, yi + height + view->z + jump_offset); // Draw vertical slice of wall
         }
-
-        // Reset smallest intersection values for the next ray
-        smallest_intersection[0] = 0;
-        smallest_intersection[1] = 0;
-        smallest_intersection[2] = INFINITY;
     }
+}
 
-    if(!FIRST_PERSON) {
-        SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // Set ray color for debugging
-        
-        SDL_RenderDrawLine(renderer, player.x + 10*cos(player.angle) - 10*plane_vector[0], player.y+10*sin(player.angle) - 10*plane_vector[1], player.x + 10*cos(player.angle) + 10*plane_vector[0], player.y+10*sin(player.angle) + 10*plane_vector[1]); // Draw ray from player to intersection
-    }
+/* 
+    Casts the camera rays of a player snapshot with the selected kernel.
+    Parameters:
+        - const struct player* view: the player snapshot to cast from
+        - int stride: rays per cast ray (1 casts them all)
+        - struct ray_hit hits[]: the closest hit of each cast ray (output)
+*/
+void cast_camera(const struct player* view, int stride, struct ray_hit hits[]) {
+    double sine, cosine;
+    trig_sincos_batch(&view->angle, &sine, &cosine, 1);
+    double plane_vector[2] = { -sine, cosine }; // Vector perpendicular to player's view direction
+    cast_rays(view, plane_vector, stride, hits); // Cast rays to detect walls
+}
+
+/* 
+    First-person view: one wall slice per ray over the whole window.
+    Parameters:
+        - SDL_Renderer* renderer: the renderer used for drawing
+        - const struct player* view: the player snapshot to render from
+*/
+void render_first_person(SDL_Renderer* renderer, const struct player* view) {
+    static struct ray_hit hits[RAYS_NUMBER]; // Closest hit of each column
+    cast_camera(view, 1, hits);
+    draw_columns(renderer, hits, view, 1, WINDOW_WIDTH);
+}
+
+/* 
+    Top-down view: the cached wall layer and the visible area, without casting rays.
+    Parameters:
+        - SDL_Renderer* renderer: the renderer used for drawing
+        - const struct player* view: the player snapshot to render from
+*/
+void render_top_down(SDL_Renderer* renderer, const struct player* view) {
+    topdown_draw_map(&topdown, renderer); // Blit the cached wall layer
+    render_visibility(renderer, view); // The top-down view needs the visible area, not one ray per column
+}
+
+/* 
+    Split view: the first-person view at half resolution on the left half of the window
+    and the top-down view scaled to half size on the right half.
+    Parameters:
+        - SDL_Renderer* renderer: the renderer used for drawing
+        - const struct player* view: the player snapshot to render from
+*/
+void render_split(SDL_Renderer* renderer, const struct player* view) {
+    static struct ray_hit hits[RAYS_NUMBER / 2]; // Closest hit of each column of the left half
+    cast_camera(view, 2, hits);
+    draw_columns(renderer, hits, view, 2, WINDOW_WIDTH / 2); // Every other ray fills the left half
+
+    // Draw the top-down view as usual, shrunk into the right half
+    SDL_Rect right_half = { WINDOW_WIDTH / 2, WINDOW_HEIGHT / 4, WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2 };
+    SDL_RenderSetViewport(renderer, &right_half);
+    SDL_RenderSetScale(renderer, 0.5, 0.5);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255); // Opaque backdrop so the map reads over the sky and floor
+    SDL_RenderFillRect(renderer, NULL);
+    render_top_down(renderer, view);
+    SDL_RenderSetScale(renderer, 1, 1);
+    SDL_RenderSetViewport(renderer, NULL);
 }
 
 /* 
     Renders the background including sky and floor.
-    Handles the rendering of the floor texture and the sky color.
+    Copies the precomputed sky panorama at the player's angle and fills the floor, lowered
+    column by column with the precomputed jump offsets, whatever the player is doing.
+    Parameters:
+        - SDL_Renderer* renderer: the renderer used for drawing
+        - const struct player* view: the player snapshot to render from
+        - int width: the screen columns spanned by the field of view
 */
-void render_background(SDL_Renderer* renderer) {
-    SDL_SetRenderDrawColor(renderer, 150, 150, 180, 55); // Set color for the sky
-    SDL_RenderClear(renderer); // Clear the screen with the sky color
-
-    SDL_SetRenderDrawColor(renderer, 0, 0, 10, 255); // Set color for the floor
-    if(player.is_jumping) { // If the player is jumping, render a dynamic floor effect
-        for(int i = 0; i < WINDOW_WIDTH; i++) { // Loop through each column of the screen
-            SDL_RenderDrawLine(renderer, i, FLOOR_SIZE + player.z + 0.7 * player.z * cos(((i - WINDOW_WIDTH/8) * FOV / WINDOW_WIDTH) / 4), i, WINDOW_HEIGHT); // Draw floor line with jump offset
-        } 
-    } else { // If the player is not jumping, render a solid floor rectangle
-        SDL_Rect floor_rect = {
-            0, 
-            (int)WINDOW_HEIGHT - FLOOR_SIZE, 
-            (int)WINDOW_WIDTH, 
-            (int)FLOOR_SIZE
-        };
-        SDL_RenderFillRect(renderer, &floor_rect); // Fill the rectangle with the floor color
+void render_background(SDL_Renderer* renderer, const struct player* view, int width) {
+    if(width < WINDOW_WIDTH) { // The rest of the window shows no first-person view
+        SDL_SetRenderDrawColor(renderer, 150, 150, 180, 255); // Set color for the sky
+        SDL_RenderClear(renderer);
     }
+    sky_draw(&sky, renderer, view->angle, view->z, width);
 }
 
 /* 
     Main rendering function that handles background, map, and camera rendering.
+    Draws the latest snapshot published by the simulation thread.
     Parameters: 
         - SDL_Renderer* renderer: the renderer used for drawing
 */
 void render(SDL_Renderer* renderer) {
-    render_background(renderer); // Render the sky and floor
+    const struct world_snapshot* snapshot = snapshot_acquire(&simulation.snapshots); // Latest simulated state
 
-    if(!FIRST_PERSON) 
-        render_map(renderer); // Render the map if not in first-person mode
+    // Move the door panels to the snapshot's openness, keeping the simulation from colliding meanwhile;
+    // only the grid cells and cached layer pixels a panel touches are updated
+    SDL_LockMutex(simulation.world_lock);
+    if(streaming) // Request the chunks around the player and where it is heading (never blocks); evicted chunks must not be in use
+        chunk_streamer_update(&streamer, snapshot->player.x, snapshot->player.y, snapshot->player.velocity);
+    sliding_doors_apply(&doors, &level, snapshot->door_open);
+    SDL_UnlockMutex(simulation.world_lock);
 
-    render_camera(renderer); // Render the 3D camera view using raycasting
+    render_background(renderer, &snapshot->player, render_modes[render_mode].sky_width); // Render the sky and floor
+    render_modes[render_mode].draw(renderer, &snapshot->player); // Single dispatch to the current view
+
+    if(video_stream != NULL)
+        video_stream_push(video_stream, renderer); // Queue the frame for the writer thread (drops instead of blocking)
 
     SDL_RenderPresent(renderer); // Present the rendered frame (swap buffers)
+    memory_frame_end(); // End of the allocation-free part of the frame
 }
 
 /* 
@@ -289,12 +523,42 @@ int main(void) {
     game_is_running = initialize_window(&window, &renderer);
 
     setup(); // Initialize game objects (e.g., player)
+    if(game_is_running)
+        set_render_mode(render_mode); // Capture the mouse if the first view needs it
+
+    // Build the sky textures once; without them the sky is drawn flat
+    if(game_is_running && sky_init(&sky, renderer))
+        fprintf(stderr, "Error creating the sky textures: %s\n", SDL_GetError());
+
+    // Stream the world chunks written by `make chunks` on a background thread; the simulation collides with them
+    if(game_is_running && chunk_streamer_start(&streamer, CHUNK_DIR) == 0) {
+        streaming = TRUE;
+        simulation.streamer = &streamer;
+        level.streamed_walls = streamer.wall_count; // The chunks keep their copies of these walls
+    }
+
+    // Run the simulation on its own thread so frame N renders while frame N+1 simulates
+    if(game_is_running && simulation_start(&simulation))
+        game_is_running = FALSE;
+
+    // Stream frames to a file or pipe if requested (e.g. RAYCASTER_STREAM=capture.y4m)
+    const char* stream_path = getenv(VIDEO_STREAM_ENV);
+    if(game_is_running && stream_path != NULL)
+        video_stream = video_stream_open(stream_path, WINDOW_WIDTH, WINDOW_HEIGHT);
 
     while(game_is_running) { // Main game loop
-        process_inputs(); // Handle user inputs (keyboard and mouse)
-        update(); // Update game state (e.g., player position)
-        render(renderer); // Render the current game frame
+        process_inputs(); // Handle user inputs and forward them to the simulation
+        render(renderer); // Render the latest simulation snapshot
     }
 
+    simulation_stop(&simulation); // Join the simulation thread
+
+    video_stream_close(video_stream); // Flush pending frames and report drops
+    if(streaming)
+        chunk_streamer_stop(&streamer); // Join the loader thread and report the chunk metrics
+    topdown_destroy(&topdown); // Free the cached wall layer
+    sky_destroy(&sky); // Free the sky textures
+    level_destroy(&level); // Free the sections
     destroy_window(window, renderer); // Clean up and exit
+    memory_report(); // Print the peak memory use of each subsystem and any heap use inside frames
 }
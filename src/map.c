@@ -0,0 +1,248 @@
+#include <math.h>
+#include <string.h>
+
+#include "constants.h"
+#include "map.h"
+
+// Map definition: simple 2D array representing lines with their RGB color values
+int map_lines = 17;
+double map[MAP_MAX_LINES][7] = {
+    {10, 10, 300, 10, 255, 0, 0},       // Top horizontal wall
+    {10, 10, 10, 300, 255, 0, 0},       // Left vertical wall
+    {300, 10, 300, 300, 255, 0, 0},     // Right vertical wall
+    // Internal walls
+    {50,  10,  50,  100, 0,   255, 0},       // Vertical wall left
+    {50,  100, 100, 100, 0,   255, 0},     // Horizontal section
+    {100, 100, 100, 200, 0,   255, 0},    // Vertical wall middle left
+    {150, 50,  150, 150, 0,   255, 0},     // Vertical wall middle
+    {150, 150, 200, 150, 0,   255, 0},    // Horizontal section
+    {100, 200, 200, 200, 0,   0,   255},    // Horizontal wall middle bottom
+    {200, 200, 200, 250, 0,   0,   255},    // Vertical wall near bottom
+    {200, 250, 250, 250, 0,   0,   255},    // Bottom right horizontal section
+    {250, 50,  250, 150, 255, 255, 0},   // Vertical wall middle right
+    {250, 50,  300, 50,  255, 255, 0},    // Top-right horizontal wall
+    {150, 150, 150, 200, 0,   255, 255},  // Vertical middle wall extension
+    {200, 50,  150, 50,  0,   255, 255},    // Horizontal upper middle wall
+    {50,  250, 150, 250, 0,   255, 255},   // Horizontal lower middle wall
+    {50,  150, 50,  200, 255, 0,   255},    // Vertical left-bottom wall
+};
+
+// Version of the map geometry, bumped on every change
+unsigned int map_version = 0;
+
+// Number of recent changes whose regions are remembered for incremental updates
+#define MAP_CHANGE_LOG 32
+
+// Region touched by each recent change, indexed by version modulo MAP_CHANGE_LOG
+static double change_regions[MAP_CHANGE_LOG][4];
+
+/**
+ * Marks the map geometry as changed so cached render state gets rebuilt.
+ */
+void map_touch(void) {
+    map_version++;
+    double* region = change_regions[map_version % MAP_CHANGE_LOG];
+    region[0] = region[1] = -INFINITY; // Unknown extent: the whole map
+    region[2] = region[3] = INFINITY;
+}
+
+/**
+ * Marks a box of the map as changed, so caches covering only that box can be patched
+ * instead of rebuilt. Must be called after any local edit of the map table.
+ * 
+ * @param min_x The left edge of the box.
+ * @param min_y The top edge of the box.
+ * @param max_x The right edge of the box.
+ * @param max_y The bottom edge of the box.
+ */
+void map_touch_region(double min_x, double min_y, double max_x, double max_y) {
+    map_version++;
+    double* region = change_regions[map_version % MAP_CHANGE_LOG];
+    region[0] = min_x;
+    region[1] = min_y;
+    region[2] = max_x;
+    region[3] = max_y;
+}
+
+/**
+ * Returns the box covering every change made after a version.
+ * 
+ * @param since The version a cache was built at.
+ * @param box The changed box as {min_x, min_y, max_x, max_y} (output).
+ * @return int 0 if the box is known, or 1 if the changes are too old or unbounded
+ *             (the cache must then be rebuilt).
+ */
+int map_changed_region(unsigned int since, double box[4]) {
+    if(map_version - since > MAP_CHANGE_LOG) return 1;
+
+    box[0] = box[1] = INFINITY;
+    box[2] = box[3] = -INFINITY;
+    for(unsigned int version = since + 1; version != map_version + 1; version++) {
+        const double* region = change_regions[version % MAP_CHANGE_LOG];
+        if(isinf(region[0])) return 1;
+        box[0] = fmin(box[0], region[0]);
+        box[1] = fmin(box[1], region[1]);
+        box[2] = fmax(box[2], region[2]);
+        box[3] = fmax(box[3], region[3]);
+    }
+    return 0;
+}
+
+/**
+ * Marks the boxes around two positions of a wall as changed.
+ * 
+ * @param a The first position as {x0, y0, xf, yf}.
+ * @param b The second position as {x0, y0, xf, yf}.
+ */
+static void touch_walls(const double* a, const double* b) {
+    map_touch_region(fmin(fmin(a[0], a[2]), fmin(b[0], b[2])), fmin(fmin(a[1], a[3]), fmin(b[1], b[3])),
+        fmax(fmax(a[0], a[2]), fmax(b[0], b[2])), fmax(fmax(a[1], a[3]), fmax(b[1], b[3])));
+}
+
+/**
+ * Appends a wall to the map table.
+ * 
+ * @param wall The wall as {x0, y0, xf, yf, r, g, b}.
+ * @return int The row of the new wall, or -1 if the table is full.
+ */
+int map_add_wall(const double wall[7]) {
+    if(map_lines == MAP_MAX_LINES) return -1;
+    memcpy(map[map_lines], wall, sizeof(map[0]));
+    touch_walls(wall, wall);
+    return map_lines++;
+}
+
+/**
+ * Moves the endpoints of a wall of the map table.
+ * 
+ * @param row The row of the wall.
+ * @param position The new endpoints as {x0, y0, xf, yf}.
+ */
+void map_move_wall(int row, const double position[4]) {
+    touch_walls(map[row], position);
+    memcpy(map[row], position, sizeof(double[4]));
+}
+
+/**
+ * Removes a wall from the map table by moving the last row into its place,
+ * so only the last wall changes row.
+ * 
+ * @param row The row of the wall to remove.
+ */
+void map_remove_wall(int row) {
+    touch_walls(map[row], map[row]);
+    memcpy(map[row], map[map_lines - 1], sizeof(map[0]));
+    map_lines--;
+}
+
+/**
+ * Removes a wall from the map table, keeping the order of the others.
+ * 
+ * @param index The row of the wall to remove.
+ */
+static void remove_wall(int index) {
+    memmove(map[index], map[index + 1], sizeof(map[0]) * (map_lines - index - 1));
+    map_lines--;
+}
+
+/**
+ * Checks whether two walls have the same endpoints, in either direction.
+ * 
+ * @param a The row of the first wall.
+ * @param b The row of the second wall.
+ * @return int 1 if the walls coincide, 0 otherwise.
+ */
+static int same_endpoints(int a, int b) {
+    int forward = TRUE, backward = TRUE;
+    for(int k = 0; k < 2; k++) {
+        forward = forward && fabs(map[a][k] - map[b][k]) <= MAP_MERGE_EPSILON && fabs(map[a][k + 2] - map[b][k + 2]) <= MAP_MERGE_EPSILON;
+        backward = backward && fabs(map[a][k] - map[b][k + 2]) <= MAP_MERGE_EPSILON && fabs(map[a][k + 2] - map[b][k]) <= MAP_MERGE_EPSILON;
+    }
+    return forward || backward;
+}
+
+/**
+ * Extends a wall over a second one when both have the same color, lie on the same line
+ * and overlap or touch end to end.
+ * 
+ * @param a The row of the wall to extend.
+ * @param b The row of the wall to absorb.
+ * @return int 1 if a now covers b, 0 if the walls cannot be merged.
+ */
+static int absorb_wall(int a, int b) {
+    if(map[a][4] != map[b][4] || map[a][5] != map[b][5] || map[a][6] != map[b][6]) return FALSE;
+
+    double dx = map[a][2] - map[a][0], dy = map[a][3] - map[a][1];
+    double length = hypot(dx, dy);
+    double t[2];
+
+    for(int k = 0; k < 2; k++) {
+        double px = map[b][2 * k] - map[a][0], py = map[b][2 * k + 1] - map[a][1];
+        if(fabs(dx * py - dy * px) / length > MAP_MERGE_EPSILON) return FALSE; // Off the line of a
+        t[k] = (dx * px + dy * py) / (length * length); // Position along a, from 0 to 1
+    }
+
+    // The walls must share at least a point: b's range along a has to reach [0, 1]
+    double low = fmin(t[0], t[1]), high = fmax(t[0], t[1]), slack = MAP_MERGE_EPSILON / length;
+    if(high < -slack || low > 1 + slack) return FALSE;
+
+    low = fmin(low, 0);
+    high = fmax(high, 1);
+    double x0 = map[a][0], y0 = map[a][1];
+    map[a][0] = x0 + low * dx;
+    map[a][1] = y0 + low * dy;
+    map[a][2] = x0 + high * dx;
+    map[a][3] = y0 + high * dy;
+    return TRUE;
+}
+
+/**
+ * Simplifies the map table in place: removes zero-length and duplicate walls and merges
+ * colinear walls of the same color that overlap or touch end to end into single walls.
+ * The remaining walls keep their relative order. Calls map_touch when anything changed.
+ * 
+ * @param report The number of walls removed by each rule (output, may be NULL).
+ */
+void map_simplify(struct map_simplify_report* report) {
+    struct map_simplify_report counts = { map_lines, map_lines, 0, 0, 0 };
+
+    for(int i = 0; i < map_lines;) {
+        if(hypot(map[i][2] - map[i][0], map[i][3] - map[i][1]) <= MAP_MERGE_EPSILON) {
+            remove_wall(i);
+            counts.zero_length++;
+        } else {
+            i++;
+        }
+    }
+
+    for(int i = 0; i < map_lines; i++) {
+        for(int j = i + 1; j < map_lines;) {
+            if(same_endpoints(i, j)) {
+                remove_wall(j);
+                counts.duplicates++;
+            } else {
+                j++;
+            }
+        }
+    }
+
+    // A merge lengthens a wall, which may let it reach walls already checked: repeat until stable
+    for(int changed = TRUE; changed;) {
+        changed = FALSE;
+        for(int i = 0; i < map_lines; i++) {
+            for(int j = i + 1; j < map_lines;) {
+                if(absorb_wall(i, j)) {
+                    remove_wall(j);
+                    counts.merged++;
+                    changed = TRUE;
+                } else {
+                    j++;
+                }
+            }
+        }
+    }
+
+    counts.after = map_lines;
+    if(counts.after != counts.before) map_touch();
+    if(report != NULL) *report = counts;
+}
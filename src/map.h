@@ -0,0 +1,85 @@
+#ifndef MAP_H
+#define MAP_H
+
+// Maximum number of walls the map table can hold
+#define MAP_MAX_LINES 100
+
+// Map definition: each row holds a wall as {x0, y0, xf, yf, r, g, b}
+extern double map[MAP_MAX_LINES][7];
+
+// Number of walls currently in the map table
+extern int map_lines;
+
+// Version of the map geometry, bumped on every change
+extern unsigned int map_version;
+
+// Outcome of a map_simplify pass
+struct map_simplify_report {
+    int before;         // Number of walls before the pass
+    int after;          // Number of walls after the pass
+    int zero_length;    // Walls removed because their endpoints coincide
+    int duplicates;     // Walls removed because another wall has the same endpoints
+    int merged;         // Walls absorbed into a colinear, touching wall of the same color
+};
+
+/**
+ * Marks the map geometry as changed so cached render state gets rebuilt.
+ * Must be called after any edit of the map table.
+ */
+void map_touch(void);
+
+/**
+ * Marks a box of the map as changed, so caches covering only that box can be patched
+ * instead of rebuilt. Must be called after any local edit of the map table.
+ * 
+ * @param min_x The left edge of the box.
+ * @param min_y The top edge of the box.
+ * @param max_x The right edge of the box.
+ * @param max_y The bottom edge of the box.
+ */
+void map_touch_region(double min_x, double min_y, double max_x, double max_y);
+
+/**
+ * Returns the box covering every change made after a version.
+ * 
+ * @param since The version a cache was built at.
+ * @param box The changed box as {min_x, min_y, max_x, max_y} (output).
+ * @return int 0 if the box is known, or 1 if the changes are too old or unbounded
+ *             (the cache must then be rebuilt).
+ */
+int map_changed_region(unsigned int since, double box[4]);
+
+/**
+ * Appends a wall to the map table.
+ * 
+ * @param wall The wall as {x0, y0, xf, yf, r, g, b}.
+ * @return int The row of the new wall, or -1 if the table is full.
+ */
+int map_add_wall(const double wall[7]);
+
+/**
+ * Moves the endpoints of a wall of the map table.
+ * 
+ * @param row The row of the wall.
+ * @param position The new endpoints as {x0, y0, xf, yf}.
+ */
+void map_move_wall(int row, const double position[4]);
+
+/**
+ * Removes a wall from the map table by moving the last row into its place,
+ * so only the last wall changes row.
+ * 
+ * @param row The row of the wall to remove.
+ */
+void map_remove_wall(int row);
+
+/**
+ * Simplifies the map table in place: removes zero-length and duplicate walls and merges
+ * colinear walls of the same color that overlap or touch end to end into single walls.
+ * The remaining walls keep their relative order. Calls map_touch when anything changed.
+ * 
+ * @param report The number of walls removed by each rule (output, may be NULL).
+ */
+void map_simplify(struct map_simplify_report* report);
+
+#endif
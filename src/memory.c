@@ -0,0 +1,197 @@
+// std
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "constants.h"
+#include "memory.h"
+
+// Prefix of every block, padded so the caller's part keeps malloc's alignment
+union block_header {
+    struct {
+        size_t size;                        // Size requested by the caller
+        enum memory_subsystem subsystem;    // Subsystem charged for the block
+    } info;
+    max_align_t align;
+};
+
+// Counters of one subsystem; atomic because the loader and writer threads allocate too
+struct subsystem_counters {
+    atomic_size_t current;      // Bytes held now
+    atomic_size_t peak;         // Highest value of current
+    atomic_ulong allocations;   // Blocks allocated (a realloc resizes a block without counting)
+    atomic_ulong frees;         // Blocks freed
+};
+
+static const char* const subsystem_names[MEMORY_SUBSYSTEM_COUNT] = {
+    "sections", "levels", "pvs", "grids", "quantized", "lists",
+    "entities", "jobs", "chunks", "video", "render"
+};
+
+static struct subsystem_counters counters[MEMORY_SUBSYSTEM_COUNT];
+static atomic_size_t total_current, total_peak;     // Same as current and peak, over every subsystem
+static atomic_ulong frame_operations;               // Allocations and frees made inside frames
+static _Thread_local int in_frame;                  // 1 between memory_frame_begin and memory_frame_end
+
+/**
+ * Raises a peak to a new value if it is higher.
+ *
+ * @param peak The peak.
+ * @param value The value just reached.
+ */
+static void raise_peak(atomic_size_t* peak, size_t value) {
+    size_t seen = atomic_load(peak);
+    while(value > seen && !atomic_compare_exchange_weak(peak, &seen, value));
+}
+
+/**
+ * Charges bytes to a subsystem, or credits them back when negative.
+ *
+ * @param subsystem The subsystem.
+ * @param bytes The change in bytes held.
+ */
+static void account(enum memory_subsystem subsystem, ptrdiff_t bytes) {
+    struct subsystem_counters* counter = &counters[subsystem];
+    if(bytes >= 0) {
+        raise_peak(&counter->peak, atomic_fetch_add(&counter->current, (size_t) bytes) + (size_t) bytes);
+        raise_peak(&total_peak, atomic_fetch_add(&total_current, (size_t) bytes) + (size_t) bytes);
+    } else {
+        atomic_fetch_sub(&counter->current, (size_t) -bytes);
+        atomic_fetch_sub(&total_current, (size_t) -bytes);
+    }
+}
+
+/**
+ * Counts a heap operation made inside a frame, and aborts when MEMORY_FRAME_CHECK is set.
+ *
+ * @param operation The name of the operation.
+ * @param subsystem The subsystem of the block.
+ * @param size The size of the block in bytes.
+ */
+static void check_frame(const char* operation, enum memory_subsystem subsystem, size_t size) {
+    if(!in_frame) return;
+    atomic_fetch_add(&frame_operations, 1);
+    if(MEMORY_FRAME_CHECK) {
+        fprintf(stderr, "Heap %s of %zu bytes (%s) inside a frame.\n", operation, size, subsystem_names[subsystem]);
+        abort();
+    }
+}
+
+/**
+ * Allocates a block charged to a subsystem, like malloc.
+ *
+ * @param subsystem The subsystem the block belongs to.
+ * @param size The size of the block in bytes.
+ * @return void* The block, or NULL if allocation failed.
+ */
+void* memory_alloc(enum memory_subsystem subsystem, size_t size) {
+    check_frame("allocation", subsystem, size);
+    if(size > SIZE_MAX - sizeof(union block_header)) return NULL;
+
+    union block_header* header = malloc(sizeof(union block_header) + size);
+    if(header == NULL) return NULL;
+    header->info.size = size;
+    header->info.subsystem = subsystem;
+
+    atomic_fetch_add(&counters[subsystem].allocations, 1);
+    account(subsystem, (ptrdiff_t) size);
+    return header + 1;
+}
+
+/**
+ * Allocates a zeroed array charged to a subsystem, like calloc.
+ *
+ * @param subsystem The subsystem the array belongs to.
+ * @param count The number of elements.
+ * @param size The size of an element in bytes.
+ * @return void* The array, or NULL if allocation failed.
+ */
+void* memory_calloc(enum memory_subsystem subsystem, size_t count, size_t size) {
+    check_frame("allocation", subsystem, count * size);
+    if(size != 0 && count > (SIZE_MAX - sizeof(union block_header)) / size) return NULL;
+
+    union block_header* header = calloc(1, sizeof(union block_header) + count * size);
+    if(header == NULL) return NULL;
+    header->info.size = count * size;
+    header->info.subsystem = subsystem;
+
+    atomic_fetch_add(&counters[subsystem].allocations, 1);
+    account(subsystem, (ptrdiff_t) (count * size));
+    return header + 1;
+}
+
+/**
+ * Resizes a block, like realloc. The block stays charged to the subsystem it was allocated for.
+ *
+ * @param subsystem The subsystem a new block (block == NULL) belongs to.
+ * @param block The block to resize, or NULL.
+ * @param size The new size in bytes.
+ * @return void* The resized block, or NULL if allocation failed (the block is then left untouched).
+ */
+void* memory_realloc(enum memory_subsystem subsystem, void* block, size_t size) {
+    if(block == NULL) return memory_alloc(subsystem, size);
+
+    union block_header* header = (union block_header*) block - 1;
+    size_t previous = header->info.size;
+    subsystem = header->info.subsystem;
+    check_frame("reallocation", subsystem, size);
+    if(size > SIZE_MAX - sizeof(union block_header)) return NULL;
+
+    header = realloc(header, sizeof(union block_header) + size);
+    if(header == NULL) return NULL;
+    header->info.size = size;
+
+    account(subsystem, (ptrdiff_t) size - (ptrdiff_t) previous);
+    return header + 1;
+}
+
+/**
+ * Frees a block allocated by memory_alloc, memory_calloc or memory_realloc, like free.
+ *
+ * @param block The block, or NULL.
+ */
+void memory_free(void* block) {
+    if(block == NULL) return;
+
+    union block_header* header = (union block_header*) block - 1;
+    enum memory_subsystem subsystem = header->info.subsystem;
+    check_frame("free", subsystem, header->info.size);
+
+    atomic_fetch_add(&counters[subsystem].frees, 1);
+    account(subsystem, -(ptrdiff_t) header->info.size);
+    free(header);
+}
+
+/**
+ * Marks the start of a frame on the calling thread. Until memory_frame_end, any allocation
+ * or free on this thread is counted as a frame heap operation, and aborts the program
+ * when MEMORY_FRAME_CHECK is set.
+ */
+void memory_frame_begin(void) {
+    in_frame = TRUE;
+}
+
+/**
+ * Marks the end of a frame on the calling thread.
+ */
+void memory_frame_end(void) {
+    in_frame = FALSE;
+}
+
+/**
+ * Prints the current and peak bytes, the allocation and free counts of every subsystem,
+ * and the number of heap operations made inside frames.
+ */
+void memory_report(void) {
+    fprintf(stderr, "Memory:     %12s %12s %12s %12s\n", "bytes", "peak bytes", "allocations", "frees");
+    for(int i = 0; i < MEMORY_SUBSYSTEM_COUNT; i++) {
+        struct subsystem_counters* counter = &counters[i];
+        fprintf(stderr, "  %-9s %12zu %12zu %12lu %12lu\n", subsystem_names[i],
+            atomic_load(&counter->current), atomic_load(&counter->peak),
+            atomic_load(&counter->allocations), atomic_load(&counter->frees));
+    }
+    fprintf(stderr, "  %-9s %12zu %12zu\n", "total", atomic_load(&total_current), atomic_load(&total_peak));
+    fprintf(stderr, "Heap operations inside frames: %lu.\n", atomic_load(&frame_operations));
+}
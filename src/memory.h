@@ -0,0 +1,76 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stddef.h>
+
+// Engine parts whose heap use is accounted separately
+enum memory_subsystem {
+    MEMORY_SECTIONS,    // Sections: their walls, doors and wall ids
+    MEMORY_LEVELS,      // Section tables of the levels
+    MEMORY_PVS,         // Potentially visible sets and visible wall lists
+    MEMORY_GRIDS,       // Broad-phase grids of the sections and chunks
+    MEMORY_QUANTIZED,   // Quantized wall copies
+    MEMORY_LISTS,       // Linked lists of lines
+    MEMORY_ENTITIES,    // Entity stores
+    MEMORY_JOBS,        // Worker thread tables
+    MEMORY_CHUNKS,      // Streamed chunk walls
+    MEMORY_VIDEO,       // Frame buffers of the video stream
+    MEMORY_RENDER,      // Render buffers built at startup (sky)
+    MEMORY_SUBSYSTEM_COUNT
+};
+
+/**
+ * Allocates a block charged to a subsystem, like malloc.
+ *
+ * @param subsystem The subsystem the block belongs to.
+ * @param size The size of the block in bytes.
+ * @return void* The block, or NULL if allocation failed.
+ */
+void* memory_alloc(enum memory_subsystem subsystem, size_t size);
+
+/**
+ * Allocates a zeroed array charged to a subsystem, like calloc.
+ *
+ * @param subsystem The subsystem the array belongs to.
+ * @param count The number of elements.
+ * @param size The size of an element in bytes.
+ * @return void* The array, or NULL if allocation failed.
+ */
+void* memory_calloc(enum memory_subsystem subsystem, size_t count, size_t size);
+
+/**
+ * Resizes a block, like realloc. The block stays charged to the subsystem it was allocated for.
+ *
+ * @param subsystem The subsystem a new block (block == NULL) belongs to.
+ * @param block The block to resize, or NULL.
+ * @param size The new size in bytes.
+ * @return void* The resized block, or NULL if allocation failed (the block is then left untouched).
+ */
+void* memory_realloc(enum memory_subsystem subsystem, void* block, size_t size);
+
+/**
+ * Frees a block allocated by memory_alloc, memory_calloc or memory_realloc, like free.
+ *
+ * @param block The block, or NULL.
+ */
+void memory_free(void* block);
+
+/**
+ * Marks the start of a frame on the calling thread. Until memory_frame_end, any allocation
+ * or free on this thread is counted as a frame heap operation, and aborts the program
+ * when MEMORY_FRAME_CHECK is set.
+ */
+void memory_frame_begin(void);
+
+/**
+ * Marks the end of a frame on the calling thread.
+ */
+void memory_frame_end(void);
+
+/**
+ * Prints the current and peak bytes, the allocation and free counts of every subsystem,
+ * and the number of heap operations made inside frames.
+ */
+void memory_report(void);
+
+#endif
@@ -5,11 +5,28 @@
 #include "constants.h"
 #include "gametime.h"
 #include "algebra.h"
+#include "chunks.h"
+#include "collision.h"
+#include "map.h"
 #include "player.h"
+#include "section.h"
+#include "trig.h"
 
 // Global player object
 struct player player;
 
+// Section containing the spawn point
+static struct section* spawn_section = NULL;
+
+/**
+ * Sets the section the player is placed in by setup_player.
+ * 
+ * @param section The section containing the spawn point, or NULL.
+ */
+void set_player_spawn(struct section* section) {
+    spawn_section = section;
+}
+
 /**
  * Initializes player properties.
  * Sets initial position, size, and movement attributes.
@@ -21,6 +38,7 @@ void setup_player(void) {
     player.x = WINDOW_WIDTH / 2.0f - player.width / 2.0f; // Center player horizontally
     player.y = WINDOW_HEIGHT / 2.0f - player.height / 2.0f; // Center player vertically
     player.z = 0; // Initialize vertical position to 0 (on the ground)
+    player.section = spawn_section; // Start in the spawn section
 
     // Initialize velocity, rotation, and angle
     player.velocity[0] = 0;
@@ -51,21 +69,25 @@ void set_move_player(void) {
     player.velocity[0] = 0; // Reset horizontal velocity
     player.velocity[1] = 0; // Reset vertical velocity
 
+    // The facing direction, turned a quarter or half turn for the other directions
+    double sine, cosine;
+    trig_sincos(player.angle, &sine, &cosine);
+
     // Update velocity based on movement input and direction
     if(player.move_set.right && player.possible_moves.right) {
-        player.velocity[0] += cos(player.angle + PI/2); // Move right
-        player.velocity[1] += sin(player.angle + PI/2);
+        player.velocity[0] -= sine; // Move right
+        player.velocity[1] += cosine;
     } else if(player.move_set.left && player.possible_moves.left) {
-        player.velocity[0] += cos(player.angle - PI/2); // Move left
-        player.velocity[1] += sin(player.angle - PI/2);
+        player.velocity[0] += sine; // Move left
+        player.velocity[1] -= cosine;
     }
 
     if(player.move_set.front && player.possible_moves.back) {
-        player.velocity[0] += cos(player.angle); // Move forward
-        player.velocity[1] += sin(player.angle);
+        player.velocity[0] += cosine; // Move forward
+        player.velocity[1] += sine;
     } else if(player.move_set.back && player.possible_moves.back) {
-        player.velocity[0] += cos(player.angle + PI); // Move backward
-        player.velocity[1] += sin(player.angle + PI);
+        player.velocity[0] -= cosine; // Move backward
+        player.velocity[1] -= sine;
     }
 
     // Handle jumping
@@ -88,11 +110,17 @@ void set_move_player(void) {
 
 /**
  * Updates player position and state based on elapsed time.
- * Applies gravity and adjusts movement and rotation.
+ * Applies gravity and adjusts movement and rotation. The player collides with the
+ * streamed chunks around it and the walls added after they were exported (such as the
+ * door panels) once those chunks are resident, and with its section's walls otherwise.
  * 
  * @param delta_time The time elapsed since the last update.
+ * @param streamer The streamed chunks, or NULL if not streaming.
  */
-void update_player(double delta_time) {
+void update_player(double delta_time, struct chunk_streamer* streamer) {
+    // The first frame measures the time since startup; cap the step so gravity stays stable
+    if(delta_time > MAX_DELTA_TIME) delta_time = MAX_DELTA_TIME;
+
     set_move_player(); // Update player velocity based on inputs
 
     player.z_vel -= delta_time * GRAVITY_ACCELERATION; // Apply gravity to vertical velocity
@@ -106,8 +134,30 @@ void update_player(double delta_time) {
     }
 
     // Update player position based on velocity and elapsed time
-    player.x += player.velocity[0] * delta_time;
-    player.y += player.velocity[1] * delta_time;
+    struct point desired = {
+        player.x + player.velocity[0] * delta_time,
+        player.y + player.velocity[1] * delta_time
+    };
+
+    // Stop at walls and slide along them, then follow the player into the next section when a door is crossed
+    if(player.section != NULL) {
+        const struct wall_grid* grids[CHUNK_AREA];
+        int grid_count = streamer != NULL ? chunk_streamer_gather(streamer, player.x, player.y, grids) : -1;
+        if(grid_count >= 0) {
+            int added[MAP_MAX_LINES], added_count = 0;
+            for(int row = streamer->wall_count; row < map_lines; row++) added[added_count++] = row;
+            struct point start = { player.x, player.y };
+            desired = collide_and_slide_grids(grids, grid_count, added, added_count, start, desired, player.width / 2);
+        } else {
+            desired = section_check_collision(player.section, &player, desired);
+        }
+
+        struct section* next = section_check_leaving(player.section, &player, desired);
+        if(next != NULL) player.section = next;
+    }
+
+    player.x = desired.x;
+    player.y = desired.y;
 
     // Update player rotation based on mouse input
     player.angle -= player.rotation * PLAYER_ROTATION_SPEED * delta_time;
@@ -132,13 +182,16 @@ void render_player(SDL_Renderer* renderer) {
     SDL_SetRenderDrawColor(renderer, 200, 100, 100, 255); // Set color to reddish for the player
     SDL_RenderFillRect(renderer, &player_rect); // Draw player rectangle
 
+    double sine, cosine;
+    trig_sincos(player.angle, &sine, &cosine);
+
     SDL_SetRenderDrawColor(renderer, 0, 255, 0, 255); // Set color to green for the direction line
     SDL_RenderDrawLine(
         renderer, 
         (int) player.x, 
         (int) player.y, 
-        (int) (player.x + cos(player.angle) * player.width), // End point of direction line based on angle
-        (int) (player.y + sin(player.angle) * player.width)
+        (int) (player.x + cosine * player.width), // End point of direction line based on angle
+        (int) (player.y + sine * player.width)
     );
 }
 
@@ -149,6 +202,6 @@ void render_player(SDL_Renderer* renderer) {
  * @param x The x-coordinate of the target point.
  * @param y The y-coordinate of the target point.
  */
-void rotate_player_towards(int x, int y) {
-    player.angle = atan2f(y - player.y, x - player.x); // Compute angle using arctangent
+void rotate_player_towards(double x, double y) {
+    player.angle = trig_atan2(y - player.y, x - player.x); // Compute angle using arctangent
 }
@@ -3,6 +3,9 @@
 
 #include <SDL2/SDL.h>
 
+struct section;
+struct chunk_streamer;
+
 /*
     Structure to hold player movement state.
     This includes whether the player is moving in specific directions or jumping.
@@ -32,6 +35,7 @@ struct player {
     double angle;         // The angle the player is facing
     struct move_set move_set;    // The current movement states (front, back, right, left, jump)
     struct move_set possible_moves; // The possible moves based on the environment (obstacles, etc.)
+    struct section* section;    // The section the player is in, or NULL when no level is loaded
 };
 
 /**
@@ -40,13 +44,23 @@ struct player {
  */
 void setup_player(void);
 
+/**
+ * Sets the section the player is placed in by setup_player.
+ * 
+ * @param section The section containing the spawn point, or NULL.
+ */
+void set_player_spawn(struct section* section);
+
 /**
  * Updates player position and state based on elapsed time.
- * Applies gravity and adjusts movement and rotation.
+ * Applies gravity and adjusts movement and rotation. The player collides with the
+ * streamed chunks around it and the walls added after they were exported (such as the
+ * door panels) once those chunks are resident, and with its section's walls otherwise.
  * 
  * @param delta_time The time elapsed since the last update.
+ * @param streamer The streamed chunks, or NULL if not streaming.
  */
-void update_player(double delta_time);
+void update_player(double delta_time, struct chunk_streamer* streamer);
 
 /**
  * Renders the player on the screen.
@@ -70,6 +84,6 @@ void set_move_player();
  * @param x The x-coordinate of the target point.
  * @param y The y-coordinate of the target point.
  */
-void rotate_player_towards(int x, int y);
+void rotate_player_towards(double x, double y);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "constants.h"
+#include "algebra.h"
+#include "memory.h"
+#include "pvs.h"
+
+// Identifies files written by pvs_save
+#define PVS_MAGIC "PVS2"
+
+#define PVS_HASH_BASIS 14695981039346656037ULL   // FNV-1a 64-bit offset basis
+#define PVS_HASH_PRIME 1099511628211ULL          // FNV-1a 64-bit prime
+
+/**
+ * Returns the number of bytes of a visibility bitset.
+ * 
+ * @param section_count The number of sections in the level.
+ * @return int The size of one bitset in bytes.
+ */
+static int pvs_row_size(int section_count) {
+    return (section_count + 7) / 8;
+}
+
+/**
+ * Mixes bytes into an FNV-1a hash.
+ * 
+ * @param hash The hash so far.
+ * @param bytes The bytes to mix in.
+ * @param size The number of bytes.
+ * @return uint64_t The updated hash.
+ */
+static uint64_t pvs_hash_bytes(uint64_t hash, const void* bytes, size_t size) {
+    const unsigned char* byte = bytes;
+    for(size_t i = 0; i < size; i++) hash = (hash ^ byte[i]) * PVS_HASH_PRIME;
+    return hash;
+}
+
+/**
+ * Hashes the geometry the sets are computed from: the walls and doors of every section,
+ * in section id order. Sets saved for other geometry must not be loaded.
+ * 
+ * @param level The indexed level.
+ * @return uint64_t The hash.
+ */
+static uint64_t pvs_geometry_hash(const struct level* level) {
+    uint64_t hash = PVS_HASH_BASIS;
+    for(int i = 0; i < level->section_count; i++) {
+        const struct section* section = level->sections[i];
+        hash = pvs_hash_bytes(hash, &section->wall_count, sizeof(int));
+        hash = pvs_hash_bytes(hash, section->walls, sizeof(struct line) * section->wall_count);
+        hash = pvs_hash_bytes(hash, &section->door_count, sizeof(int));
+        for(int j = 0; j < section->door_count; j++) {
+            const struct door* door = &section->doors[j];
+            int dest = door->dest != NULL && door->dest->room != NULL ? door->dest->room->id : -1;
+            hash = pvs_hash_bytes(hash, &door->position, sizeof(struct line));
+            hash = pvs_hash_bytes(hash, &dest, sizeof(int));
+        }
+    }
+    return hash;
+}
+
+/**
+ * Marks a section as potentially visible from another.
+ * 
+ * @param from The section whose set is updated.
+ * @param to The section that may be visible.
+ */
+static void pvs_mark(struct section* from, const struct section* to) {
+    from->pvs[to->id / 8] |= 1 << (to->id % 8);
+}
+
+/**
+ * Checks whether a section belongs to the potentially visible set of another.
+ * 
+ * @param from The section the player is in.
+ * @param to The section to test.
+ * @return int 1 if `to` may be visible from `from`, 0 otherwise.
+ */
+int pvs_is_visible(const struct section* from, const struct section* to) {
+    if(from->pvs == NULL) return 1; // No set computed: everything may be visible
+    return (from->pvs[to->id / 8] >> (to->id % 8)) & 1;
+}
+
+/**
+ * Clips a segment to one side of the line from a to b.
+ * 
+ * @param segment The segment to clip, updated in place.
+ * @param a The start of the clipping line.
+ * @param b A second point of the clipping line.
+ * @param keep_sign 1 to keep the left side of the line, -1 to keep the right side.
+ * @return int 1 if part of the segment remains, 0 if it was clipped away entirely.
+ */
+static int clip_segment(struct line* segment, struct point a, struct point b, int keep_sign) {
+    struct point p0 = { segment->x0, segment->y0 };
+    struct point pf = { segment->xf, segment->yf };
+    double d0 = keep_sign * side_of_line(a, b, p0);
+    double df = keep_sign * side_of_line(a, b, pf);
+
+    if(d0 < 0 && df < 0) return 0;  // Entirely on the clipped side
+    if(d0 >= 0 && df >= 0) return 1; // Entirely kept
+
+    // Move the clipped endpoint to the crossing point
+    double t = d0 / (d0 - df);
+    double x = p0.x + t * (pf.x - p0.x);
+    double y = p0.y + t * (pf.y - p0.y);
+    if(d0 < 0) {
+        segment->x0 = x;
+        segment->y0 = y;
+    } else {
+        segment->xf = x;
+        segment->yf = y;
+    }
+    return 1;
+}
+
+/**
+ * Clips a door against everything that could be seen from a source door through a pass door.
+ * Lines through an endpoint of each door that leave the two doors on opposite sides
+ * bound the visible region; the door must also lie beyond the pass door.
+ * 
+ * @param target The door to clip, updated in place.
+ * @param source The door of the section whose set is being computed.
+ * @param pass The last door the line of sight went through.
+ * @return int 1 if part of the door can be seen, 0 otherwise.
+ */
+static int clip_to_separators(struct line* target, struct line source, struct line pass) {
+    struct point s[2] = { { source.x0, source.y0 }, { source.xf, source.yf } };
+    struct point p[2] = { { pass.x0, pass.y0 }, { pass.xf, pass.yf } };
+
+    // Keep only what lies beyond the pass door, away from the source
+    struct point source_mid = { (s[0].x + s[1].x) / 2, (s[0].y + s[1].y) / 2 };
+    double source_side = side_of_line(p[0], p[1], source_mid);
+    if(source_side != 0 && !clip_segment(target, p[0], p[1], source_side > 0 ? -1 : 1)) return 0;
+
+    for(int i = 0; i < 2; i++) {
+        for(int j = 0; j < 2; j++) {
+            double side_source = side_of_line(s[i], p[j], s[1 - i]);
+            double side_pass = side_of_line(s[i], p[j], p[1 - j]);
+
+            // Only lines leaving the two doors strictly on opposite sides separate them
+            if(side_source == 0 || side_pass == 0 || (side_source > 0) == (side_pass > 0)) continue;
+            if(!clip_segment(target, s[i], p[j], side_pass > 0 ? 1 : -1)) return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * Recursively follows lines of sight from a source door through the doors of a section.
+ * 
+ * @param from The section whose set is being computed.
+ * @param source The door of `from` the line of sight started through.
+ * @param pass The visible part of the last door crossed.
+ * @param current The section entered through `pass`.
+ * @param entry The door of `current` that was entered through.
+ * @param on_path Flags of the sections on the current chain, indexed by id.
+ * @param first_hop 1 if `pass` is the source door itself.
+ */
+static void pvs_flow(struct section* from, struct line source, struct line pass,
+    struct section* current, const struct door* entry, unsigned char* on_path, int first_hop) {
+    for(int i = 0; i < current->door_count; i++) {
+        struct door* door = &current->doors[i];
+        if(door == entry || door->dest == NULL || door->dest->room == NULL) continue;
+
+        struct section* next = door->dest->room;
+        if(on_path[next->id]) continue;
+
+        // Right behind the source door everything in the next room can be seen
+        struct line visible = door->position;
+        if(!first_hop && !clip_to_separators(&visible, source, pass)) continue;
+
+        pvs_mark(from, next);
+        on_path[next->id] = TRUE;
+        pvs_flow(from, source, visible, next, door->dest, on_path, FALSE);
+        on_path[next->id] = FALSE;
+    }
+}
+
+/**
+ * Allocates a cleared visibility bitset for every section of a level.
+ * 
+ * @param level The indexed level.
+ * @return int 0 if every set was allocated, or 1 if an error occurred.
+ */
+static int pvs_allocate(struct level* level) {
+    int row_size = pvs_row_size(level->section_count);
+    for(int i = 0; i < level->section_count; i++) {
+        memory_free(level->sections[i]->pvs);
+        level->sections[i]->pvs = memory_calloc(MEMORY_PVS, row_size, 1);
+        if(level->sections[i]->pvs == NULL) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Computes the potentially visible set of every section of an indexed level.
+ * A section is potentially visible from another if some line of sight passes
+ * through the chain of doors between them; each door is clipped against the
+ * separating lines of the doors before it, so the result is conservative.
+ * 
+ * @param level The indexed level.
+ * @return int 0 if every set was computed, or 1 if an error occurred.
+ */
+int pvs_compute(struct level* level) {
+    if(pvs_allocate(level)) return 1;
+
+    unsigned char* on_path = memory_calloc(MEMORY_PVS, level->section_count > 0 ? level->section_count : 1, 1);
+    if(on_path == NULL) return 1;
+
+    for(int i = 0; i < level->section_count; i++) {
+        struct section* from = level->sections[i];
+        pvs_mark(from, from);
+        on_path[from->id] = TRUE;
+
+        for(int j = 0; j < from->door_count; j++) {
+            struct door* door = &from->doors[j];
+            if(door->dest == NULL || door->dest->room == NULL) continue;
+
+            struct section* next = door->dest->room;
+            if(on_path[next->id]) continue;
+
+            pvs_mark(from, next);
+            on_path[next->id] = TRUE;
+            pvs_flow(from, door->position, door->position, next, door->dest, on_path, TRUE);
+            on_path[next->id] = FALSE;
+        }
+
+        on_path[from->id] = FALSE;
+    }
+
+    memory_free(on_path);
+    return 0;
+}
+
+/**
+ * Writes the potentially visible sets of a level to a file, after a hash of the
+ * walls and doors they were computed from.
+ * 
+ * @param level The level, with its sets computed.
+ * @param path The destination file.
+ * @return int 0 if the file was written, or 1 if an error occurred.
+ */
+int pvs_save(const struct level* level, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if(file == NULL) return 1;
+
+    int row_size = pvs_row_size(level->section_count);
+    uint64_t hash = pvs_geometry_hash(level);
+    int error = fwrite(PVS_MAGIC, 1, 4, file) != 4
+        || fwrite(&level->section_count, sizeof(int), 1, file) != 1
+        || fwrite(&hash, sizeof(hash), 1, file) != 1;
+    for(int i = 0; i < level->section_count && !error; i++)
+        error = fwrite(level->sections[i]->pvs, 1, row_size, file) != (size_t) row_size;
+
+    return fclose(file) || error;
+}
+
+/**
+ * Reads the potentially visible sets of a level from a file written by pvs_save.
+ * The file is rejected unless it was written for the same walls and doors.
+ * 
+ * @param level The indexed level.
+ * @param path The file to read.
+ * @return int 0 if the sets were loaded, or 1 if the file is missing or does not match the level.
+ */
+int pvs_load(struct level* level, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if(file == NULL) return 1;
+
+    char magic[4];
+    int section_count;
+    uint64_t hash;
+    if(fread(magic, 1, 4, file) != 4 || memcmp(magic, PVS_MAGIC, 4) != 0
+        || fread(&section_count, sizeof(int), 1, file) != 1 || section_count != level->section_count
+        || fread(&hash, sizeof(hash), 1, file) != 1 || hash != pvs_geometry_hash(level)
+        || pvs_allocate(level)) {
+        fclose(file);
+        return 1;
+    }
+
+    int row_size = pvs_row_size(section_count);
+    int error = 0;
+    for(int i = 0; i < section_count && !error; i++)
+        error = fread(level->sections[i]->pvs, 1, row_size, file) != (size_t) row_size;
+
+    fclose(file);
+    return error;
+}
+
+/**
+ * Builds, for each section, the list of map walls in its potentially visible set.
+ * The renderer and the collision code only look at this list.
+ * 
+ * @param level The level, with its sets computed or loaded.
+ * @return int 0 if every list was built, or 1 if an error occurred.
+ */
+int pvs_build_visible_walls(struct level* level) {
+    for(int i = 0; i < level->section_count; i++) {
+        struct section* from = level->sections[i];
+
+        int count = 0;
+        for(int j = 0; j < level->section_count; j++)
+            if(pvs_is_visible(from, level->sections[j])) count += level->sections[j]->wall_count;
+
+        memory_free(from->visible_walls);
+        from->visible_walls = memory_alloc(MEMORY_PVS, sizeof(int) * (count > 0 ? count : 1));
+        if(from->visible_walls == NULL) return 1;
+
+        from->visible_wall_count = 0;
+        for(int j = 0; j < level->section_count; j++) {
+            struct section* to = level->sections[j];
+            if(!pvs_is_visible(from, to)) continue;
+            for(int k = 0; k < to->wall_count; k++)
+                if(to->wall_ids[k] >= 0) from->visible_walls[from->visible_wall_count++] = to->wall_ids[k];
+        }
+    }
+
+    return 0;
+}
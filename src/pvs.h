@@ -0,0 +1,55 @@
+#ifndef PVS_H
+#define PVS_H
+
+#include "levels.h"
+
+/**
+ * Computes the potentially visible set of every section of an indexed level.
+ * A section is potentially visible from another if some line of sight passes
+ * through the chain of doors between them; each door is clipped against the
+ * separating lines of the doors before it, so the result is conservative.
+ * 
+ * @param level The indexed level.
+ * @return int 0 if every set was computed, or 1 if an error occurred.
+ */
+int pvs_compute(struct level* level);
+
+/**
+ * Writes the potentially visible sets of a level to a file, after a hash of the
+ * walls and doors they were computed from.
+ * 
+ * @param level The level, with its sets computed.
+ * @param path The destination file.
+ * @return int 0 if the file was written, or 1 if an error occurred.
+ */
+int pvs_save(const struct level* level, const char* path);
+
+/**
+ * Reads the potentially visible sets of a level from a file written by pvs_save.
+ * The file is rejected unless it was written for the same walls and doors.
+ * 
+ * @param level The indexed level.
+ * @param path The file to read.
+ * @return int 0 if the sets were loaded, or 1 if the file is missing or does not match the level.
+ */
+int pvs_load(struct level* level, const char* path);
+
+/**
+ * Builds, for each section, the list of map walls in its potentially visible set.
+ * The renderer and the collision code only look at this list.
+ * 
+ * @param level The level, with its sets computed or loaded.
+ * @return int 0 if every list was built, or 1 if an error occurred.
+ */
+int pvs_build_visible_walls(struct level* level);
+
+/**
+ * Checks whether a section belongs to the potentially visible set of another.
+ * 
+ * @param from The section the player is in.
+ * @param to The section to test.
+ * @return int 1 if `to` may be visible from `from`, 0 otherwise.
+ */
+int pvs_is_visible(const struct section* from, const struct section* to);
+
+#endif
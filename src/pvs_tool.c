@@ -0,0 +1,55 @@
+// Offline tool computing the potentially visible sets of a level and storing them next to it
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "constants.h"
+#include "levels.h"
+#include "map.h"
+#include "pvs.h"
+
+/* 
+    Simplifies the map the same way the game does, builds level 1, computes the potentially
+    visible set of each section and writes them to the file given as argument (PVS_FILE by default).
+*/
+int main(int argc, char* argv[]) {
+    const char* path = argc > 1 ? argv[1] : PVS_FILE;
+    struct level level;
+    struct map_simplify_report report;
+
+    map_simplify(&report); // Sections must be built from the same walls as in the game
+    printf("%d walls simplified to %d\n", report.before, report.after);
+
+    struct section* start = create_level_1();
+    if(start == NULL || level_index(&level, start)) {
+        fprintf(stderr, "Error building level.\n");
+        return 1;
+    }
+
+    if(pvs_compute(&level) || pvs_build_visible_walls(&level)) {
+        fprintf(stderr, "Error computing potentially visible sets.\n");
+        level_destroy(&level);
+        return 1;
+    }
+
+    // Report how much geometry each section still has to consider
+    int total_walls = 0, visible_sections = 0, visible_walls = 0;
+    for(int i = 0; i < level.section_count; i++) {
+        total_walls += level.sections[i]->wall_count;
+        visible_walls += level.sections[i]->visible_wall_count;
+        for(int j = 0; j < level.section_count; j++)
+            visible_sections += pvs_is_visible(level.sections[i], level.sections[j]);
+    }
+    printf("%d sections, %d walls\n", level.section_count, total_walls);
+    printf("average PVS: %.2f sections, %.2f walls\n",
+        (double) visible_sections / level.section_count, (double) visible_walls / level.section_count);
+
+    if(pvs_save(&level, path)) {
+        fprintf(stderr, "Error writing %s.\n", path);
+        level_destroy(&level);
+        return 1;
+    }
+    printf("written to %s\n", path);
+
+    level_destroy(&level);
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "constants.h"
+#include "algebra.h"
+#include "map.h"
+#include "memory.h"
+#include "quantized.h"
+
+// Largest quantized coordinate
+#define QUANTIZED_RANGE 65535
+
+/**
+ * Quantizes the map row of one wall of a set, which must lie within the set's range.
+ * 
+ * @param set The set, with its origin, step and rows set.
+ * @param index The index of the wall in the set.
+ */
+static void encode(struct quantized_walls* set, int index) {
+    const double* row = map[set->rows[index]];
+    struct quantized_wall* wall = &set->walls[index];
+    wall->x0 = (uint16_t) lround((row[0] - set->origin_x) / set->step);
+    wall->y0 = (uint16_t) lround((row[1] - set->origin_y) / set->step);
+    wall->x1 = (uint16_t) lround((row[2] - set->origin_x) / set->step);
+    wall->y1 = (uint16_t) lround((row[3] - set->origin_y) / set->step);
+    wall->color = (uint32_t) row[4] << 24 | (uint32_t) row[5] << 16 | (uint32_t) row[6] << 8; // Material 0
+}
+
+/**
+ * Quantizes a set of map walls relative to the corner of their bounding box.
+ * The step is the smallest power of two, at least QUANTIZED_MIN_STEP, that fits the box in 16 bits.
+ * 
+ * @param set The set to build.
+ * @param walls The map table rows of the walls, or NULL for rows 0 to count - 1.
+ * @param count The number of walls.
+ * @return int 0 if the set was built, or 1 if allocation failed or the walls spread so far
+ *             that the step would exceed QUANTIZED_MAX_STEP.
+ */
+int quantized_build(struct quantized_walls* set, const int* walls, int count) {
+    double min[2] = { INFINITY, INFINITY }, max[2] = { -INFINITY, -INFINITY };
+
+    for(int k = 0; k < count; k++) {
+        int j = walls != NULL ? walls[k] : k;
+        for(int axis = 0; axis < 2; axis++) {
+            min[axis] = fmin(min[axis], fmin(map[j][axis], map[j][axis + 2]));
+            max[axis] = fmax(max[axis], fmax(map[j][axis], map[j][axis + 2]));
+        }
+    }
+    if(count == 0) min[0] = min[1] = max[0] = max[1] = 0;
+
+    double extent = fmax(max[0] - min[0], max[1] - min[1]);
+    double step = QUANTIZED_MIN_STEP;
+    while(extent / step > QUANTIZED_RANGE) step *= 2;
+    if(step > QUANTIZED_MAX_STEP) return 1;
+
+    set->origin_x = min[0];
+    set->origin_y = min[1];
+    set->step = step;
+    set->count = count;
+    set->walls = memory_alloc(MEMORY_QUANTIZED, sizeof(struct quantized_wall) * (count > 0 ? count : 1));
+    set->rows = memory_alloc(MEMORY_QUANTIZED, sizeof(int) * (count > 0 ? count : 1));
+    if(set->walls == NULL || set->rows == NULL) {
+        quantized_destroy(set);
+        return 1;
+    }
+
+    for(int k = 0; k < count; k++) {
+        set->rows[k] = walls != NULL ? walls[k] : k;
+        encode(set, k);
+    }
+
+    return 0;
+}
+
+/**
+ * Re-quantizes one wall of a set after its map row moved, keeping the set's origin and step.
+ * 
+ * @param set The set.
+ * @param index The index of the wall in the set.
+ * @return int 0 if the wall was updated, or 1 if it left the range of the set
+ *             (which must then be rebuilt).
+ */
+int quantized_update(struct quantized_walls* set, int index) {
+    const double* row = map[set->rows[index]];
+    for(int axis = 0; axis < 2; axis++) {
+        double origin = axis == 0 ? set->origin_x : set->origin_y;
+        double low = (fmin(row[axis], row[axis + 2]) - origin) / set->step;
+        double high = (fmax(row[axis], row[axis + 2]) - origin) / set->step;
+        if(low < 0 || high > QUANTIZED_RANGE) return 1;
+    }
+
+    encode(set, index);
+    return 0;
+}
+
+/**
+ * Removes a wall from a set by moving the last wall into its place.
+ * 
+ * @param set The set.
+ * @param index The index of the wall to remove.
+ */
+void quantized_remove(struct quantized_walls* set, int index) {
+    set->count--;
+    set->walls[index] = set->walls[set->count];
+    set->rows[index] = set->rows[set->count];
+}
+
+/**
+ * Returns the largest distance between a quantized endpoint and the original one,
+ * which also bounds how far any point of a quantized wall lies from the original wall.
+ * 
+ * @param set The set.
+ * @return double The error bound in world units.
+ */
+double quantized_error_bound(const struct quantized_walls* set) {
+    return set->step / 2 * sqrt(2); // Half a step of rounding on each axis
+}
+
+/**
+ * Decodes a wall back to world coordinates.
+ * 
+ * @param set The set.
+ * @param index The index of the wall in the set.
+ * @param line The endpoints as {x0, y0, x1, y1} (output).
+ */
+void quantized_decode(const struct quantized_walls* set, int index, double line[4]) {
+    const struct quantized_wall* wall = &set->walls[index];
+    line[0] = set->origin_x + wall->x0 * set->step;
+    line[1] = set->origin_y + wall->y0 * set->step;
+    line[2] = set->origin_x + wall->x1 * set->step;
+    line[3] = set->origin_y + wall->y1 * set->step;
+}
+
+/**
+ * Casts a ray against every wall of a quantized set. The ray is moved into the set's
+ * quantized frame once, so walls are tested straight from their 16-bit coordinates.
+ * Safe to call from several threads at the same time.
+ * 
+ * @param set The set.
+ * @param direction The unit direction of the ray.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param hit The closest hit, with the map table row of the wall (output).
+ */
+void raycast_quantized(const struct quantized_walls* set, const double direction[2], double x, double y, double plane_vector[2], struct ray_hit* hit) {
+    double dx = direction[0], dy = direction[1];
+    double ox = (x - set->origin_x) / set->step, oy = (y - set->origin_y) / set->step;
+    double best_t = INFINITY;
+    int best = -1;
+
+    for(int i = 0; i < set->count; i++) {
+        const struct quantized_wall* wall = &set->walls[i];
+        double ex = (double) wall->x1 - wall->x0, ey = (double) wall->y1 - wall->y0;
+        double wx = wall->x0 - ox, wy = wall->y0 - oy;
+
+        double denominator = dx * ey - dy * ex;
+        if(denominator == 0) continue; // Parallel to the ray
+
+        double t = (wx * ey - wy * ex) / denominator; // Distance along the ray, in steps
+        double u = (wx * dy - wy * dx) / denominator; // Position along the wall, from 0 to 1
+        if(t > 0 && u >= 0 && u <= 1 && t < best_t) {
+            best_t = t;
+            best = i;
+        }
+    }
+
+    if(best < 0) {
+        hit->x = 0;
+        hit->y = 0;
+        hit->distance = INFINITY;
+        hit->wall = -1;
+        hit->row = NULL;
+        return;
+    }
+
+    hit->x = x + best_t * set->step * dx;
+    hit->y = y + best_t * set->step * dy;
+    hit->distance = distance_from_line(plane_vector, x - hit->x, y - hit->y);
+    hit->wall = set->rows[best];
+    hit->row = map[hit->wall];
+}
+
+/**
+ * Frees the walls of a set.
+ * 
+ * @param set The set to destroy.
+ */
+void quantized_destroy(struct quantized_walls* set) {
+    memory_free(set->walls);
+    memory_free(set->rows);
+    set->walls = NULL;
+    set->rows = NULL;
+    set->count = 0;
+}
@@ -0,0 +1,101 @@
+#ifndef QUANTIZED_H
+#define QUANTIZED_H
+
+#include <stdint.h>
+
+#include "raycast.h"
+
+/*
+    Wall with its endpoints quantized to 16 bits relative to the origin of its set.
+    12 bytes instead of the 56 of a map table row.
+*/
+struct quantized_wall {
+    uint16_t x0, y0;    // First endpoint, in steps from the set origin
+    uint16_t x1, y1;    // Second endpoint, in steps from the set origin
+    uint32_t color;     // Packed as 0xRRGGBBMM: red, green, blue and material id
+};
+
+/*
+    Compact copy of a set of map walls (typically a section's), decoded on the fly by the ray kernel.
+    The step is a power of two, so decoding is exact and every endpoint lies within
+    step / 2 of the original on each axis.
+*/
+struct quantized_walls {
+    double origin_x;                // World x-coordinate of quantized x = 0
+    double origin_y;                // World y-coordinate of quantized y = 0
+    double step;                    // World units per quantization step
+    int count;                      // Number of walls
+    struct quantized_wall* walls;   // The quantized walls, scanned by the ray kernel
+    int* rows;                      // Map table row of each wall, only read for hits
+};
+
+/**
+ * Quantizes a set of map walls relative to the corner of their bounding box.
+ * The step is the smallest power of two, at least QUANTIZED_MIN_STEP, that fits the box in 16 bits.
+ * 
+ * @param set The set to build.
+ * @param walls The map table rows of the walls, or NULL for rows 0 to count - 1.
+ * @param count The number of walls.
+ * @return int 0 if the set was built, or 1 if allocation failed or the walls spread so far
+ *             that the step would exceed QUANTIZED_MAX_STEP.
+ */
+int quantized_build(struct quantized_walls* set, const int* walls, int count);
+
+/**
+ * Re-quantizes one wall of a set after its map row moved, keeping the set's origin and step.
+ * 
+ * @param set The set.
+ * @param index The index of the wall in the set.
+ * @return int 0 if the wall was updated, or 1 if it left the range of the set
+ *             (which must then be rebuilt).
+ */
+int quantized_update(struct quantized_walls* set, int index);
+
+/**
+ * Removes a wall from a set by moving the last wall into its place.
+ * 
+ * @param set The set.
+ * @param index The index of the wall to remove.
+ */
+void quantized_remove(struct quantized_walls* set, int index);
+
+/**
+ * Returns the largest distance between a quantized endpoint and the original one,
+ * which also bounds how far any point of a quantized wall lies from the original wall.
+ * 
+ * @param set The set.
+ * @return double The error bound in world units.
+ */
+double quantized_error_bound(const struct quantized_walls* set);
+
+/**
+ * Decodes a wall back to world coordinates.
+ * 
+ * @param set The set.
+ * @param index The index of the wall in the set.
+ * @param line The endpoints as {x0, y0, x1, y1} (output).
+ */
+void quantized_decode(const struct quantized_walls* set, int index, double line[4]);
+
+/**
+ * Casts a ray against every wall of a quantized set. The ray is moved into the set's
+ * quantized frame once, so walls are tested straight from their 16-bit coordinates.
+ * Safe to call from several threads at the same time.
+ * 
+ * @param set The set.
+ * @param direction The unit direction of the ray.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param hit The closest hit, with the map table row of the wall (output).
+ */
+void raycast_quantized(const struct quantized_walls* set, const double direction[2], double x, double y, double plane_vector[2], struct ray_hit* hit);
+
+/**
+ * Frees the walls of a set.
+ * 
+ * @param set The set to destroy.
+ */
+void quantized_destroy(struct quantized_walls* set);
+
+#endif
@@ -0,0 +1,429 @@
+#include <math.h>
+#include <stddef.h>
+
+#include "constants.h"
+#include "algebra.h"
+#include "map.h"
+#include "raycast.h"
+
+// Traversal state of one ray walking through the grid cells
+struct ray_state {
+    struct ray_setup setup; // Origin, direction and slopes of the ray
+    int column;         // Column of the current cell
+    int row;            // Row of the current cell
+    int step[2];        // Direction of the next column and row (-1 or 1)
+    double t_max[2];    // Distance along the ray to the next column and row boundary
+    double t_delta[2];  // Distance along the ray between two column and two row boundaries
+    double best_t;      // Distance along the ray to the closest hit so far
+    int done;           // 1 once the closest hit is final or the ray left the grid
+    struct ray_hit hit; // Closest hit so far
+};
+
+/**
+ * Resets a hit to "nothing hit".
+ * 
+ * @param hit The hit to reset.
+ */
+static void clear_hit(struct ray_hit* hit) {
+    hit->x = 0;
+    hit->y = 0;
+    hit->distance = INFINITY;
+    hit->wall = -1;
+    hit->row = NULL;
+}
+
+/**
+ * Casts a ray against a list of walls, testing every one of them.
+ * This is the reference every accelerated kernel must agree with.
+ * 
+ * @param walls The map table rows to test, or NULL to test rows 0 to count - 1.
+ * @param count The number of walls to test.
+ * @param direction The unit direction of the ray.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param hit The closest hit (output).
+ */
+void raycast_reference(const int* walls, int count, const double direction[2], double x, double y, double plane_vector[2], struct ray_hit* hit) {
+    struct ray_setup ray;
+    double intersection[2];
+    ray_setup_init(&ray, x, y, direction);
+    clear_hit(hit);
+
+    for(int k = 0; k < count; k++) {
+        int j = walls != NULL ? walls[k] : k;
+        if(intersection_lines(&ray, map[j], intersection)) { // Check if ray hits a wall
+            double distance = distance_from_line(plane_vector, x - intersection[0], y - intersection[1]); // Calculate perpendicular distance to wall
+            if(distance < hit->distance) { // Track the closest intersection
+                hit->x = intersection[0];
+                hit->y = intersection[1];
+                hit->distance = distance;
+                hit->wall = j;
+                hit->row = map[j];
+            }
+        }
+    }
+}
+
+/**
+ * Places a ray at the first grid cell it enters.
+ * 
+ * @param grid The grid.
+ * @param ray The ray state to initialize.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param direction The unit direction of the ray.
+ */
+static void ray_enter_grid(const struct wall_grid* grid, struct ray_state* ray, double x, double y, const double direction[2]) {
+    double origin[2] = { x, y };
+    double low[2] = { grid->min_x, grid->min_y };
+    double high[2] = { grid->min_x + grid->columns * grid->cell_size, grid->min_y + grid->rows * grid->cell_size };
+    double t_enter = 0, t_leave = INFINITY;
+
+    ray_setup_init(&ray->setup, x, y, direction);
+    ray->best_t = INFINITY;
+    ray->done = FALSE;
+    clear_hit(&ray->hit);
+
+    // Slab test against the grid bounds
+    for(int axis = 0; axis < 2; axis++) {
+        if(direction[axis] == 0) {
+            if(origin[axis] < low[axis] || origin[axis] > high[axis]) ray->done = TRUE;
+            continue;
+        }
+        double t0 = (low[axis] - origin[axis]) / direction[axis];
+        double t1 = (high[axis] - origin[axis]) / direction[axis];
+        t_enter = fmax(t_enter, fmin(t0, t1));
+        t_leave = fmin(t_leave, fmax(t0, t1));
+    }
+    if(ray->done || t_enter > t_leave) {
+        ray->done = TRUE;
+        return;
+    }
+
+    int cell[2] = {
+        grid_column(grid, x + t_enter * direction[0]),
+        grid_row(grid, y + t_enter * direction[1])
+    };
+    ray->column = cell[0];
+    ray->row = cell[1];
+
+    for(int axis = 0; axis < 2; axis++) {
+        ray->step[axis] = direction[axis] > 0 ? 1 : -1;
+        if(direction[axis] == 0) {
+            ray->t_max[axis] = INFINITY;
+            ray->t_delta[axis] = INFINITY;
+            continue;
+        }
+        double boundary = low[axis] + (cell[axis] + (ray->step[axis] > 0)) * grid->cell_size;
+        ray->t_max[axis] = (boundary - origin[axis]) / direction[axis];
+        ray->t_delta[axis] = grid->cell_size / fabs(direction[axis]);
+    }
+}
+
+/**
+ * Tests one wall against a ray, keeping it if it is the closest hit so far.
+ * 
+ * @param ray The ray state.
+ * @param line The row of the wall in the grid's table.
+ * @param wall The index of that row.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ */
+static void ray_test_wall(struct ray_state* ray, const double* line, int wall, double x, double y, double plane_vector[2]) {
+    double intersection[2];
+    if(!intersection_lines(&ray->setup, line, intersection)) return;
+
+    double t = (intersection[0] - x) * ray->setup.dx + (intersection[1] - y) * ray->setup.dy;
+    if(t >= ray->best_t) return;
+
+    ray->best_t = t;
+    ray->hit.x = intersection[0];
+    ray->hit.y = intersection[1];
+    ray->hit.distance = distance_from_line(plane_vector, x - intersection[0], y - intersection[1]);
+    ray->hit.wall = wall;
+    ray->hit.row = line;
+}
+
+/**
+ * Finishes the current cell of a ray: stops it if its closest hit lies within the cell,
+ * otherwise moves it to the next cell (stopping it if it leaves the grid).
+ * 
+ * @param grid The grid.
+ * @param ray The ray state.
+ */
+static void ray_advance(const struct wall_grid* grid, struct ray_state* ray) {
+    int axis = ray->t_max[0] < ray->t_max[1] ? 0 : 1;
+    if(ray->best_t <= ray->t_max[axis]) {
+        ray->done = TRUE;
+        return;
+    }
+
+    if(axis == 0) ray->column += ray->step[0];
+    else ray->row += ray->step[1];
+    ray->t_max[axis] += ray->t_delta[axis];
+
+    if(ray->column < 0 || ray->column >= grid->columns || ray->row < 0 || ray->row >= grid->rows)
+        ray->done = TRUE;
+}
+
+/**
+ * Walks a ray through the grid on its own until its closest hit is known.
+ * 
+ * @param grid The grid.
+ * @param ray The ray state.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ */
+static void ray_finish(const struct wall_grid* grid, struct ray_state* ray, double x, double y, double plane_vector[2]) {
+    while(!ray->done) {
+        const struct grid_cell* cell = &grid->cells[ray->row * grid->columns + ray->column];
+        for(int i = 0; i < cell->count; i++)
+            ray_test_wall(ray, &grid->table[7 * cell->walls[i]], cell->walls[i], x, y, plane_vector);
+        ray_advance(grid, ray);
+    }
+}
+
+/**
+ * Casts a ray through a grid, testing only the walls of the cells it crosses
+ * and stopping at the first cell that contains the closest hit.
+ * 
+ * @param grid The grid indexing the walls.
+ * @param direction The unit direction of the ray.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param hit The closest hit (output).
+ */
+void raycast_grid(const struct wall_grid* grid, const double direction[2], double x, double y, double plane_vector[2], struct ray_hit* hit) {
+    struct ray_state ray;
+    ray_enter_grid(grid, &ray, x, y, direction);
+    ray_finish(grid, &ray, x, y, plane_vector);
+    *hit = ray.hit;
+}
+
+/**
+ * Tests one wall against the live rays of a packet, keeping it for the rays it is the
+ * closest hit of. The wall's offset from the shared origin is computed once for the
+ * packet, and the wall is skipped for every ray when both its ends lie outside the
+ * wedge between the packet's outer rays.
+ * 
+ * @param rays The ray states of the packet, in screen order.
+ * @param first The index of the packet's first ray.
+ * @param last The index after the packet's last ray.
+ * @param line The row of the wall in the grid's table.
+ * @param wall The index of that row.
+ * @param x The x-coordinate of the rays' origin.
+ * @param y The y-coordinate of the rays' origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ */
+static void packet_test_wall(struct ray_state* rays, int first, int last, const double* line, int wall, double x, double y, double plane_vector[2]) {
+    double wx = line[0] - x, wy = line[1] - y; // Start of the wall, from the origin
+    double ex = line[2] - line[0], ey = line[3] - line[1]; // Direction of the wall
+
+    // Wedge test: the side of each end with respect to the outer rays, oriented so that
+    // the rays of the packet lie on the non-negative side of both
+    const struct ray_setup* left = &rays[first].setup;
+    const struct ray_setup* right = &rays[last - 1].setup;
+    double orientation = left->dx * right->dy - left->dy * right->dx;
+    if(orientation != 0) {
+        double sign = orientation > 0 ? 1 : -1;
+        double left_start = sign * (left->dx * wy - left->dy * wx);
+        double left_end = sign * (left->dx * (wy + ey) - left->dy * (wx + ex));
+        double right_start = sign * (right->dy * wx - right->dx * wy);
+        double right_end = sign * (right->dy * (wx + ex) - right->dx * (wy + ey));
+        if((left_start < 0 && left_end < 0) || (right_start < 0 && right_end < 0)) return;
+    }
+
+    for(int i = first; i < last; i++) {
+        struct ray_state* ray = &rays[i];
+        if(ray->done) continue;
+
+        double denominator = ray->setup.dx * ey - ray->setup.dy * ex;
+        if(denominator == 0) continue; // Parallel to the ray
+        double inverse = 1 / denominator;
+
+        double t = (wx * ey - wy * ex) * inverse; // Distance along the ray
+        if(t <= 0 || t >= ray->best_t) continue;
+        double u = (wx * ray->setup.dy - wy * ray->setup.dx) * inverse; // Position along the wall, from 0 to 1
+        if(u < 0 || u > 1) continue;
+
+        ray->best_t = t;
+        ray->hit.x = line[0] + u * ex;
+        ray->hit.y = line[1] + u * ey;
+        ray->hit.distance = distance_from_line(plane_vector, x - ray->hit.x, y - ray->hit.y);
+        ray->hit.wall = wall;
+        ray->hit.row = line;
+    }
+}
+
+/**
+ * Walks a packet of rays through the grid while its live rays share a cell. When they
+ * spread into different cells, the packet splits into runs of neighbouring rays that
+ * still share a cell, and each run goes on as a smaller packet.
+ * 
+ * @param grid The grid.
+ * @param rays The ray states, in screen order.
+ * @param first The index of the packet's first ray.
+ * @param last The index after the packet's last ray.
+ * @param x The x-coordinate of the rays' origin.
+ * @param y The y-coordinate of the rays' origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ */
+static void packet_walk(const struct wall_grid* grid, struct ray_state* rays, int first, int last, double x, double y, double plane_vector[2]) {
+    for(;;) {
+        // The packet stays together while every live ray is in the same cell
+        int leader = -1, coherent = TRUE;
+        for(int i = first; i < last && coherent; i++) {
+            if(rays[i].done) continue;
+            if(leader < 0) leader = i;
+            else coherent = rays[i].column == rays[leader].column && rays[i].row == rays[leader].row;
+        }
+        if(leader < 0) return; // Every ray is done
+
+        if(!coherent) { // Diverged: go on with each run of neighbouring rays sharing a cell
+            int run = leader;
+            while(run < last) {
+                int end = run + 1;
+                while(end < last && (rays[end].done || (rays[end].column == rays[run].column && rays[end].row == rays[run].row)))
+                    end++;
+                packet_walk(grid, rays, run, end, x, y, plane_vector);
+                for(run = end; run < last && rays[run].done; run++);
+            }
+            return;
+        }
+
+        // One cell fetch, and one wedge test per wall, for the whole packet
+        const struct grid_cell* cell = &grid->cells[rays[leader].row * grid->columns + rays[leader].column];
+        for(int w = 0; w < cell->count; w++)
+            packet_test_wall(rays, first, last, &grid->table[7 * cell->walls[w]], cell->walls[w], x, y, plane_vector);
+
+        for(int i = leader; i < last; i++)
+            if(!rays[i].done) ray_advance(grid, &rays[i]);
+    }
+}
+
+/**
+ * Casts up to RAY_PACKET_MAX neighbouring rays sharing an origin through a grid together.
+ * The packet fetches each cell once and tests each of its walls against all its rays,
+ * sharing the wall's setup and skipping walls outside the wedge of the rays; it splits
+ * into smaller packets only where its rays spread into different cells.
+ * 
+ * @param grid The grid indexing the walls.
+ * @param directions The unit direction of each ray, in screen order.
+ * @param count The number of rays, at most RAY_PACKET_MAX.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param hits The closest hit of each ray (output).
+ */
+void raycast_packet(const struct wall_grid* grid, double (*directions)[2], int count, double x, double y, double plane_vector[2], struct ray_hit* hits) {
+    struct ray_state rays[RAY_PACKET_MAX];
+    if(count > RAY_PACKET_MAX) count = RAY_PACKET_MAX;
+
+    for(int i = 0; i < count; i++) ray_enter_grid(grid, &rays[i], x, y, directions[i]);
+    packet_walk(grid, rays, 0, count, x, y, plane_vector);
+    for(int i = 0; i < count; i++) hits[i] = rays[i].hit;
+}
+
+/**
+ * Checks whether the rays between two samples can be taken from the samples' wall.
+ * 
+ * @param a The hit of the first sample.
+ * @param b The hit of the second sample.
+ * @return int 1 if both samples see the same wall (or nothing) without a distance jump, 0 otherwise.
+ */
+static int samples_agree(const struct ray_hit* a, const struct ray_hit* b) {
+    if(a->wall != b->wall) return 0;
+    if(a->wall < 0) return 1; // Both rays escape: treat the gap as empty
+    return fabs(a->distance - b->distance) <= ADAPTIVE_DISTANCE_JUMP;
+}
+
+/**
+ * Resolves every ray strictly between two cast samples.
+ * 
+ * @param grid The grid indexing the walls.
+ * @param directions The unit direction of each ray.
+ * @param first The index of the first sample.
+ * @param last The index of the second sample.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param hits The hits, filled for first and last (updated in place).
+ * @return int The number of rays cast through the grid.
+ */
+static int refine_interval(const struct wall_grid* grid, double (*directions)[2], int first, int last,
+    double x, double y, double plane_vector[2], struct ray_hit* hits) {
+    if(last - first < 2) return 0;
+
+    if(samples_agree(&hits[first], &hits[last])) {
+        int wall = hits[first].wall;
+        const double* line = hits[first].row;
+        struct ray_setup ray;
+        double intersection[2];
+
+        for(int i = first + 1; i < last; i++) {
+            if(wall < 0) {
+                clear_hit(&hits[i]);
+                continue;
+            }
+
+            ray_setup_init(&ray, x, y, directions[i]);
+            if(intersection_lines(&ray, line, intersection)) {
+                hits[i].x = intersection[0];
+                hits[i].y = intersection[1];
+                hits[i].distance = distance_from_line(plane_vector, x - intersection[0], y - intersection[1]);
+                hits[i].wall = wall;
+                hits[i].row = line;
+            } else {
+                // The ray slipped past the wall's end after all: cast it and resolve the rest properly
+                raycast_grid(grid, directions[i], x, y, plane_vector, &hits[i]);
+                return 1 + refine_interval(grid, directions, i, last, x, y, plane_vector, hits);
+            }
+        }
+        return 0;
+    }
+
+    int middle = (first + last) / 2;
+    raycast_grid(grid, directions[middle], x, y, plane_vector, &hits[middle]);
+    return 1 + refine_interval(grid, directions, first, middle, x, y, plane_vector, hits)
+        + refine_interval(grid, directions, middle, last, x, y, plane_vector, hits);
+}
+
+/**
+ * Casts a fan of rays by sampling every `step`th ray and refining only where needed.
+ * Between two samples that hit the same wall at similar distances, the rays in between
+ * are intersected with that wall alone, which is exact for flat walls. Elsewhere the
+ * interval is split in half and its middle ray is cast, recursively.
+ * 
+ * @param grid The grid indexing the walls.
+ * @param directions The unit direction of each ray, in screen order.
+ * @param count The number of rays.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param step The distance between two initial samples, in rays.
+ * @param hits The closest hit of each ray (output).
+ * @return int The number of rays actually cast through the grid.
+ */
+int raycast_adaptive(const struct wall_grid* grid, double (*directions)[2], int count, double x, double y, double plane_vector[2], int step, struct ray_hit* hits) {
+    int cast = 0;
+    if(count <= 0) return 0;
+    if(step < 1) step = 1;
+
+    int previous = 0;
+    raycast_grid(grid, directions[0], x, y, plane_vector, &hits[0]);
+    cast++;
+
+    while(previous < count - 1) {
+        int next = previous + step < count - 1 ? previous + step : count - 1;
+        raycast_grid(grid, directions[next], x, y, plane_vector, &hits[next]);
+        cast += 1 + refine_interval(grid, directions, previous, next, x, y, plane_vector, hits);
+        previous = next;
+    }
+
+    return cast;
+}
+
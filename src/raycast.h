@@ -0,0 +1,90 @@
+#ifndef RAYCAST_H
+#define RAYCAST_H
+
+#include "grid.h"
+
+// Largest number of rays traced together by raycast_packet
+#define RAY_PACKET_MAX 8
+
+// Kernels available to cast the camera rays
+enum cast_mode {
+    CAST_REFERENCE, // Every candidate wall tested by every ray
+    CAST_GRID,      // Each ray walks the grid on its own
+    CAST_PACKET,    // Adjacent rays walk the grid together
+    CAST_ADAPTIVE,  // Every Nth ray is cast, the columns in between are refined or interpolated
+    CAST_SPANS,     // No rays: walls are projected to column spans front to back (span.c)
+    CAST_QUANTIZED, // Every candidate wall tested from its compact 16-bit copy (quantized.c)
+    CAST_MODE_COUNT
+};
+
+// Closest wall hit by a ray
+struct ray_hit {
+    double x;           // The x-coordinate of the intersection
+    double y;           // The y-coordinate of the intersection
+    double distance;    // Perpendicular distance from the camera plane, INFINITY if nothing was hit
+    int wall;           // Row of the wall hit in the table cast against, -1 if nothing was hit
+    const double* row;  // That row (endpoints and color), NULL if nothing was hit
+};
+
+/**
+ * Casts a ray against a list of walls, testing every one of them.
+ * This is the reference every accelerated kernel must agree with.
+ * 
+ * @param walls The map table rows to test, or NULL to test rows 0 to count - 1.
+ * @param count The number of walls to test.
+ * @param direction The unit direction of the ray.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param hit The closest hit (output).
+ */
+void raycast_reference(const int* walls, int count, const double direction[2], double x, double y, double plane_vector[2], struct ray_hit* hit);
+
+/**
+ * Casts a ray through a grid, testing only the walls of the cells it crosses
+ * and stopping at the first cell that contains the closest hit.
+ * 
+ * @param grid The grid indexing the walls.
+ * @param direction The unit direction of the ray.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param hit The closest hit (output).
+ */
+void raycast_grid(const struct wall_grid* grid, const double direction[2], double x, double y, double plane_vector[2], struct ray_hit* hit);
+
+/**
+ * Casts up to RAY_PACKET_MAX neighbouring rays sharing an origin through a grid together.
+ * The packet fetches each cell once and tests each of its walls against all its rays,
+ * sharing the wall's setup and skipping walls outside the wedge of the rays; it splits
+ * into smaller packets only where its rays spread into different cells.
+ * 
+ * @param grid The grid indexing the walls.
+ * @param directions The unit direction of each ray, in screen order.
+ * @param count The number of rays, at most RAY_PACKET_MAX.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param hits The closest hit of each ray (output).
+ */
+void raycast_packet(const struct wall_grid* grid, double (*directions)[2], int count, double x, double y, double plane_vector[2], struct ray_hit* hits);
+
+/**
+ * Casts a fan of rays by sampling every `step`th ray and refining only where needed.
+ * Between two samples that hit the same wall at similar distances, the rays in between
+ * are intersected with that wall alone, which is exact for flat walls. Elsewhere the
+ * interval is split in half and its middle ray is cast, recursively.
+ * 
+ * @param grid The grid indexing the walls.
+ * @param directions The unit direction of each ray, in screen order.
+ * @param count The number of rays.
+ * @param x The x-coordinate of the ray origin.
+ * @param y The y-coordinate of the ray origin.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param step The distance between two initial samples, in rays.
+ * @param hits The closest hit of each ray (output).
+ * @return int The number of rays actually cast through the grid.
+ */
+int raycast_adaptive(const struct wall_grid* grid, double (*directions)[2], int count, double x, double y, double plane_vector[2], int step, struct ray_hit* hits);
+
+#endif
@@ -1,4 +1,8 @@
 #include "section.h"
+#include "map.h"
+#include "constants.h"
+#include "collision.h"
+#include "memory.h"
 
 #include <malloc.h>
 
@@ -10,22 +14,36 @@
  * @return struct section* Pointer to the newly created section, or NULL if allocation fails.
  */
 struct section* section_create(int door_max, int wall_max) {
-    struct section* new = malloc(sizeof(struct section));
+    struct section* new = memory_alloc(MEMORY_SECTIONS, sizeof(struct section));
     if(new == NULL) return NULL; 
 
-    new->doors = malloc(sizeof(struct door) * door_max);
+    new->doors = memory_alloc(MEMORY_SECTIONS, sizeof(struct door) * door_max);
     if(new->doors == NULL) {
-        free(new);
+        memory_free(new);
         return NULL;
     }
 
-    new->walls = malloc(sizeof(struct line) * wall_max);
+    new->walls = memory_alloc(MEMORY_SECTIONS, sizeof(struct line) * wall_max);
     if(new->walls == NULL) {
-        free(new->doors);
-        free(new);
+        memory_free(new->doors);
+        memory_free(new);
         return NULL;
     }
 
+    new->wall_ids = memory_alloc(MEMORY_SECTIONS, sizeof(int) * wall_max);
+    if(new->wall_ids == NULL) {
+        memory_free(new->walls);
+        memory_free(new->doors);
+        memory_free(new);
+        return NULL;
+    }
+
+    new->id = -1;
+    new->pvs = NULL;
+    new->visible_walls = NULL;
+    new->visible_wall_count = 0;
+    new->grid = NULL;
+    new->quantized = NULL;
     new->wall_count = 0;
     new->wall_max = wall_max;
     new->door_count = 0;
@@ -46,10 +64,39 @@ int section_add_door(struct section* section, struct line door, struct door* des
     if(section->door_count == section->door_max) return 1;
     section->doors[section->door_count].dest = dest;
     section->doors[section->door_count].position = door;
+    section->doors[section->door_count].room = section;
     section->door_count++;
     return 0; 
 }
 
+/**
+ * Moves a door, and the door it leads to, which shares its position.
+ * Doors are portals, not walls, so no broad-phase index changes; the potentially
+ * visible sets are kept as computed for the original position.
+ * 
+ * @param door The door to move.
+ * @param position The new position of the door.
+ */
+void section_move_door(struct door* door, struct line position) {
+    door->position = position;
+    if(door->dest != NULL) door->dest->position = position;
+}
+
+/**
+ * Removes a door from a section by moving its last door into its place,
+ * and unlinks the door it led to.
+ * 
+ * @param section The section.
+ * @param index The index of the door to remove.
+ */
+void section_remove_door(struct section* section, int index) {
+    struct door* door = &section->doors[index];
+    if(door->dest != NULL) door->dest->dest = NULL;
+
+    *door = section->doors[--section->door_count];
+    if(index < section->door_count && door->dest != NULL) door->dest->dest = door; // Follow the moved door
+}
+
 /**
  * Adds a wall to the specified section.
  * 
@@ -60,6 +107,129 @@ int section_add_door(struct section* section, struct line door, struct door* des
 int section_add_wall(struct section* section, struct line wall) {
     if(section->wall_count == section->wall_max) return 1;
     section->walls[section->wall_count] = wall;
+    section->wall_ids[section->wall_count] = -1;
     section->wall_count++;
     return 0;
 }
+
+/**
+ * Adds a wall of the map table to the specified section.
+ * 
+ * @param section The section to which the wall will be added.
+ * @param map_index The row of the wall in the map table.
+ * @return int 0 if the addition was successful, or 1 if an error occurred.
+ */
+int section_add_map_wall(struct section* section, int map_index) {
+    struct line wall = { map[map_index][0], map[map_index][1], map[map_index][2], map[map_index][3] };
+    if(section_add_wall(section, wall)) return 1;
+    section->wall_ids[section->wall_count - 1] = map_index;
+    return 0;
+}
+
+/**
+ * Builds the broad-phase grid over the walls in the section's potentially visible set.
+ * Every wall the player can touch from this section is visible from it, so the grid
+ * also serves collision.
+ * 
+ * @param section The section, with its visible walls built.
+ * @return int 0 if the grid was built, or 1 if an error occurred.
+ */
+int section_build_grid(struct section* section) {
+    if(section->grid != NULL) grid_destroy(section->grid);
+    else section->grid = memory_alloc(MEMORY_GRIDS, sizeof(struct wall_grid));
+    if(section->grid == NULL) return 1;
+
+    if(grid_build(section->grid, section->visible_walls, section->visible_wall_count, GRID_CELL_SIZE)) {
+        memory_free(section->grid);
+        section->grid = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Builds the compact quantized copy of the walls in the section's potentially visible set,
+ * relative to their bounding box.
+ * 
+ * @param section The section, with its visible walls built.
+ * @return int 0 if the copy was built, or 1 if allocation failed or the walls are too spread
+ *             out to quantize accurately (the section then keeps only the double walls).
+ */
+int section_build_quantized(struct section* section) {
+    if(section->quantized != NULL) quantized_destroy(section->quantized);
+    else section->quantized = memory_alloc(MEMORY_QUANTIZED, sizeof(struct quantized_walls));
+    if(section->quantized == NULL) return 1;
+
+    if(quantized_build(section->quantized, section->visible_walls, section->visible_wall_count)) {
+        memory_free(section->quantized);
+        section->quantized = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Checks for collision between the player and the section's walls.
+ * Returns the point of collision if any, or the desired point if no collision occurs.
+ * The player is swept as a circle of diameter player->width and slides along the walls it hits.
+ * 
+ * @param section The section to check for collisions.
+ * @param player The player object.
+ * @param desired_point The point the player is trying to reach.
+ * @return struct point The actual point of collision, or the desired point if no collision occurs.
+ */
+struct point section_check_collision(struct section* section, struct player* player, struct point desired_point) {
+    if(section->grid == NULL) return desired_point;
+
+    struct point start = { player->x, player->y };
+    return collide_and_slide(section->grid, start, desired_point, player->width / 2);
+}
+
+/**
+ * Determines if the player is attempting to leave the current section through a door.
+ * If a door is found, the function returns the section that the player is entering.
+ * 
+ * @param section The current section.
+ * @param player The player object.
+ * @param desired_point The point the player is trying to reach.
+ * @return struct section* The section the player is entering through the door, or NULL if no door is found.
+ */
+struct section* section_check_leaving(struct section* section, struct player* player, struct point desired_point) {
+    struct line path = { player->x, player->y, desired_point.x, desired_point.y };
+
+    for(int i = 0; i < section->door_count; i++) {
+        struct door* door = &section->doors[i];
+        if(door->dest == NULL) continue;
+
+        // The door line itself counts as the non-positive side, so standing exactly
+        // on a door never registers a crossing twice
+        struct point door_start = { door->position.x0, door->position.y0 };
+        struct point door_end = { door->position.xf, door->position.yf };
+        struct point start = { player->x, player->y };
+        int start_side = side_of_line(door_start, door_end, start) > 0;
+        int end_side = side_of_line(door_start, door_end, desired_point) > 0;
+
+        if(start_side != end_side && segments_intersect(path, door->position)) return door->dest->room;
+    }
+
+    return NULL;
+}
+
+/**
+ * Destroys a section and frees allocated resources.
+ * 
+ * @param s The section to be destroyed.
+ */
+void section_destroy(struct section* s) {
+    if(s == NULL) return;
+    if(s->grid != NULL) grid_destroy(s->grid);
+    memory_free(s->grid);
+    if(s->quantized != NULL) quantized_destroy(s->quantized);
+    memory_free(s->quantized);
+    memory_free(s->visible_walls);
+    memory_free(s->pvs);
+    memory_free(s->wall_ids);
+    memory_free(s->walls);
+    memory_free(s->doors);
+    memory_free(s);
+}
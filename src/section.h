@@ -3,6 +3,8 @@
 
 #include <SDL2/SDL.h> // SDL library for graphics
 #include "algebra.h"
+#include "grid.h"
+#include "quantized.h"
 #include "player.h"
 
 // Structure representing a door in the section
@@ -14,6 +16,8 @@ struct door {
 
 // Structure representing a section (room)
 struct section {
+    int id;                   // Index of the section in its level, -1 until the level is indexed
+
     int door_max;             // Maximum number of doors in the section
     int door_count;           // Current count of doors in the section
     struct door* doors;       // List of doors in the section
@@ -21,6 +25,13 @@ struct section {
     int wall_max;             // Maximum number of walls in the section
     int wall_count;           // Current count of walls in the section
     struct line* walls;       // List of walls in the section
+    int* wall_ids;            // Map table row of each wall, -1 for walls not in the map
+
+    unsigned char* pvs;       // Potentially visible set: bit i is set if section i can be seen from here
+    int* visible_walls;       // Map rows of every wall in the potentially visible sections
+    int visible_wall_count;   // Number of entries in visible_walls
+    struct wall_grid* grid;   // Broad-phase index over visible_walls, NULL until built
+    struct quantized_walls* quantized; // Compact copy of visible_walls, NULL until built or if too spread out
 };
 
 /**
@@ -42,6 +53,25 @@ struct section* section_create(int door_max, int wall_max);
  */
 int section_add_door(struct section* section, struct line door, struct door* dest);
 
+/**
+ * Moves a door, and the door it leads to, which shares its position.
+ * Doors are portals, not walls, so no broad-phase index changes; the potentially
+ * visible sets are kept as computed for the original position.
+ * 
+ * @param door The door to move.
+ * @param position The new position of the door.
+ */
+void section_move_door(struct door* door, struct line position);
+
+/**
+ * Removes a door from a section by moving its last door into its place,
+ * and unlinks the door it led to.
+ * 
+ * @param section The section.
+ * @param index The index of the door to remove.
+ */
+void section_remove_door(struct section* section, int index);
+
 /**
  * Adds a wall to the specified section.
  * 
@@ -51,6 +81,15 @@ int section_add_door(struct section* section, struct line door, struct door* des
  */
 int section_add_wall(struct section* section, struct line wall);
 
+/**
+ * Adds a wall of the map table to the specified section.
+ * 
+ * @param section The section to which the wall will be added.
+ * @param map_index The row of the wall in the map table.
+ * @return int 0 if the addition was successful, or 1 if an error occurred.
+ */
+int section_add_map_wall(struct section* section, int map_index);
+
 /**
  * Renders a section and handles rendering additional sections if needed.
  * This function handles cases where rays intersect with doors,
@@ -62,9 +101,30 @@ int section_add_wall(struct section* section, struct line wall);
  */
 void section_render(struct section* section, SDL_Renderer* renderer, struct player* player);
 
+/**
+ * Builds the broad-phase grid over the walls in the section's potentially visible set.
+ * Every wall the player can touch from this section is visible from it, so the grid
+ * also serves collision.
+ * 
+ * @param section The section, with its visible walls built.
+ * @return int 0 if the grid was built, or 1 if an error occurred.
+ */
+int section_build_grid(struct section* section);
+
+/**
+ * Builds the compact quantized copy of the walls in the section's potentially visible set,
+ * relative to their bounding box.
+ * 
+ * @param section The section, with its visible walls built.
+ * @return int 0 if the copy was built, or 1 if allocation failed or the walls are too spread
+ *             out to quantize accurately (the section then keeps only the double walls).
+ */
+int section_build_quantized(struct section* section);
+
 /**
  * Checks for collision between the player and the section's walls.
  * Returns the point of collision if any, or the desired point if no collision occurs.
+ * The player is swept as a circle of diameter player->width and slides along the walls it hits.
  * 
  * @param section The section to check for collisions.
  * @param player The player object.
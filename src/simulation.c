@@ -0,0 +1,181 @@
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "constants.h"
+#include "gametime.h"
+#include "player.h"
+#include "simulation.h"
+
+// Flag ORed into the shared slot index when it holds a snapshot the renderer has not seen
+#define SNAPSHOT_FRESH 4
+
+// External variables defined in player.h
+extern struct player player;
+
+/**
+ * Initializes the triple buffer, filling every slot with the same snapshot.
+ * 
+ * @param buffer The triple buffer to initialize.
+ * @param initial The snapshot visible before the first publish.
+ */
+void snapshot_buffer_init(struct snapshot_buffer* buffer, const struct world_snapshot* initial) {
+    for(int i = 0; i < 3; i++) buffer->slots[i] = *initial;
+    buffer->front = 0;
+    atomic_init(&buffer->middle, 1);
+    buffer->back = 2;
+}
+
+/**
+ * Returns the slot the simulation may fill for the next publish.
+ * 
+ * @param buffer The triple buffer.
+ * @return struct world_snapshot* The writer-owned slot.
+ */
+struct world_snapshot* snapshot_begin_write(struct snapshot_buffer* buffer) {
+    return &buffer->slots[buffer->back];
+}
+
+/**
+ * Publishes the slot returned by snapshot_begin_write, replacing any unread snapshot.
+ * 
+ * @param buffer The triple buffer.
+ */
+void snapshot_publish(struct snapshot_buffer* buffer) {
+    int previous = atomic_exchange(&buffer->middle, buffer->back | SNAPSHOT_FRESH);
+    buffer->back = previous & ~SNAPSHOT_FRESH;
+}
+
+/**
+ * Returns the most recently published snapshot.
+ * The snapshot stays valid and unchanged until the next call.
+ * 
+ * @param buffer The triple buffer.
+ * @return const struct world_snapshot* The latest snapshot.
+ */
+const struct world_snapshot* snapshot_acquire(struct snapshot_buffer* buffer) {
+    if(atomic_load(&buffer->middle) & SNAPSHOT_FRESH) {
+        int previous = atomic_exchange(&buffer->middle, buffer->front);
+        buffer->front = previous & ~SNAPSHOT_FRESH;
+    }
+    return &buffer->slots[buffer->front];
+}
+
+/**
+ * Applies the latest input to the player. Runs on the simulation thread.
+ * 
+ * @param sim The simulation.
+ */
+static void apply_input(struct simulation* sim) {
+    struct sim_input input;
+
+    SDL_LockMutex(sim->input_lock);
+    input = sim->input;
+    sim->input.reset = FALSE;
+    SDL_UnlockMutex(sim->input_lock);
+
+    if(input.reset) setup_player();
+    player.move_set = input.move_set;
+    player.rotation = input.rotation;
+    if(input.look_at) rotate_player_towards(input.look_x, input.look_y);
+}
+
+/**
+ * Simulation thread: applies input, advances the player and publishes a snapshot
+ * at a fixed tick rate while the renderer draws the previous one.
+ * 
+ * @param data The simulation.
+ * @return int Always 0.
+ */
+static int simulation_thread(void* data) {
+    struct simulation* sim = data;
+
+    get_delta_time(); // Start measuring from the first tick
+    while(atomic_load(&sim->running)) {
+        Uint64 tick_start = SDL_GetTicks64();
+
+        apply_input(sim);
+        double delta_time = get_delta_time();
+
+        SDL_LockMutex(sim->world_lock); // Collision reads the level's grids and the streamed chunks
+        update_player(delta_time, sim->streamer);
+        SDL_UnlockMutex(sim->world_lock);
+        if(sim->doors != NULL) sliding_doors_step(sim->doors, sim->door_open, player.x, player.y, delta_time);
+
+        struct world_snapshot* snapshot = snapshot_begin_write(&sim->snapshots);
+        snapshot->player = player;
+        snapshot->tick = ++sim->tick;
+        memcpy(snapshot->door_open, sim->door_open, sizeof(sim->door_open));
+        snapshot_publish(&sim->snapshots);
+
+        Uint64 elapsed = SDL_GetTicks64() - tick_start;
+        if(elapsed < 1000 / SIM_TICK_RATE) SDL_Delay(1000 / SIM_TICK_RATE - elapsed);
+    }
+
+    return 0;
+}
+
+/**
+ * Starts the simulation thread. The player must already be set up, sim->doors
+ * set to the doors it should open (or NULL), and sim->streamer to the chunks to
+ * collide with (or NULL).
+ * 
+ * @param sim The simulation to start.
+ * @return int 0 if the thread was started, or 1 if an error occurred.
+ */
+int simulation_start(struct simulation* sim) {
+    struct world_snapshot initial = { player, 0, { 0 } };
+    memset(sim->door_open, 0, sizeof(sim->door_open)); // Every door starts closed
+    snapshot_buffer_init(&sim->snapshots, &initial);
+
+    sim->input.move_set = player.move_set;
+    sim->input.rotation = 0;
+    sim->input.look_at = FALSE;
+    sim->input.reset = FALSE;
+    sim->tick = 0;
+
+    sim->input_lock = SDL_CreateMutex();
+    sim->world_lock = SDL_CreateMutex();
+    if(sim->input_lock == NULL || sim->world_lock == NULL) {
+        if(sim->world_lock != NULL) SDL_DestroyMutex(sim->world_lock);
+        if(sim->input_lock != NULL) SDL_DestroyMutex(sim->input_lock);
+        return 1;
+    }
+
+    atomic_init(&sim->running, TRUE);
+    sim->thread = SDL_CreateThread(simulation_thread, "simulation", sim);
+    if(sim->thread == NULL) {
+        fprintf(stderr, "Error starting simulation thread: %s\n", SDL_GetError());
+        SDL_DestroyMutex(sim->world_lock);
+        SDL_DestroyMutex(sim->input_lock);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Replaces the input read by the simulation on its next tick.
+ * The reset request is sticky until the simulation consumes it.
+ * 
+ * @param sim The simulation.
+ * @param input The new input.
+ */
+void simulation_set_input(struct simulation* sim, const struct sim_input* input) {
+    SDL_LockMutex(sim->input_lock);
+    int reset = sim->input.reset || input->reset;
+    sim->input = *input;
+    sim->input.reset = reset;
+    SDL_UnlockMutex(sim->input_lock);
+}
+
+/**
+ * Stops the simulation thread and frees its resources.
+ * 
+ * @param sim The simulation to stop.
+ */
+void simulation_stop(struct simulation* sim) {
+    atomic_store(&sim->running, FALSE);
+    SDL_WaitThread(sim->thread, NULL);
+    SDL_DestroyMutex(sim->world_lock);
+    SDL_DestroyMutex(sim->input_lock);
+}
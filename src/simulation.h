@@ -0,0 +1,123 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <stdatomic.h>
+#include <SDL2/SDL.h>
+
+#include "doors.h"
+#include "player.h"
+
+struct chunk_streamer;
+
+/*
+    Immutable copy of the simulated state, published once per simulation tick.
+    The renderer only ever reads snapshots, never the live simulation state.
+*/
+struct world_snapshot {
+    struct player player;   // Player state at the end of the tick
+    unsigned long tick;     // Simulation tick that produced the snapshot
+    double door_open[SLIDING_DOOR_MAX]; // Openness of each sliding door, from 0 (closed) to 1 (open)
+};
+
+/*
+    Lock-free triple buffer of snapshots.
+    The simulation writes into `back`, the renderer reads `front`, and the third
+    slot is exchanged atomically through `middle`. Neither side ever waits for the other.
+*/
+struct snapshot_buffer {
+    struct world_snapshot slots[3]; // Storage for the three snapshots
+    atomic_int middle;              // Shared slot index, ORed with SNAPSHOT_FRESH when unread
+    int back;                       // Slot owned by the simulation thread
+    int front;                      // Slot owned by the render thread
+};
+
+/*
+    Input gathered by the render thread for the simulation thread.
+    Guarded by a mutex: it is touched once per frame and once per tick.
+*/
+struct sim_input {
+    struct move_set move_set;   // Movement keys currently held
+    double rotation;            // Rotation requested by the mouse (first-person mode)
+    int look_at;                // 1 if the player should face (look_x, look_y)
+    double look_x;              // World x-coordinate to face (top-down mode)
+    double look_y;              // World y-coordinate to face (top-down mode)
+    int reset;                  // 1 if the player should be reset on the next tick
+};
+
+/*
+    Structure holding the simulation thread and the state it shares with the renderer.
+*/
+struct simulation {
+    struct snapshot_buffer snapshots; // Snapshots published to the renderer
+    struct sim_input input;           // Latest input from the render thread
+    SDL_mutex* input_lock;            // Guards input
+    atomic_int running;               // Cleared to stop the simulation thread
+    SDL_Thread* thread;               // The simulation thread
+    unsigned long tick;               // Number of ticks simulated so far
+
+    const struct sliding_doors* doors;  // Doors opened by the player, NULL if none (set before starting)
+    struct chunk_streamer* streamer;    // Streamed chunks the player collides with, NULL if not streaming (set before starting)
+    double door_open[SLIDING_DOOR_MAX]; // Openness of each door, owned by the simulation thread
+    SDL_mutex* world_lock;              // Held by the simulation while it reads the level, and by the
+                                        // renderer while it edits it (the renderer reads it freely)
+};
+
+/**
+ * Initializes the triple buffer, filling every slot with the same snapshot.
+ * 
+ * @param buffer The triple buffer to initialize.
+ * @param initial The snapshot visible before the first publish.
+ */
+void snapshot_buffer_init(struct snapshot_buffer* buffer, const struct world_snapshot* initial);
+
+/**
+ * Returns the slot the simulation may fill for the next publish.
+ * 
+ * @param buffer The triple buffer.
+ * @return struct world_snapshot* The writer-owned slot.
+ */
+struct world_snapshot* snapshot_begin_write(struct snapshot_buffer* buffer);
+
+/**
+ * Publishes the slot returned by snapshot_begin_write, replacing any unread snapshot.
+ * 
+ * @param buffer The triple buffer.
+ */
+void snapshot_publish(struct snapshot_buffer* buffer);
+
+/**
+ * Returns the most recently published snapshot.
+ * The snapshot stays valid and unchanged until the next call.
+ * 
+ * @param buffer The triple buffer.
+ * @return const struct world_snapshot* The latest snapshot.
+ */
+const struct world_snapshot* snapshot_acquire(struct snapshot_buffer* buffer);
+
+/**
+ * Starts the simulation thread. The player must already be set up, sim->doors
+ * set to the doors it should open (or NULL), and sim->streamer to the chunks to
+ * collide with (or NULL).
+ * 
+ * @param sim The simulation to start.
+ * @return int 0 if the thread was started, or 1 if an error occurred.
+ */
+int simulation_start(struct simulation* sim);
+
+/**
+ * Replaces the input read by the simulation on its next tick.
+ * The reset request is sticky until the simulation consumes it.
+ * 
+ * @param sim The simulation.
+ * @param input The new input.
+ */
+void simulation_set_input(struct simulation* sim, const struct sim_input* input);
+
+/**
+ * Stops the simulation thread and frees its resources.
+ * 
+ * @param sim The simulation to stop.
+ */
+void simulation_stop(struct simulation* sim);
+
+#endif
@@ -0,0 +1,154 @@
+// std
+#include <math.h>
+#include <stdlib.h>
+#include <SDL2/SDL.h>
+
+#include "constants.h"
+#include "memory.h"
+#include "sky.h"
+
+// Packs color channels into an RGBA8888 pixel
+#define RGBA_PIXEL(r, g, b, a) (((Uint32) (r) << 24) | ((Uint32) (g) << 16) | ((Uint32) (b) << 8) | (Uint32) (a))
+
+/**
+ * Returns the height of the hills at a panorama column. A sum of sines whose periods divide
+ * the panorama width, so the band wraps around seamlessly.
+ *
+ * @param column The panorama column.
+ * @return double The height in pixels, within [0, SKY_HILL_HEIGHT].
+ */
+static double hill_height(int column) {
+    double turn = 2 * PI * column / SKY_PANORAMA_WIDTH;
+    double shape = 0.55 + 0.25 * sin(3 * turn) + 0.15 * sin(7 * turn + 1) + 0.05 * sin(19 * turn + 2);
+    return SKY_HILL_HEIGHT * shape;
+}
+
+/**
+ * Fills the jump profile and renders the sky textures.
+ *
+ * @param sky The sky to build.
+ * @param renderer The renderer the textures are created for.
+ * @return int 0 if the sky was built, or 1 if a texture could not be created
+ *             (the jump profile is filled anyway and sky_draw falls back to a flat sky).
+ */
+int sky_init(struct sky* sky, SDL_Renderer* renderer) {
+    // Columns sink slightly more towards one side of the screen while jumping
+    for(int i = 0; i < RAYS_NUMBER; i++)
+        sky->jump_profile[i] = 0.7 * cos(((i - WINDOW_WIDTH/8) * FOV / WINDOW_WIDTH) / 4);
+
+    sky->gradient = NULL;
+    sky->hills = NULL;
+
+    // Sky gradient, from deep blue at the top to the old flat sky color at the horizon
+    Uint32 gradient[WINDOW_HEIGHT];
+    for(int y = 0; y < WINDOW_HEIGHT; y++) {
+        double t = (double) y / (WINDOW_HEIGHT - 1);
+        gradient[y] = RGBA_PIXEL(60 + 90 * t, 80 + 70 * t, 140 + 40 * t, 255);
+    }
+
+    Uint32* hills = memory_alloc(MEMORY_RENDER, sizeof(Uint32) * SKY_PANORAMA_WIDTH * SKY_HILL_HEIGHT);
+    if(hills == NULL) return 1;
+    for(int x = 0; x < SKY_PANORAMA_WIDTH; x++) {
+        int top = SKY_HILL_HEIGHT - (int) hill_height(x);
+        for(int y = 0; y < SKY_HILL_HEIGHT; y++)
+            hills[y * SKY_PANORAMA_WIDTH + x] = y < top ? 0 : RGBA_PIXEL(70, 80, 100, 255);
+    }
+
+    sky->gradient = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC, 1, WINDOW_HEIGHT);
+    sky->hills = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC, SKY_PANORAMA_WIDTH, SKY_HILL_HEIGHT);
+    if(sky->gradient == NULL || sky->hills == NULL
+        || SDL_UpdateTexture(sky->gradient, NULL, gradient, sizeof(Uint32))
+        || SDL_UpdateTexture(sky->hills, NULL, hills, sizeof(Uint32) * SKY_PANORAMA_WIDTH)) {
+        memory_free(hills);
+        sky_destroy(sky);
+        return 1;
+    }
+    SDL_SetTextureBlendMode(sky->hills, SDL_BLENDMODE_BLEND);
+
+    memory_free(hills);
+    return 0;
+}
+
+/**
+ * Returns the vertical offset of a ray's column caused by jumping, from the precomputed profile.
+ *
+ * @param sky The sky.
+ * @param ray The index of the ray (0 to RAYS_NUMBER - 1).
+ * @param z The height of the player.
+ * @return double The offset in pixels, downwards.
+ */
+double sky_jump_offset(const struct sky* sky, int ray, double z) {
+    return z * sky->jump_profile[ray];
+}
+
+/**
+ * Draws the sky and floor behind a first-person view whose field of view spans `width`
+ * columns from the left edge of the window.
+ *
+ * @param sky The sky.
+ * @param renderer The renderer used for drawing.
+ * @param angle The angle the camera faces.
+ * @param z The height of the player.
+ * @param width The number of screen columns covered by the field of view.
+ */
+void sky_draw(const struct sky* sky, SDL_Renderer* renderer, double angle, double z, int width) {
+    static SDL_Rect floor_rects[WINDOW_WIDTH]; // Runs of columns whose floor starts on the same row
+    int stride = RAYS_NUMBER / width;
+    int runs = 0, horizon = 0;
+
+    // The floor of screen column x starts where the wall of its ray stands
+    for(int x = 0; x < width; x++) {
+        int ray = (width - x) * stride;
+        if(ray > RAYS_NUMBER - 1) ray = RAYS_NUMBER - 1;
+        int top = FLOOR_SIZE + z + sky_jump_offset(sky, ray, z);
+        if(top > horizon) horizon = top;
+
+        if(runs > 0 && floor_rects[runs - 1].y == top) {
+            floor_rects[runs - 1].w++;
+        } else {
+            floor_rects[runs] = (SDL_Rect) { x, top, 1, WINDOW_HEIGHT - top };
+            runs++;
+        }
+    }
+
+    if(sky->gradient == NULL || sky->hills == NULL) { // Flat sky
+        SDL_SetRenderDrawColor(renderer, 150, 150, 180, 255);
+        SDL_Rect area = { 0, 0, width, horizon };
+        SDL_RenderFillRect(renderer, &area);
+    } else {
+        // The gradient ends at the lowest floor edge; columns whose floor starts higher cover it
+        SDL_Rect gradient_area = { 0, horizon - WINDOW_HEIGHT, width, WINDOW_HEIGHT };
+        SDL_RenderCopy(renderer, sky->gradient, NULL, &gradient_area);
+
+        // Screen column x looks at angle - FOV/2 + x * FOV / WINDOW_WIDTH: find the panorama column of x = 0
+        double start = fmod((angle - FOV/2) * WINDOW_WIDTH / FOV, SKY_PANORAMA_WIDTH);
+        int first = (int) (start < 0 ? start + SKY_PANORAMA_WIDTH : start) % SKY_PANORAMA_WIDTH;
+
+        // One copy, or two where the field of view wraps around the end of the panorama
+        int before_wrap = SKY_PANORAMA_WIDTH - first < WINDOW_WIDTH ? SKY_PANORAMA_WIDTH - first : WINDOW_WIDTH;
+        int split = before_wrap * width / WINDOW_WIDTH;
+        SDL_Rect source = { first, 0, before_wrap, SKY_HILL_HEIGHT };
+        SDL_Rect target = { 0, horizon - SKY_HILL_HEIGHT, split, SKY_HILL_HEIGHT };
+        SDL_RenderCopy(renderer, sky->hills, &source, &target);
+        if(before_wrap < WINDOW_WIDTH) {
+            source = (SDL_Rect) { 0, 0, WINDOW_WIDTH - before_wrap, SKY_HILL_HEIGHT };
+            target = (SDL_Rect) { split, horizon - SKY_HILL_HEIGHT, width - split, SKY_HILL_HEIGHT };
+            SDL_RenderCopy(renderer, sky->hills, &source, &target);
+        }
+    }
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 10, 255); // Set color for the floor
+    SDL_RenderFillRects(renderer, floor_rects, runs);
+}
+
+/**
+ * Frees the sky textures.
+ *
+ * @param sky The sky to destroy.
+ */
+void sky_destroy(struct sky* sky) {
+    if(sky->gradient != NULL) SDL_DestroyTexture(sky->gradient);
+    if(sky->hills != NULL) SDL_DestroyTexture(sky->hills);
+    sky->gradient = NULL;
+    sky->hills = NULL;
+}
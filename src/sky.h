@@ -0,0 +1,61 @@
+#ifndef SKY_H
+#define SKY_H
+
+#include <SDL2/SDL.h>
+
+#include "constants.h"
+
+// Width of the hills panorama: as many columns per radian as the screen shows, over a full turn
+#define SKY_PANORAMA_WIDTH ((int) (WINDOW_WIDTH * 2 * PI / FOV + 0.5))
+
+/*
+    Precomputed background of the first-person view. The sky is a vertical gradient and a
+    panorama of distant hills indexed by view angle, both built once, so a frame's background
+    is a few texture copies and one batch of floor rectangles whatever the player does.
+*/
+struct sky {
+    SDL_Texture* gradient;              // 1 x WINDOW_HEIGHT sky gradient, its bottom row at the horizon
+    SDL_Texture* hills;                 // SKY_PANORAMA_WIDTH x SKY_HILL_HEIGHT hills over a full turn, transparent above them
+    float jump_profile[RAYS_NUMBER];    // Extra downward shift of each ray's column per unit of jump height
+};
+
+/**
+ * Fills the jump profile and renders the sky textures.
+ *
+ * @param sky The sky to build.
+ * @param renderer The renderer the textures are created for.
+ * @return int 0 if the sky was built, or 1 if a texture could not be created
+ *             (the jump profile is filled anyway and sky_draw falls back to a flat sky).
+ */
+int sky_init(struct sky* sky, SDL_Renderer* renderer);
+
+/**
+ * Returns the vertical offset of a ray's column caused by jumping, from the precomputed profile.
+ *
+ * @param sky The sky.
+ * @param ray The index of the ray (0 to RAYS_NUMBER - 1).
+ * @param z The height of the player.
+ * @return double The offset in pixels, downwards.
+ */
+double sky_jump_offset(const struct sky* sky, int ray, double z);
+
+/**
+ * Draws the sky and floor behind a first-person view whose field of view spans `width`
+ * columns from the left edge of the window.
+ *
+ * @param sky The sky.
+ * @param renderer The renderer used for drawing.
+ * @param angle The angle the camera faces.
+ * @param z The height of the player.
+ * @param width The number of screen columns covered by the field of view.
+ */
+void sky_draw(const struct sky* sky, SDL_Renderer* renderer, double angle, double z, int width);
+
+/**
+ * Frees the sky textures.
+ *
+ * @param sky The sky to destroy.
+ */
+void sky_destroy(struct sky* sky);
+
+#endif
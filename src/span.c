@@ -0,0 +1,196 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "constants.h"
+#include "algebra.h"
+#include "map.h"
+#include "span.h"
+#include "trig.h"
+
+// Candidate wall with the depth of its nearest point, used to sort front to back
+struct span_wall {
+    int wall;       // Map table row of the wall
+    double near;    // Smallest depth of the wall in front of the camera
+};
+
+/**
+ * Orders candidate walls by their nearest depth (qsort comparator).
+ * 
+ * @param a The first candidate.
+ * @param b The second candidate.
+ * @return int Negative if a is nearer, positive if b is nearer, 0 otherwise.
+ */
+static int compare_near(const void* a, const void* b) {
+    double da = ((const struct span_wall*) a)->near, db = ((const struct span_wall*) b)->near;
+    return da < db ? -1 : da > db;
+}
+
+/**
+ * Clips a wall to the part in front of the near plane.
+ * 
+ * @param wall The map table row of the wall.
+ * @param x The x-coordinate of the camera.
+ * @param y The y-coordinate of the camera.
+ * @param forward The unit direction the camera faces.
+ * @param clipped The visible part of the wall, relative to the camera (output).
+ * @return int 1 if part of the wall is in front of the camera, 0 otherwise.
+ */
+static int clip_to_near(int wall, double x, double y, double forward[2], double clipped[4]) {
+    clipped[0] = map[wall][0] - x;
+    clipped[1] = map[wall][1] - y;
+    clipped[2] = map[wall][2] - x;
+    clipped[3] = map[wall][3] - y;
+
+    double d0 = clipped[0] * forward[0] + clipped[1] * forward[1] - SPAN_NEAR_PLANE;
+    double d1 = clipped[2] * forward[0] + clipped[3] * forward[1] - SPAN_NEAR_PLANE;
+    if(d0 < 0 && d1 < 0) return 0;
+
+    if(d0 < 0 || d1 < 0) {
+        double t = d0 / (d0 - d1);
+        double px = clipped[0] + t * (clipped[2] - clipped[0]);
+        double py = clipped[1] + t * (clipped[3] - clipped[1]);
+        int behind = d0 < 0 ? 0 : 2;
+        clipped[behind] = px;
+        clipped[behind + 1] = py;
+    }
+    return 1;
+}
+
+/**
+ * Converts a point in front of the camera into a (fractional) column index.
+ * 
+ * @param forward The unit direction the camera faces.
+ * @param px The x-coordinate of the point, relative to the camera.
+ * @param py The y-coordinate of the point, relative to the camera.
+ * @param columns The number of columns across the field of view.
+ * @return double The column whose ray passes through the point.
+ */
+static double column_of(double forward[2], double px, double py, int columns) {
+    double relative = atan2(forward[0] * py - forward[1] * px, forward[0] * px + forward[1] * py);
+    return (FOV / 2 - relative) / (FOV / columns);
+}
+
+/**
+ * Finds the first column at or after `column` that is still open, halving the paths it
+ * walks so later searches skip runs of closed columns in constant time.
+ * 
+ * @param next For each column, itself if it is open, or a later column to look at.
+ * @param column The column to start from.
+ * @return int The first open column, or the number of columns if none is left.
+ */
+static int next_open_column(int* next, int column) {
+    while(next[column] != column) {
+        next[column] = next[next[column]];
+        column = next[column];
+    }
+    return column;
+}
+
+/**
+ * Computes the closest wall of every screen column by projecting walls instead of casting rays.
+ * Each wall is clipped to the near plane and projected to the range of columns it covers;
+ * walls are processed front to back, and a column is closed as soon as its hit is nearer
+ * than the wall being processed, since no later wall can beat it. Closed columns are
+ * skipped in constant time, and processing stops once every column is closed, so the cost
+ * grows with the columns each wall still sees rather than columns times walls.
+ * Uses static scratch space, so only one thread may call it at a time. Requires FOV < PI.
+ * 
+ * @param walls The map table rows of the candidate walls, or NULL for rows 0 to count - 1.
+ * @param count The number of candidate walls (at most MAP_MAX_LINES).
+ * @param angle The angle the camera faces (in radians).
+ * @param x The x-coordinate of the camera.
+ * @param y The y-coordinate of the camera.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param columns The number of columns across the field of view, at most RAYS_NUMBER.
+ * @param hits The closest hit of each column (output).
+ * @return int The number of walls projected before the screen was covered, or -1 if there
+ *             are too many walls.
+ */
+int span_cast(const int* walls, int count, double angle, double x, double y, double plane_vector[2], int columns, struct ray_hit* hits) {
+    static struct span_wall order[MAP_MAX_LINES];
+    static int next_open[RAYS_NUMBER + 1]; // Open columns, see next_open_column
+    static double directions[RAYS_NUMBER][2]; // Unit direction of each column's ray
+    double forward[2] = { cos(angle), sin(angle) };
+    double clipped[4];
+    int candidates = 0;
+
+    if(count > MAP_MAX_LINES) return -1;
+
+    // Sort the walls in front of the camera by their nearest point
+    for(int k = 0; k < count; k++) {
+        int wall = walls != NULL ? walls[k] : k;
+        if(!clip_to_near(wall, x, y, forward, clipped)) continue;
+        order[candidates].wall = wall;
+        order[candidates].near = fmin(clipped[0] * forward[0] + clipped[1] * forward[1],
+                                      clipped[2] * forward[0] + clipped[3] * forward[1]);
+        candidates++;
+    }
+    qsort(order, candidates, sizeof(struct span_wall), compare_near);
+
+    if(columns > RAYS_NUMBER) columns = RAYS_NUMBER;
+    trig_direction_fan(angle + FOV / 2, -(FOV / columns), columns, directions); // The same fan as cast_rays
+
+    for(int i = 0; i < columns; i++) {
+        hits[i].x = 0;
+        hits[i].y = 0;
+        hits[i].distance = INFINITY;
+        hits[i].wall = -1;
+        hits[i].row = NULL;
+        next_open[i] = i;
+    }
+    next_open[columns] = columns;
+
+    int covered = 0;          // Columns holding a hit
+    int closed = 0;           // Columns whose hit no remaining wall can beat
+    double farthest = 0;      // Largest depth stored in a covered column
+    int processed = 0;
+
+    for(int k = 0; k < candidates; k++) {
+        // Everything left is behind a fully covered screen
+        if(closed == columns || (covered == columns && order[k].near >= farthest)) break;
+        processed++;
+
+        int wall = order[k].wall;
+        clip_to_near(wall, x, y, forward, clipped);
+        double c0 = column_of(forward, clipped[0], clipped[1], columns);
+        double c1 = column_of(forward, clipped[2], clipped[3], columns);
+        int first = (int) floor(fmin(c0, c1)) - 1, last = (int) ceil(fmax(c0, c1)) + 1;
+        if(first < 0) first = 0;
+        if(last > columns - 1) last = columns - 1;
+        if(first > last) continue; // Outside the field of view
+
+        // Span fill: intersect each column's ray with the wall line directly
+        double a[2] = { map[wall][0] - x, map[wall][1] - y };
+        double edge[2] = { map[wall][2] - map[wall][0], map[wall][3] - map[wall][1] };
+        for(int i = next_open_column(next_open, first); i <= last; i = next_open_column(next_open, i + 1)) {
+            // Every remaining wall is at least as far as this one: a nearer hit is final
+            if(hits[i].distance <= order[k].near) {
+                next_open[i] = i + 1;
+                closed++;
+                continue;
+            }
+
+            double* dir = directions[i];
+            double denominator = dir[0] * edge[1] - dir[1] * edge[0];
+            if(denominator == 0) continue; // Ray parallel to the wall
+
+            double t = (a[0] * edge[1] - a[1] * edge[0]) / denominator;
+            double s = (a[0] * dir[1] - a[1] * dir[0]) / denominator;
+            if(t <= 0 || s < 0 || s > 1) continue;
+
+            double hx = x + t * dir[0], hy = y + t * dir[1];
+            double distance = distance_from_line(plane_vector, x - hx, y - hy);
+            if(distance >= hits[i].distance) continue; // Occluded by a nearer wall
+
+            if(hits[i].wall < 0) covered++;
+            hits[i].x = hx;
+            hits[i].y = hy;
+            hits[i].distance = distance;
+            hits[i].wall = wall;
+            hits[i].row = map[wall];
+            farthest = fmax(farthest, distance);
+        }
+    }
+
+    return processed;
+}
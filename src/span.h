@@ -0,0 +1,28 @@
+#ifndef SPAN_H
+#define SPAN_H
+
+#include "raycast.h"
+
+/**
+ * Computes the closest wall of every screen column by projecting walls instead of casting rays.
+ * Each wall is clipped to the near plane and projected to the range of columns it covers;
+ * walls are processed front to back, and a column is closed as soon as its hit is nearer
+ * than the wall being processed, since no later wall can beat it. Closed columns are
+ * skipped in constant time, and processing stops once every column is closed, so the cost
+ * grows with the columns each wall still sees rather than columns times walls.
+ * Uses static scratch space, so only one thread may call it at a time. Requires FOV < PI.
+ * 
+ * @param walls The map table rows of the candidate walls, or NULL for rows 0 to count - 1.
+ * @param count The number of candidate walls (at most MAP_MAX_LINES).
+ * @param angle The angle the camera faces (in radians).
+ * @param x The x-coordinate of the camera.
+ * @param y The y-coordinate of the camera.
+ * @param plane_vector The camera plane, used to measure the perpendicular distance.
+ * @param columns The number of columns across the field of view, at most RAYS_NUMBER.
+ * @param hits The closest hit of each column (output).
+ * @return int The number of walls projected before the screen was covered, or -1 if there
+ *             are too many walls.
+ */
+int span_cast(const int* walls, int count, double angle, double x, double y, double plane_vector[2], int columns, struct ray_hit* hits);
+
+#endif
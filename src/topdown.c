@@ -0,0 +1,274 @@
+#include <math.h>
+#include <SDL2/SDL.h>
+
+#include "constants.h"
+#include "map.h"
+#include "topdown.h"
+
+/**
+ * Initializes the view with the identity transform and no cached layer.
+ * 
+ * @param view The view to initialize.
+ */
+void topdown_init(struct topdown_view* view) {
+    view->offset_x = 0;
+    view->offset_y = 0;
+    view->zoom = 1;
+    view->static_layer = NULL;
+    view->layer_valid = FALSE;
+}
+
+/**
+ * Moves the view by a number of screen pixels.
+ * 
+ * @param view The view to pan.
+ * @param dx The horizontal distance in pixels.
+ * @param dy The vertical distance in pixels.
+ */
+void topdown_pan(struct topdown_view* view, double dx, double dy) {
+    view->offset_x += dx / view->zoom;
+    view->offset_y += dy / view->zoom;
+}
+
+/**
+ * Scales the view, keeping the world point under a screen position fixed.
+ * 
+ * @param view The view to zoom.
+ * @param factor The zoom multiplier (greater than 1 zooms in).
+ * @param screen_x The x-coordinate of the fixed screen point.
+ * @param screen_y The y-coordinate of the fixed screen point.
+ */
+void topdown_zoom(struct topdown_view* view, double factor, int screen_x, int screen_y) {
+    double anchor[2];
+    topdown_to_world(view, screen_x, screen_y, anchor);
+
+    view->zoom = fmin(fmax(view->zoom * factor, TOPDOWN_MIN_ZOOM), TOPDOWN_MAX_ZOOM);
+    view->offset_x = anchor[0] - screen_x / view->zoom;
+    view->offset_y = anchor[1] - screen_y / view->zoom;
+}
+
+/**
+ * Converts a screen position to world coordinates.
+ * 
+ * @param view The view.
+ * @param screen_x The x-coordinate on screen.
+ * @param screen_y The y-coordinate on screen.
+ * @param world The world coordinates (output).
+ */
+void topdown_to_world(const struct topdown_view* view, int screen_x, int screen_y, double world[2]) {
+    world[0] = view->offset_x + screen_x / view->zoom;
+    world[1] = view->offset_y + screen_y / view->zoom;
+}
+
+/**
+ * Converts a world position to screen coordinates.
+ * 
+ * @param view The view.
+ * @param x The world x-coordinate.
+ * @param y The world y-coordinate.
+ * @return SDL_FPoint The position on screen.
+ */
+static SDL_FPoint to_screen(const struct topdown_view* view, double x, double y) {
+    SDL_FPoint point = {
+        (float) ((x - view->offset_x) * view->zoom),
+        (float) ((y - view->offset_y) * view->zoom)
+    };
+    return point;
+}
+
+/**
+ * Checks whether the cached layer still matches the map and the transform.
+ * 
+ * @param view The view.
+ * @return int 1 if the layer can be reused, 0 otherwise.
+ */
+static int layer_is_fresh(const struct topdown_view* view) {
+    return view->layer_valid
+        && view->layer_version == map_version
+        && view->layer_offset_x == view->offset_x
+        && view->layer_offset_y == view->offset_y
+        && view->layer_zoom == view->zoom;
+}
+
+/**
+ * Draws the map walls overlapping a world rectangle into the current render target.
+ * 
+ * @param view The view.
+ * @param renderer The renderer used for drawing.
+ * @param min The top-left corner of the rectangle.
+ * @param max The bottom-right corner of the rectangle.
+ */
+static void draw_walls(const struct topdown_view* view, SDL_Renderer* renderer, const double min[2], const double max[2]) {
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // Set color to white for lines
+    for(int i = 0; i < map_lines; i++) {
+        if(fmax(map[i][0], map[i][2]) < min[0] || fmin(map[i][0], map[i][2]) > max[0]
+            || fmax(map[i][1], map[i][3]) < min[1] || fmin(map[i][1], map[i][3]) > max[1])
+            continue; // Wall is outside the rectangle
+
+        SDL_FPoint from = to_screen(view, map[i][0], map[i][1]);
+        SDL_FPoint to = to_screen(view, map[i][2], map[i][3]);
+        SDL_RenderDrawLineF(renderer, from.x, from.y, to.x, to.y);
+    }
+}
+
+/**
+ * Redraws only the part of the cached layer covering the walls that changed since it was
+ * built, e.g. a moving door, when the transform is unchanged.
+ * 
+ * @param view The view.
+ * @param renderer The renderer used for drawing.
+ * @return int 0 if the layer was patched, or 1 if it must be rebuilt.
+ */
+static int patch_layer(struct topdown_view* view, SDL_Renderer* renderer) {
+    double box[4];
+    if(!view->layer_valid || view->layer_offset_x != view->offset_x || view->layer_offset_y != view->offset_y
+        || view->layer_zoom != view->zoom || map_changed_region(view->layer_version, box))
+        return 1;
+
+    if(box[0] <= box[2] && box[1] <= box[3]) {
+        // Screen rectangle of the change, widened by a pixel for the rasterized lines
+        SDL_FPoint top_left = to_screen(view, box[0], box[1]), bottom_right = to_screen(view, box[2], box[3]);
+        SDL_Rect dirty = { (int) floor(top_left.x) - 1, (int) floor(top_left.y) - 1, 0, 0 };
+        dirty.w = (int) ceil(bottom_right.x) + 2 - dirty.x;
+        dirty.h = (int) ceil(bottom_right.y) + 2 - dirty.y;
+
+        double min[2], max[2];
+        topdown_to_world(view, dirty.x, dirty.y, min);
+        topdown_to_world(view, dirty.x + dirty.w, dirty.y + dirty.h, max);
+
+        SDL_SetRenderTarget(renderer, view->static_layer);
+        SDL_RenderSetClipRect(renderer, &dirty);
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE); // Write transparent pixels instead of blending them
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+        SDL_RenderFillRect(renderer, &dirty);
+        draw_walls(view, renderer, min, max); // Walls crossing the rectangle are cut by the clip
+        SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+        SDL_RenderSetClipRect(renderer, NULL);
+        SDL_SetRenderTarget(renderer, NULL);
+    }
+
+    view->layer_version = map_version;
+    return 0;
+}
+
+/**
+ * Re-renders the map walls into the cached layer, skipping walls outside the screen.
+ * 
+ * @param view The view.
+ * @param renderer The renderer used for drawing.
+ * @return int 0 if the layer was rebuilt, or 1 if an error occurred.
+ */
+static int rebuild_layer(struct topdown_view* view, SDL_Renderer* renderer) {
+    if(view->static_layer == NULL) {
+        view->static_layer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, WINDOW_WIDTH, WINDOW_HEIGHT);
+        if(view->static_layer == NULL) return 1;
+        SDL_SetTextureBlendMode(view->static_layer, SDL_BLENDMODE_BLEND);
+    }
+
+    // Visible world rectangle used for culling
+    double min[2], max[2];
+    topdown_to_world(view, 0, 0, min);
+    topdown_to_world(view, WINDOW_WIDTH, WINDOW_HEIGHT, max);
+
+    SDL_SetRenderTarget(renderer, view->static_layer);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    draw_walls(view, renderer, min, max); // Walls off screen are skipped
+    SDL_SetRenderTarget(renderer, NULL);
+
+    view->layer_valid = TRUE;
+    view->layer_version = map_version;
+    view->layer_offset_x = view->offset_x;
+    view->layer_offset_y = view->offset_y;
+    view->layer_zoom = view->zoom;
+    return 0;
+}
+
+/**
+ * Draws the map walls, rebuilding the cached layer first if it is stale.
+ * Walls outside the visible world rectangle are culled during the rebuild; local map
+ * edits such as moving doors only redraw the part of the layer they touched.
+ * 
+ * @param view The view.
+ * @param renderer The renderer used for drawing.
+ * @return int 0 if the map was drawn, or 1 if an error occurred.
+ */
+int topdown_draw_map(struct topdown_view* view, SDL_Renderer* renderer) {
+    if(!layer_is_fresh(view) && patch_layer(view, renderer) && rebuild_layer(view, renderer)) return 1;
+    return SDL_RenderCopy(renderer, view->static_layer, NULL, NULL) ? 1 : 0;
+}
+
+/**
+ * Draws the visible area as a single geometry submission.
+ * The polygon's vertices form a triangle fan around its viewpoint; colors fade with distance.
+ * 
+ * @param view The view.
+ * @param renderer The renderer used for drawing.
+ * @param polygon The visibility polygon to fill.
+ */
+void topdown_draw_visibility(const struct topdown_view* view, SDL_Renderer* renderer, const struct visibility_polygon* polygon) {
+    // Kept static so the per-frame submission does not allocate
+    static SDL_Vertex vertices[VISIBILITY_MAX_VERTICES + 1];
+    static int indices[3 * VISIBILITY_MAX_VERTICES];
+    int index_count = 0;
+
+    vertices[0].position = to_screen(view, polygon->x, polygon->y);
+    vertices[0].color = (SDL_Color) { 255, 255, 255, 255 };
+    for(int i = 0; i < polygon->count; i++) {
+        double distance = hypot(polygon->vertices[i][0] - polygon->x, polygon->vertices[i][1] - polygon->y);
+        Uint8 level = 255 * (distance > VIEW_DISTANCE ? 0.01 : 1 - distance / VIEW_DISTANCE); // Diminish brightness with distance
+        vertices[i + 1].position = to_screen(view, polygon->vertices[i][0], polygon->vertices[i][1]);
+        vertices[i + 1].color = (SDL_Color) { level, level, level, 255 };
+
+        // Triangle between this vertex and the previous one
+        if(i > 0) {
+            indices[index_count++] = 0;
+            indices[index_count++] = i;
+            indices[index_count++] = i + 1;
+        }
+    }
+
+    // Around a full circle the last vertex connects back to the first
+    if(polygon->full_circle && polygon->count > 1) {
+        indices[index_count++] = 0;
+        indices[index_count++] = polygon->count;
+        indices[index_count++] = 1;
+    }
+
+    if(index_count > 0)
+        SDL_RenderGeometry(renderer, NULL, vertices, polygon->count + 1, indices, index_count);
+}
+
+/**
+ * Draws the player marker (view frustum edges) as a single polyline.
+ * 
+ * @param view The view.
+ * @param renderer The renderer used for drawing.
+ * @param player The player to mark.
+ */
+void topdown_draw_player(const struct topdown_view* view, SDL_Renderer* renderer, const struct player* player) {
+    double front[2] = { 10 * cos(player->angle), 10 * sin(player->angle) };
+    double side[2] = { 10 * cos(player->angle + PI/2), 10 * sin(player->angle + PI/2) };
+
+    SDL_FPoint marker[4] = {
+        to_screen(view, player->x, player->y),
+        to_screen(view, player->x + front[0] - side[0], player->y + front[1] - side[1]),
+        to_screen(view, player->x + front[0] + side[0], player->y + front[1] + side[1]),
+        to_screen(view, player->x, player->y)
+    };
+
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
+    SDL_RenderDrawLinesF(renderer, marker, 4);
+}
+
+/**
+ * Frees the cached layer.
+ * 
+ * @param view The view.
+ */
+void topdown_destroy(struct topdown_view* view) {
+    if(view->static_layer != NULL) SDL_DestroyTexture(view->static_layer);
+    view->static_layer = NULL;
+    view->layer_valid = FALSE;
+}
@@ -0,0 +1,100 @@
+#ifndef TOPDOWN_H
+#define TOPDOWN_H
+
+#include <SDL2/SDL.h>
+
+#include "player.h"
+#include "visibility.h"
+
+/*
+    Structure holding the state of the top-down debug view.
+    The static walls are pre-rendered into a texture that is only rebuilt
+    when the map geometry or the pan/zoom transform changes.
+*/
+struct topdown_view {
+    double offset_x;            // World x-coordinate shown at the left edge of the screen
+    double offset_y;            // World y-coordinate shown at the top edge of the screen
+    double zoom;                // Screen pixels per world unit
+
+    SDL_Texture* static_layer;  // Cached rendering of the map walls
+    int layer_valid;            // 1 if static_layer matches the fields below
+    unsigned int layer_version; // Map version baked into static_layer
+    double layer_offset_x;      // offset_x baked into static_layer
+    double layer_offset_y;      // offset_y baked into static_layer
+    double layer_zoom;          // zoom baked into static_layer
+};
+
+/**
+ * Initializes the view with the identity transform and no cached layer.
+ * 
+ * @param view The view to initialize.
+ */
+void topdown_init(struct topdown_view* view);
+
+/**
+ * Moves the view by a number of screen pixels.
+ * 
+ * @param view The view to pan.
+ * @param dx The horizontal distance in pixels.
+ * @param dy The vertical distance in pixels.
+ */
+void topdown_pan(struct topdown_view* view, double dx, double dy);
+
+/**
+ * Scales the view, keeping the world point under a screen position fixed.
+ * 
+ * @param view The view to zoom.
+ * @param factor The zoom multiplier (greater than 1 zooms in).
+ * @param screen_x The x-coordinate of the fixed screen point.
+ * @param screen_y The y-coordinate of the fixed screen point.
+ */
+void topdown_zoom(struct topdown_view* view, double factor, int screen_x, int screen_y);
+
+/**
+ * Converts a screen position to world coordinates.
+ * 
+ * @param view The view.
+ * @param screen_x The x-coordinate on screen.
+ * @param screen_y The y-coordinate on screen.
+ * @param world The world coordinates (output).
+ */
+void topdown_to_world(const struct topdown_view* view, int screen_x, int screen_y, double world[2]);
+
+/**
+ * Draws the map walls, rebuilding the cached layer first if it is stale.
+ * Walls outside the visible world rectangle are culled during the rebuild; local map
+ * edits such as moving doors only redraw the part of the layer they touched.
+ * 
+ * @param view The view.
+ * @param renderer The renderer used for drawing.
+ * @return int 0 if the map was drawn, or 1 if an error occurred.
+ */
+int topdown_draw_map(struct topdown_view* view, SDL_Renderer* renderer);
+
+/**
+ * Draws the visible area as a single geometry submission.
+ * The polygon's vertices form a triangle fan around its viewpoint; colors fade with distance.
+ * 
+ * @param view The view.
+ * @param renderer The renderer used for drawing.
+ * @param polygon The visibility polygon to fill.
+ */
+void topdown_draw_visibility(const struct topdown_view* view, SDL_Renderer* renderer, const struct visibility_polygon* polygon);
+
+/**
+ * Draws the player marker (view frustum edges) as a single polyline.
+ * 
+ * @param view The view.
+ * @param renderer The renderer used for drawing.
+ * @param player The player to mark.
+ */
+void topdown_draw_player(const struct topdown_view* view, SDL_Renderer* renderer, const struct player* player);
+
+/**
+ * Frees the cached layer.
+ * 
+ * @param view The view.
+ */
+void topdown_destroy(struct topdown_view* view);
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef TRIG_H
+#define TRIG_H
+
+// Number of intervals of the sine table over a full turn (a power of two, so wrapping is a mask).
+// Linear interpolation errs by at most (2 * pi / TRIG_TABLE_SIZE)^2 / 8, about 1.2e-6.
+#define TRIG_TABLE_SIZE 2048
+
+/**
+ * Fills the sine table. Must be called once before trig_sincos, before any thread uses it.
+ */
+void trig_init(void);
+
+/**
+ * Computes the sine and cosine of an angle from the table, interpolating linearly
+ * between entries. Both results are within 1.2e-6 of sin and cos.
+ *
+ * @param angle The angle (in radians), of any magnitude below 1e9.
+ * @param sine The sine of the angle (output).
+ * @param cosine The cosine of the angle (output).
+ */
+void trig_sincos(double angle, double* sine, double* cosine);
+
+/**
+ * Computes the sines and cosines of many angles at once. The angles are reduced to
+ * [-pi/4, pi/4] around the nearest multiple of pi/2 and evaluated with minimax
+ * polynomials, without branches, so the loop vectorizes. Results are within 4e-16
+ * of sin and cos for angles below 1e5 in magnitude.
+ *
+ * @param angles The angles (in radians).
+ * @param sines The sine of each angle (output).
+ * @param cosines The cosine of each angle (output).
+ * @param count The number of angles.
+ */
+void trig_sincos_batch(const double* restrict angles, double* restrict sines, double* restrict cosines, int count);
+
+/**
+ * Computes the angle of a vector with a polynomial approximation of the arctangent.
+ * The result is within 1.5e-5 of atan2.
+ *
+ * @param y The y-component of the vector.
+ * @param x The x-component of the vector.
+ * @return double The angle in [-pi, pi], or 0 for the null vector.
+ */
+double trig_atan2(double y, double x);
+
+/**
+ * Rotates a vector by the angle whose cosine and sine are given, so a direction can be
+ * turned step by step without recomputing it from its angle.
+ *
+ * @param vector A 2D vector, rotated in place.
+ * @param cosine The cosine of the rotation angle.
+ * @param sine The sine of the rotation angle.
+ */
+void rotate_vector2(double vector[2], double cosine, double sine);
+
+/**
+ * Computes the unit directions of a fan of rays, the first at `angle` and each next one
+ * turned by `step`. Only the first direction and the step go through trig_sincos_batch;
+ * every other direction is its predecessor rotated with rotate_vector2, so a fan costs
+ * one multiply-add per component and ray instead of a sine and a cosine.
+ *
+ * @param angle The angle of the first ray (in radians).
+ * @param step The angle between two neighbouring rays (in radians).
+ * @param count The number of rays.
+ * @param directions The direction of each ray (output).
+ */
+void trig_direction_fan(double angle, double step, int count, double (*directions)[2]);
+
+#endif
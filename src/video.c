@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "constants.h"
+#include "memory.h"
+#include "video.h"
+
+/**
+ * Converts a packed RGB24 frame into planar Y, U and V (BT.601, full 4:4:4).
+ * 
+ * @param rgb The source frame.
+ * @param yuv The destination, three planes of width * height bytes.
+ * @param pixels The number of pixels in the frame.
+ */
+static void rgb_to_yuv444(const Uint8* rgb, Uint8* yuv, int pixels) {
+    Uint8* y_plane = yuv;
+    Uint8* u_plane = yuv + pixels;
+    Uint8* v_plane = yuv + 2 * pixels;
+
+    for(int i = 0; i < pixels; i++) {
+        int r = rgb[3*i], g = rgb[3*i + 1], b = rgb[3*i + 2];
+        // Integer approximation of the studio-swing BT.601 matrix
+        y_plane[i] = (Uint8) ((( 66*r + 129*g +  25*b + 128) >> 8) + 16);
+        u_plane[i] = (Uint8) (((-38*r -  74*g + 112*b + 128) >> 8) + 128);
+        v_plane[i] = (Uint8) (((112*r -  94*g -  18*b + 128) >> 8) + 128);
+    }
+}
+
+/**
+ * Writes one frame to the stream output in its container format.
+ * Only called from the writer thread.
+ * 
+ * @param stream The video stream.
+ * @param rgb The RGB24 frame to write.
+ * @return int 0 if the frame was written, or 1 if an error occurred.
+ */
+static int write_frame(struct video_stream* stream, const Uint8* rgb) {
+    size_t size = (size_t) stream->width * stream->height * 3;
+
+    if(stream->format == VIDEO_FORMAT_RGB)
+        return fwrite(rgb, 1, size, stream->file) != size;
+
+    rgb_to_yuv444(rgb, stream->scratch, stream->width * stream->height);
+    if(fputs("FRAME\n", stream->file) == EOF) return 1;
+    return fwrite(stream->scratch, 1, size, stream->file) != size;
+}
+
+/**
+ * Writer thread: pops queued frames, converts and writes them, then recycles their buffers.
+ * The lock is never held while writing, so the render loop only ever waits for queue bookkeeping.
+ * 
+ * @param data The video stream.
+ * @return int Always 0.
+ */
+static int writer_thread(void* data) {
+    struct video_stream* stream = data;
+
+    SDL_LockMutex(stream->lock);
+    for(;;) {
+        while(stream->ready_count == 0 && !stream->closing)
+            SDL_CondWait(stream->frame_ready, stream->lock);
+        if(stream->ready_count == 0) break; // Closing and fully drained
+
+        int slot = stream->ready_slots[stream->ready_head];
+        stream->ready_head = (stream->ready_head + 1) % stream->buffer_count;
+        stream->ready_count--;
+        SDL_UnlockMutex(stream->lock);
+
+        int error = write_frame(stream, stream->buffers[slot]);
+
+        SDL_LockMutex(stream->lock);
+        if(error) stream->write_errors++;
+        else stream->frames_written++;
+        stream->free_slots[stream->free_count++] = slot;
+    }
+    SDL_UnlockMutex(stream->lock);
+
+    fflush(stream->file);
+    return 0;
+}
+
+/**
+ * Frees every resource owned by a stream. Safe on partially initialized streams.
+ * 
+ * @param stream The video stream to free.
+ */
+static void free_stream(struct video_stream* stream) {
+    if(stream->buffers != NULL) {
+        for(int i = 0; i < stream->buffer_count; i++) memory_free(stream->buffers[i]);
+        memory_free(stream->buffers);
+    }
+    memory_free(stream->free_slots);
+    memory_free(stream->ready_slots);
+    memory_free(stream->scratch);
+    if(stream->frame_ready != NULL) SDL_DestroyCond(stream->frame_ready);
+    if(stream->lock != NULL) SDL_DestroyMutex(stream->lock);
+    if(stream->file != NULL && stream->file != stdout) fclose(stream->file);
+    memory_free(stream);
+}
+
+/**
+ * Opens a video stream and starts its writer thread.
+ * The format is Y4M when the path ends with ".y4m" and raw RGB24 otherwise.
+ * The path "-" streams to the standard output, so frames can be piped to an encoder.
+ * 
+ * @param path The destination file, or "-" for the standard output.
+ * @param width The frame width in pixels.
+ * @param height The frame height in pixels.
+ * @return struct video_stream* Pointer to the new stream, or NULL if it could not be opened.
+ */
+struct video_stream* video_stream_open(const char* path, int width, int height) {
+    struct video_stream* stream = memory_calloc(MEMORY_VIDEO, 1, sizeof(struct video_stream));
+    if(stream == NULL) return NULL;
+
+    size_t path_len = strlen(path);
+    stream->format = path_len > 4 && strcmp(path + path_len - 4, ".y4m") == 0 ? VIDEO_FORMAT_Y4M : VIDEO_FORMAT_RGB;
+    stream->width = width;
+    stream->height = height;
+    stream->buffer_count = VIDEO_QUEUE_SIZE;
+
+    stream->file = strcmp(path, "-") == 0 ? stdout : fopen(path, "wb");
+    if(stream->file == NULL) {
+        fprintf(stderr, "Error opening video stream %s.\n", path);
+        free_stream(stream);
+        return NULL;
+    }
+
+    size_t frame_size = (size_t) width * height * 3;
+    stream->buffers = memory_calloc(MEMORY_VIDEO, stream->buffer_count, sizeof(Uint8*));
+    stream->free_slots = memory_alloc(MEMORY_VIDEO, sizeof(int) * stream->buffer_count);
+    stream->ready_slots = memory_alloc(MEMORY_VIDEO, sizeof(int) * stream->buffer_count);
+    stream->scratch = stream->format == VIDEO_FORMAT_Y4M ? memory_alloc(MEMORY_VIDEO, frame_size) : NULL;
+    stream->lock = SDL_CreateMutex();
+    stream->frame_ready = SDL_CreateCond();
+    if(stream->buffers == NULL || stream->free_slots == NULL || stream->ready_slots == NULL
+        || (stream->format == VIDEO_FORMAT_Y4M && stream->scratch == NULL)
+        || stream->lock == NULL || stream->frame_ready == NULL) {
+        free_stream(stream);
+        return NULL;
+    }
+
+    for(int i = 0; i < stream->buffer_count; i++) {
+        stream->buffers[i] = memory_alloc(MEMORY_VIDEO, frame_size);
+        if(stream->buffers[i] == NULL) {
+            free_stream(stream);
+            return NULL;
+        }
+        stream->free_slots[stream->free_count++] = i;
+    }
+
+    if(stream->format == VIDEO_FORMAT_Y4M)
+        fprintf(stream->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, VIDEO_STREAM_FPS);
+
+    stream->writer = SDL_CreateThread(writer_thread, "video writer", stream);
+    if(stream->writer == NULL) {
+        fprintf(stderr, "Error starting video writer: %s\n", SDL_GetError());
+        free_stream(stream);
+        return NULL;
+    }
+
+    return stream;
+}
+
+/**
+ * Reads back the current frame and queues it for writing.
+ * Must be called before SDL_RenderPresent. Never blocks on the writer:
+ * if every buffer is in flight the frame is counted as dropped.
+ * 
+ * @param stream The video stream.
+ * @param renderer The renderer holding the frame to capture.
+ * @return int 0 if the frame was queued, or 1 if it was dropped.
+ */
+int video_stream_push(struct video_stream* stream, SDL_Renderer* renderer) {
+    SDL_LockMutex(stream->lock);
+    if(stream->free_count == 0) {
+        stream->frames_dropped++;
+        SDL_UnlockMutex(stream->lock);
+        return 1;
+    }
+    int slot = stream->free_slots[--stream->free_count];
+    SDL_UnlockMutex(stream->lock);
+
+    // The slot is owned by the render loop until it is queued, so the readback runs unlocked
+    int error = SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_RGB24, stream->buffers[slot], stream->width * 3);
+
+    SDL_LockMutex(stream->lock);
+    if(error) {
+        stream->free_slots[stream->free_count++] = slot;
+        stream->frames_dropped++;
+    } else {
+        stream->ready_slots[(stream->ready_head + stream->ready_count) % stream->buffer_count] = slot;
+        stream->ready_count++;
+        SDL_CondSignal(stream->frame_ready);
+    }
+    SDL_UnlockMutex(stream->lock);
+
+    return error ? 1 : 0;
+}
+
+/**
+ * Flushes the queued frames, stops the writer thread, reports the frame
+ * counters on stderr and frees the stream.
+ * 
+ * @param stream The video stream to close.
+ */
+void video_stream_close(struct video_stream* stream) {
+    if(stream == NULL) return;
+
+    SDL_LockMutex(stream->lock);
+    stream->closing = TRUE;
+    SDL_CondSignal(stream->frame_ready);
+    SDL_UnlockMutex(stream->lock);
+    SDL_WaitThread(stream->writer, NULL);
+
+    fprintf(stderr, "Video stream: %lu frames written, %lu dropped, %lu write errors.\n",
+        stream->frames_written, stream->frames_dropped, stream->write_errors);
+
+    free_stream(stream);
+}
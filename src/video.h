@@ -0,0 +1,74 @@
+#ifndef VIDEO_H
+#define VIDEO_H
+
+#include <SDL2/SDL.h>
+
+// Output container used by a video stream
+enum video_format {
+    VIDEO_FORMAT_RGB, // Headerless packed RGB24 frames
+    VIDEO_FORMAT_Y4M  // YUV4MPEG2 stream with planar 4:4:4 frames
+};
+
+/*
+    Structure holding a video stream.
+    Frames are read back by the render loop into recycled buffers and handed
+    to a background writer thread through a bounded queue. The render loop
+    never waits on the writer: when no free buffer is available the frame is dropped.
+*/
+struct video_stream {
+    FILE* file;                 // Destination file or pipe
+    enum video_format format;   // Output container
+    int width;                  // Frame width in pixels
+    int height;                 // Frame height in pixels
+
+    Uint8** buffers;            // Recycled RGB24 frame buffers
+    int buffer_count;           // Number of frame buffers (queue capacity)
+    int* free_slots;            // Stack of buffer indices ready to be filled
+    int free_count;             // Number of entries in free_slots
+    int* ready_slots;           // Ring of buffer indices waiting to be written
+    int ready_head;             // Index of the oldest entry in ready_slots
+    int ready_count;            // Number of entries in ready_slots
+
+    Uint8* scratch;             // Writer-owned buffer for color conversion
+    SDL_mutex* lock;            // Guards the slot queues and the counters
+    SDL_cond* frame_ready;      // Signaled when a frame is queued or the stream closes
+    SDL_Thread* writer;         // Background writer thread
+    int closing;                // 1 once video_stream_close has been called
+
+    unsigned long frames_written; // Frames written to the output
+    unsigned long frames_dropped; // Frames dropped because the queue was full
+    unsigned long write_errors;   // Frames that could not be written completely
+};
+
+/**
+ * Opens a video stream and starts its writer thread.
+ * The format is Y4M when the path ends with ".y4m" and raw RGB24 otherwise.
+ * The path "-" streams to the standard output, so frames can be piped to an encoder.
+ * 
+ * @param path The destination file, or "-" for the standard output.
+ * @param width The frame width in pixels.
+ * @param height The frame height in pixels.
+ * @return struct video_stream* Pointer to the new stream, or NULL if it could not be opened.
+ */
+struct video_stream* video_stream_open(const char* path, int width, int height);
+
+/**
+ * Reads back the current frame and queues it for writing.
+ * Must be called before SDL_RenderPresent. Never blocks on the writer:
+ * if every buffer is in flight the frame is counted as dropped.
+ * 
+ * @param stream The video stream.
+ * @param renderer The renderer holding the frame to capture.
+ * @return int 0 if the frame was queued, or 1 if it was dropped.
+ */
+int video_stream_push(struct video_stream* stream, SDL_Renderer* renderer);
+
+/**
+ * Flushes the queued frames, stops the writer thread, reports the frame
+ * counters on stderr and frees the stream.
+ * 
+ * @param stream The video stream to close.
+ */
+void video_stream_close(struct video_stream* stream);
+
+#endif
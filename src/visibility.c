@@ -0,0 +1,346 @@
+#include <math.h>
+#include <stdlib.h>
+
+#include "constants.h"
+#include "map.h"
+#include "visibility.h"
+
+// A full turn; PI from constants.h is too coarse to close a sweep exactly
+#define FULL_TURN 6.283185307179586
+
+// Largest number of wall pieces swept: every wall (and bound) split at most once
+#define MAX_PIECES (2 * (MAP_MAX_LINES + VISIBILITY_BOUND_WALLS))
+
+// Wall piece seen from the viewpoint under an increasing angle
+struct sweep_piece {
+    double x0, y0;  // First endpoint reached by the sweep, relative to the viewpoint
+    double x1, y1;  // Last endpoint reached by the sweep, relative to the viewpoint
+    double a0, a1;  // Angles of the endpoints relative to the window start, a0 < a1
+};
+
+// A sweep ray reaching the first or last endpoint of a piece
+struct sweep_event {
+    double angle;   // Angle of the endpoint relative to the window start
+    int piece;      // Index of the piece
+    int begin;      // 1 if the piece starts here, 0 if it ends here
+};
+
+// State of one sweep
+struct sweep {
+    double start_angle;                     // Absolute angle of the window start
+    struct sweep_piece pieces[MAX_PIECES];  // Pieces of the walls, none crossing the window start
+    int piece_count;                        // Number of pieces
+    int heap[MAX_PIECES];                   // Pieces crossed by the sweep ray, nearest first
+    int position[MAX_PIECES];               // Index of each piece in heap
+    int heap_count;                         // Number of pieces in heap
+    double direction[2];                    // Sweep ray used to order the heap
+};
+
+/**
+ * Returns the angle of a direction relative to the window start, within [0, FULL_TURN).
+ *
+ * @param sweep The sweep.
+ * @param x The x-component of the direction.
+ * @param y The y-component of the direction.
+ * @return double The relative angle.
+ */
+static double relative_angle(const struct sweep* sweep, double x, double y) {
+    double angle = fmod(atan2(y, x) - sweep->start_angle, FULL_TURN);
+    return angle < 0 ? angle + FULL_TURN : angle;
+}
+
+/**
+ * Returns how far along a ray a piece's line lies.
+ *
+ * @param piece The piece.
+ * @param direction The unit direction of the ray.
+ * @return double The distance from the viewpoint along the ray.
+ */
+static double piece_distance(const struct sweep_piece* piece, const double direction[2]) {
+    double ex = piece->x1 - piece->x0, ey = piece->y1 - piece->y0;
+    double denominator = direction[0] * ey - direction[1] * ex;
+    if(denominator == 0) return fmin(hypot(piece->x0, piece->y0), hypot(piece->x1, piece->y1));
+    return (piece->x0 * ey - piece->y0 * ex) / denominator;
+}
+
+/**
+ * Adds a piece spanning the angles [a0, a1].
+ *
+ * @param sweep The sweep.
+ * @param p0 The first endpoint, relative to the viewpoint.
+ * @param p1 The last endpoint, relative to the viewpoint.
+ * @param a0 The relative angle of p0.
+ * @param a1 The relative angle of p1.
+ */
+static void add_piece(struct sweep* sweep, const double p0[2], const double p1[2], double a0, double a1) {
+    if(a1 <= a0) return; // Seen edge-on
+    struct sweep_piece* piece = &sweep->pieces[sweep->piece_count++];
+    piece->x0 = p0[0];
+    piece->y0 = p0[1];
+    piece->x1 = p1[0];
+    piece->y1 = p1[1];
+    piece->a0 = a0;
+    piece->a1 = a1;
+}
+
+/**
+ * Adds a wall, oriented counter-clockwise around the viewpoint and split
+ * where it crosses the window start.
+ *
+ * @param sweep The sweep.
+ * @param x0 The x-coordinate of one endpoint, relative to the viewpoint.
+ * @param y0 The y-coordinate of one endpoint, relative to the viewpoint.
+ * @param x1 The x-coordinate of the other endpoint, relative to the viewpoint.
+ * @param y1 The y-coordinate of the other endpoint, relative to the viewpoint.
+ */
+static void add_wall(struct sweep* sweep, double x0, double y0, double x1, double y1) {
+    double cross = x0 * y1 - y0 * x1;
+    if(cross == 0) return; // In line with the viewpoint: hides nothing
+
+    double p0[2] = { x0, y0 }, p1[2] = { x1, y1 };
+    if(cross < 0) { // Swap so the sweep reaches p0 first
+        p0[0] = x1; p0[1] = y1;
+        p1[0] = x0; p1[1] = y0;
+    }
+
+    double a0 = relative_angle(sweep, p0[0], p0[1]);
+    double a1 = relative_angle(sweep, p1[0], p1[1]);
+    if(a1 == 0) a1 = FULL_TURN; // Ends exactly on the window start
+    if(a1 > a0) {
+        add_piece(sweep, p0, p1, a0, a1);
+        return;
+    }
+
+    // The wall crosses the window start: split it there
+    double start[2] = { cos(sweep->start_angle), sin(sweep->start_angle) };
+    double ex = p1[0] - p0[0], ey = p1[1] - p0[1];
+    double t = (p0[0] * ey - p0[1] * ex) / (start[0] * ey - start[1] * ex);
+    double split[2] = { t * start[0], t * start[1] };
+    add_piece(sweep, p0, split, a0, FULL_TURN);
+    add_piece(sweep, split, p1, 0, a1);
+}
+
+/**
+ * Checks whether a piece is nearer than another along the current sweep ray.
+ *
+ * @param sweep The sweep.
+ * @param a The first piece.
+ * @param b The second piece.
+ * @return int 1 if a is nearer than b, 0 otherwise.
+ */
+static int nearer(const struct sweep* sweep, int a, int b) {
+    return piece_distance(&sweep->pieces[a], sweep->direction) < piece_distance(&sweep->pieces[b], sweep->direction);
+}
+
+/**
+ * Swaps two heap entries.
+ *
+ * @param sweep The sweep.
+ * @param i The index of the first entry.
+ * @param j The index of the second entry.
+ */
+static void heap_swap(struct sweep* sweep, int i, int j) {
+    int piece = sweep->heap[i];
+    sweep->heap[i] = sweep->heap[j];
+    sweep->heap[j] = piece;
+    sweep->position[sweep->heap[i]] = i;
+    sweep->position[sweep->heap[j]] = j;
+}
+
+/**
+ * Restores the heap order around an entry by moving it up or down.
+ *
+ * @param sweep The sweep.
+ * @param i The index of the entry.
+ */
+static void heap_fix(struct sweep* sweep, int i) {
+    while(i > 0 && nearer(sweep, sweep->heap[i], sweep->heap[(i - 1) / 2])) {
+        heap_swap(sweep, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    for(;;) {
+        int nearest = i, left = 2 * i + 1, right = 2 * i + 2;
+        if(left < sweep->heap_count && nearer(sweep, sweep->heap[left], sweep->heap[nearest])) nearest = left;
+        if(right < sweep->heap_count && nearer(sweep, sweep->heap[right], sweep->heap[nearest])) nearest = right;
+        if(nearest == i) return;
+        heap_swap(sweep, i, nearest);
+        i = nearest;
+    }
+}
+
+/**
+ * Removes a piece from the heap.
+ *
+ * @param sweep The sweep.
+ * @param piece The piece to remove.
+ */
+static void heap_remove(struct sweep* sweep, int piece) {
+    int i = sweep->position[piece];
+    sweep->heap_count--;
+    if(i == sweep->heap_count) return;
+    sweep->heap[i] = sweep->heap[sweep->heap_count];
+    sweep->position[sweep->heap[i]] = i;
+    heap_fix(sweep, i);
+}
+
+/**
+ * Adds a piece to the heap.
+ *
+ * @param sweep The sweep.
+ * @param piece The piece to add.
+ */
+static void heap_insert(struct sweep* sweep, int piece) {
+    int i = sweep->heap_count++;
+    sweep->heap[i] = piece;
+    sweep->position[piece] = i;
+    heap_fix(sweep, i);
+}
+
+/**
+ * Points the sweep ray used for heap comparisons at a relative angle.
+ *
+ * @param sweep The sweep.
+ * @param angle The relative angle.
+ */
+static void aim(struct sweep* sweep, double angle) {
+    sweep->direction[0] = cos(sweep->start_angle + angle);
+    sweep->direction[1] = sin(sweep->start_angle + angle);
+}
+
+/**
+ * Appends the point where a piece meets the ray at a relative angle.
+ *
+ * @param sweep The sweep.
+ * @param polygon The polygon to extend.
+ * @param piece The piece.
+ * @param angle The relative angle of the ray.
+ */
+static void emit(const struct sweep* sweep, struct visibility_polygon* polygon, int piece, double angle) {
+    double direction[2] = { cos(sweep->start_angle + angle), sin(sweep->start_angle + angle) };
+    double distance = piece_distance(&sweep->pieces[piece], direction);
+    polygon->vertices[polygon->count][0] = polygon->x + distance * direction[0];
+    polygon->vertices[polygon->count][1] = polygon->y + distance * direction[1];
+    polygon->count++;
+}
+
+/**
+ * Orders events by angle (qsort comparator).
+ *
+ * @param a The first event.
+ * @param b The second event.
+ * @return int Negative if a comes first, positive if b comes first, 0 otherwise.
+ */
+static int compare_events(const void* a, const void* b) {
+    double da = ((const struct sweep_event*) a)->angle, db = ((const struct sweep_event*) b)->angle;
+    return da < db ? -1 : da > db;
+}
+
+/**
+ * Computes the exact region visible from a viewpoint within an angular window.
+ * Wall endpoints are sorted by angle and swept with a heap of the walls the sweep ray
+ * crosses, ordered by distance, so the cost is O(n log n) in the number of walls.
+ * Walls may touch (at an endpoint of one of them) but must not cross. Directions that
+ * hit no wall end at a square of half-width `radius` around the viewpoint.
+ * Uses static scratch space, so only one thread may call it at a time.
+ *
+ * @param walls The map table rows of the walls, or NULL for rows 0 to count - 1.
+ * @param count The number of walls (at most MAP_MAX_LINES).
+ * @param x The x-coordinate of the viewpoint.
+ * @param y The y-coordinate of the viewpoint.
+ * @param start_angle The angle where the window starts (in radians).
+ * @param span The angular width of the window, counter-clockwise (2 * PI or more for every direction).
+ * @param radius The half-width of the bounding square.
+ * @param polygon The visible region (output).
+ * @return int 0 if the polygon was computed, or 1 if there are too many walls.
+ */
+int visibility_compute(const int* walls, int count, double x, double y, double start_angle, double span,
+    double radius, struct visibility_polygon* polygon) {
+    // Kept static: the sweep state is a few kilobytes and the renderer calls this every frame
+    static struct sweep sweep;
+    static struct sweep_event events[2 * MAX_PIECES];
+
+    if(count > MAP_MAX_LINES) return 1;
+
+    polygon->x = x;
+    polygon->y = y;
+    polygon->count = 0;
+    polygon->full_circle = span >= 2 * PI;
+    if(polygon->full_circle) span = FULL_TURN;
+
+    sweep.start_angle = start_angle;
+    sweep.piece_count = 0;
+    sweep.heap_count = 0;
+
+    for(int k = 0; k < count; k++) {
+        int j = walls != NULL ? walls[k] : k;
+        add_wall(&sweep, map[j][0] - x, map[j][1] - y, map[j][2] - x, map[j][3] - y);
+    }
+    double corners[VISIBILITY_BOUND_WALLS + 1][2] = { { -radius, -radius }, { radius, -radius }, { radius, radius }, { -radius, radius }, { -radius, -radius } };
+    for(int k = 0; k < VISIBILITY_BOUND_WALLS; k++)
+        add_wall(&sweep, corners[k][0], corners[k][1], corners[k + 1][0], corners[k + 1][1]);
+
+    // Pieces entirely outside the window never matter
+    int event_count = 0;
+    for(int i = 0; i < sweep.piece_count; i++) {
+        if(sweep.pieces[i].a0 >= span) continue;
+        events[event_count++] = (struct sweep_event) { sweep.pieces[i].a0, i, TRUE };
+        events[event_count++] = (struct sweep_event) { sweep.pieces[i].a1, i, FALSE };
+    }
+    qsort(events, event_count, sizeof(struct sweep_event), compare_events);
+
+    // Sweep: the nearest crossed piece only changes at events. Pieces are removed with the
+    // order of the interval before the event and inserted with the order of the one after it,
+    // where every piece in the heap is crossed by the ray and the order is strict.
+    double previous_mid = 0;
+    for(int i = 0; i < event_count && events[i].angle < span;) {
+        double angle = events[i].angle;
+        int end = i;
+        while(end < event_count && events[end].angle == angle) end++;
+        double next = end < event_count && events[end].angle < span ? events[end].angle : span;
+        double mid = (angle + next) / 2;
+        int before = sweep.heap_count > 0 ? sweep.heap[0] : -1;
+
+        aim(&sweep, previous_mid);
+        for(int k = i; k < end; k++)
+            if(!events[k].begin) heap_remove(&sweep, events[k].piece);
+        aim(&sweep, mid);
+        for(int k = i; k < end; k++)
+            if(events[k].begin) heap_insert(&sweep, events[k].piece);
+        int after = sweep.heap[0]; // The bounding square keeps the heap non-empty
+
+        if(before < 0) {
+            emit(&sweep, polygon, after, angle);
+        } else if(before != after) { // The visible boundary jumps along this ray
+            emit(&sweep, polygon, before, angle);
+            emit(&sweep, polygon, after, angle);
+        }
+
+        previous_mid = mid;
+        i = end;
+    }
+    if(!polygon->full_circle) emit(&sweep, polygon, sweep.heap[0], span);
+
+    return 0;
+}
+
+/**
+ * Checks whether a point lies inside a visibility polygon, i.e. is visible from its viewpoint.
+ *
+ * @param polygon The visibility polygon.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @return int 1 if the point is inside the polygon, 0 otherwise.
+ */
+int visibility_contains(const struct visibility_polygon* polygon, double x, double y) {
+    int inside = FALSE;
+    int count = polygon->count + !polygon->full_circle; // A window is closed by the viewpoint
+
+    for(int i = 0, j = count - 1; i < count; j = i++) {
+        const double* a = i < polygon->count ? polygon->vertices[i] : (const double[2]) { polygon->x, polygon->y };
+        const double* b = j < polygon->count ? polygon->vertices[j] : (const double[2]) { polygon->x, polygon->y };
+        // Even-odd rule: count the edges crossing the horizontal ray to the right of the point
+        if((a[1] > y) != (b[1] > y) && x < a[0] + (y - a[1]) * (b[0] - a[0]) / (b[1] - a[1]))
+            inside = !inside;
+    }
+    return inside;
+}
@@ -0,0 +1,58 @@
+#ifndef VISIBILITY_H
+#define VISIBILITY_H
+
+#include "map.h"
+
+// Walls of the square that bounds every visibility polygon
+#define VISIBILITY_BOUND_WALLS 4
+
+// Largest number of vertices of a visibility polygon: every wall may be split in two,
+// each piece contributes two events, and each event adds at most two vertices
+#define VISIBILITY_MAX_VERTICES (8 * (MAP_MAX_LINES + VISIBILITY_BOUND_WALLS) + 2)
+
+/*
+    Region visible from a viewpoint, as a star-shaped polygon around it.
+    Consecutive vertices, together with the viewpoint, form the triangles of the region.
+    The vertices run counter-clockwise (by increasing angle); when the polygon covers a
+    limited angular window, the viewpoint itself closes it.
+*/
+struct visibility_polygon {
+    double x;                                       // x-coordinate of the viewpoint
+    double y;                                       // y-coordinate of the viewpoint
+    int full_circle;                                // 1 if the polygon covers every direction
+    int count;                                      // Number of vertices
+    double vertices[VISIBILITY_MAX_VERTICES][2];    // Vertices as {x, y}, by increasing angle
+};
+
+/**
+ * Computes the exact region visible from a viewpoint within an angular window.
+ * Wall endpoints are sorted by angle and swept with a heap of the walls the sweep ray
+ * crosses, ordered by distance, so the cost is O(n log n) in the number of walls.
+ * Walls may touch (at an endpoint of one of them) but must not cross. Directions that
+ * hit no wall end at a square of half-width `radius` around the viewpoint.
+ * Uses static scratch space, so only one thread may call it at a time.
+ *
+ * @param walls The map table rows of the walls, or NULL for rows 0 to count - 1.
+ * @param count The number of walls (at most MAP_MAX_LINES).
+ * @param x The x-coordinate of the viewpoint.
+ * @param y The y-coordinate of the viewpoint.
+ * @param start_angle The angle where the window starts (in radians).
+ * @param span The angular width of the window, counter-clockwise (2 * PI or more for every direction).
+ * @param radius The half-width of the bounding square.
+ * @param polygon The visible region (output).
+ * @return int 0 if the polygon was computed, or 1 if there are too many walls.
+ */
+int visibility_compute(const int* walls, int count, double x, double y, double start_angle, double span,
+    double radius, struct visibility_polygon* polygon);
+
+/**
+ * Checks whether a point lies inside a visibility polygon, i.e. is visible from its viewpoint.
+ *
+ * @param polygon The visibility polygon.
+ * @param x The x-coordinate of the point.
+ * @param y The y-coordinate of the point.
+ * @return int 1 if the point is inside the polygon, 0 otherwise.
+ */
+int visibility_contains(const struct visibility_polygon* polygon, double x, double y);
+
+#endif